@@ -0,0 +1,465 @@
+/**
+ * @file benchmark.cpp
+ * @brief Benchmark suite for every integration method and predefined function
+ *
+ * Every method is timed on every predefined function for n = 10^3, 10^4, ...
+ * up to a configurable maximum (10^9 at most). Each case is repeated until a
+ * minimum time has passed, and the report gives the time per run, ns per
+ * function evaluation, evaluations per second, the memory high-water mark of
+ * the case and the error against the closed-form value of the integral.
+ * Cases can be repeated with several summation methods to compare their cost
+ * and accuracy at large n. The JSON output follows the layout of Google
+ * Benchmark so that existing tooling can compare runs across releases.
+ *
+ * The high-water mark is reset before every case on Linux; elsewhere only
+ * the peak of the whole process so far is available, which the report says.
+ */
+
+#include "../include/cli.h"
+#include "../include/function.h"
+#include "../include/function_kernels.h"
+#include "../include/input.h"
+#include "../include/integrator.h"
+#include "../include/thread_pool.h"
+#include "../include/console_utils.h"
+#include "../include/methods/romberg.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace numerical;
+
+namespace {
+
+/**
+ * @struct Reference
+ * @brief Bounds on which a predefined function is benchmarked, and the exact integral
+ */
+struct Reference {
+    double lowerBound;
+    double upperBound;
+    double exact;
+    const char* expression;   // The same function as an expression
+};
+
+/**
+ * @struct Settings
+ * @brief Command-line settings of the benchmark
+ */
+struct Settings {
+    long long maxIntervals = 1000000;  // Largest n to run
+    double minTime = 0.1;              // Minimum seconds spent per case
+    unsigned threads = 1;              // Threads for grid sums (0 = all)
+    std::string filter;                // Run only cases whose name contains this
+    std::string format = "text";       // Output format: text or json
+    bool expressions = false;          // Also run every function as a parsed expression
+    std::vector<Summation> summations = {Summation::Naive}; // Summation methods to run
+};
+
+/**
+ * @struct Measurement
+ * @brief Outcome of one benchmark case
+ */
+struct Measurement {
+    std::string name;
+    std::string method;
+    std::string summation;
+    int functionChoice;
+    int intervals;
+    long long iterations;
+    double secondsPerRun;
+    long long evaluations;
+    double result;
+    double error;
+    long peakKiB;              // Memory high-water mark of the case (see peakIsPerCase())
+};
+
+// Bounds chosen inside every function's domain, with the integral in closed form
+const std::vector<Reference>& references() {
+    static const double pi = std::acos(-1.0);
+    static const std::vector<Reference> table = {
+        {0.0, 1.0, std::log(2.0), "1/(1+x)"},
+        {0.0, 1.0, 1.0 / 3.0, "x^2"},
+        {0.0, pi, 2.0, "sin(x)"},
+        {0.0, 1.0, std::exp(1.0) - 1.0, "exp(x)"},
+        {-0.5, 0.5, pi / 3.0, "1/sqrt(1-x^2)"},
+        {1.0, 2.0, 2.0 * std::log(2.0) - 1.0, "ln(x)"},
+        {0.0, pi, pi, "x*sin(x)"},
+        {0.0, 1.0, 2.0 / 3.0, "sqrt(x)"}
+    };
+    return table;
+}
+
+// Start a new memory high-water mark. Linux resets VmHWM to the current
+// resident size when "5" is written to /proc/self/clear_refs; false where
+// that is not possible, so that the peak covers the whole process.
+bool resetPeakResident() {
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+#else
+    return false;
+#endif
+}
+
+// Whether peakResidentKiB() covers a single case
+bool peakIsPerCase() {
+    static const bool perCase = resetPeakResident();
+    return perCase;
+}
+
+// Peak resident set size in KiB since the last resetPeakResident(), or of
+// the whole process where it cannot be reset (0 where unavailable)
+long peakResidentKiB() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; // Reported in bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void printUsage(const std::string& program) {
+    std::cout << "Usage: " << program << " [options]\n\n"
+              << "Options:\n"
+              << "  --max-n N          Largest number of intervals, up to 1e9 (default 1e6)\n"
+              << "  --min-time S       Minimum seconds per case (default 0.1)\n"
+              << "  --threads T        Threads for grid sums, 0 = all cores (default 1)\n"
+              << "  --filter TEXT      Run only cases whose name contains TEXT\n"
+              << "  --format F         Output format: text or json (default text)\n"
+              << "  --expressions      Also run every function as a parsed expression (fN-expr)\n"
+              << "  --summation LIST   Comma-separated summation methods, or all (default naive)\n"
+              << "  -h, --help         Show this help\n\n"
+              << "Case names are method/function/n, e.g. simpson13/f3/n:1000, with /sum:S appended\n"
+              << "for summation methods other than naive.\n"
+              << "Romberg uses the smallest order with 2^order >= n, Gauss-Legendre uses n/8\n"
+              << "panels of 8 points; adaptive ignores n.\n";
+}
+
+bool parseSettings(int argc, char* argv[], Settings& settings, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        std::string value;
+        size_t equals = flag.find('=');
+        if (flag == "--expressions") {
+            settings.expressions = true;
+            continue;
+        }
+        if (equals != std::string::npos) {
+            value = flag.substr(equals + 1);
+            flag = flag.substr(0, equals);
+        } else if (i + 1 < argc) {
+            value = argv[i + 1];
+            ++i;
+        } else {
+            error = "Missing value for " + flag;
+            return false;
+        }
+
+        try {
+            if (flag == "--max-n") {
+                // Accept 1e9 as well as 1000000000
+                settings.maxIntervals = static_cast<long long>(cli::parseDouble(value));
+                if (settings.maxIntervals < 1000 || settings.maxIntervals > 1000000000LL) {
+                    error = "--max-n must be between 1e3 and 1e9";
+                    return false;
+                }
+            } else if (flag == "--min-time") {
+                settings.minTime = cli::parseDouble(value);
+            } else if (flag == "--threads") {
+                int threads = cli::parseInt(value);
+                if (threads < 0) {
+                    error = "Thread count must not be negative";
+                    return false;
+                }
+                settings.threads = static_cast<unsigned>(threads);
+            } else if (flag == "--filter") {
+                settings.filter = value;
+            } else if (flag == "--summation") {
+                settings.summations = value == "all" ? allSummations() : std::vector<Summation>();
+                std::stringstream names(value == "all" ? "" : value);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    Summation summation;
+                    if (!parseSummation(name, summation)) {
+                        error = "Unknown summation '" + name + "'";
+                        return false;
+                    }
+                    settings.summations.push_back(summation);
+                }
+                if (settings.summations.empty()) {
+                    error = "No summation methods given";
+                    return false;
+                }
+            } else if (flag == "--format") {
+                settings.format = value;
+                if (value != "text" && value != "json") {
+                    error = "Unknown format '" + value + "' (expected text or json)";
+                    return false;
+                }
+            } else {
+                error = "Unknown option '" + flag + "'";
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "Invalid value for " + flag;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Split the comma-separated list from cli::methodNames()
+std::vector<std::string> methodList() {
+    std::vector<std::string> methods;
+    std::stringstream names(cli::methodNames());
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        name.erase(0, name.find_first_not_of(' '));
+        methods.push_back(name);
+    }
+    return methods;
+}
+
+// Points per panel of the Gauss-Legendre cases
+constexpr int GAUSS_POINTS = 8;
+
+// Smallest Romberg order whose finest trapezoid uses at least n intervals
+int rombergOrderFor(long long n) {
+    int order = 1;
+    while (order < RombergIntegration::MAX_ORDER && (1LL << order) < n) {
+        ++order;
+    }
+    return order;
+}
+
+// Whether a method picks its own points from a tolerance, ignoring n
+bool choosesOwnPoints(const std::string& method) {
+    return method == "adaptive" || method == "tanhsinh" || method == "auto";
+}
+
+// Name of a case: method/function/n, without n for the methods that choose
+// their own points and with the summation method unless it is naive
+std::string caseName(const std::string& method, int functionChoice, bool expression, long long n,
+                     Summation summation) {
+    std::string name = method + "/f" + std::to_string(functionChoice) + (expression ? "-expr" : "");
+    if (!choosesOwnPoints(method)) {
+        name += "/n:" + std::to_string(n);
+    }
+    if (summation != Summation::Naive) {
+        name += "/sum:" + summationName(summation);
+    }
+    return name;
+}
+
+Measurement measure(const std::string& method, int functionChoice, bool expression, long long n,
+                    Summation summation, const Settings& settings) {
+    const Reference& reference = references()[functionChoice - 1];
+    if (peakIsPerCase()) {
+        resetPeakResident();
+    }
+
+    // Round n up so that the method's panel width divides it; Gauss-Legendre
+    // uses GAUSS_POINTS points per panel, so it gets n / GAUSS_POINTS panels
+    int divisor = cli::requiredDivisor(method);
+    int intervals = static_cast<int>((n + divisor - 1) / divisor * divisor);
+    int order = rombergOrderFor(n);
+    if (method == "gauss") {
+        intervals = static_cast<int>((n + GAUSS_POINTS - 1) / GAUSS_POINTS);
+        order = GAUSS_POINTS;
+    }
+
+    Input input(reference.lowerBound, reference.upperBound, intervals, functionChoice);
+    Function function = expression ? Function(std::string(reference.expression)) : Function(functionChoice);
+    double tolerance = choosesOwnPoints(method) ? 1e-10 : 0.0; // Romberg runs to the full order
+    std::unique_ptr<Integrator> integrator =
+        cli::createIntegrator(method, input, function, order, tolerance);
+    integrator->setThreadCount(settings.threads);
+    integrator->setSummation(summation);
+
+    Measurement m;
+    m.method = method;
+    m.summation = summationName(summation);
+    m.functionChoice = functionChoice;
+    m.intervals = choosesOwnPoints(method) ? 0 : (method == "romberg" ? 1 << order : intervals);
+    m.name = caseName(method, functionChoice, expression, n, summation);
+
+    // Repeat until the minimum time has passed, but run at least once
+    m.iterations = 0;
+    double elapsed = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        m.result = integrator->integrate().value;
+        ++m.iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < settings.minTime);
+
+    m.secondsPerRun = elapsed / m.iterations;
+    m.evaluations = integrator->getEvaluationCount();
+    m.error = std::fabs(m.result - reference.exact);
+    m.peakKiB = peakResidentKiB();
+    return m;
+}
+
+void printTextHeader() {
+    std::cout << std::left << std::setw(44) << "Benchmark"
+              << std::right << std::setw(14) << "Time/run"
+              << std::setw(12) << "Iterations"
+              << std::setw(12) << "ns/eval"
+              << std::setw(14) << "evals/s"
+              << std::setw(12) << "PeakRSS KiB"
+              << std::setw(12) << "Error" << "\n"
+              << std::string(120, '-') << "\n";
+}
+
+void printTextRow(const Measurement& m) {
+    double nsPerEval = m.secondsPerRun * 1e9 / m.evaluations;
+    std::ostringstream time;
+    time << std::fixed << std::setprecision(3);
+    if (m.secondsPerRun < 1e-3) {
+        time << m.secondsPerRun * 1e6 << " us";
+    } else if (m.secondsPerRun < 1.0) {
+        time << m.secondsPerRun * 1e3 << " ms";
+    } else {
+        time << m.secondsPerRun << " s";
+    }
+
+    std::cout << std::left << std::setw(44) << m.name
+              << std::right << std::setw(14) << time.str()
+              << std::setw(12) << m.iterations
+              << std::setw(12) << std::fixed << std::setprecision(3) << nsPerEval
+              << std::setw(14) << std::scientific << std::setprecision(3) << 1e9 / nsPerEval
+              << std::setw(12) << m.peakKiB
+              << std::setw(12) << std::setprecision(2) << m.error << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+void printJson(const std::vector<Measurement>& measurements, const Settings& settings) {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::cout << std::setprecision(17);
+    std::cout << "{\n"
+              << "  \"context\": {\n"
+              << "    \"date\": \"" << date << "\",\n"
+              << "    \"executable\": \"NumericalIntegrationBench\",\n"
+              << "    \"num_cpus\": " << ThreadPool::hardwareThreads() << ",\n"
+              << "    \"threads\": " << settings.threads << ",\n"
+              << "    \"simd\": \"" << kernels::instructionSet() << "\",\n"
+              << "    \"max_n\": " << settings.maxIntervals << ",\n"
+              << "    \"peak_rss_scope\": \"" << (peakIsPerCase() ? "case" : "process") << "\"\n"
+              << "  },\n"
+              << "  \"benchmarks\": [";
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        const Measurement& m = measurements[i];
+        double nsPerEval = m.secondsPerRun * 1e9 / m.evaluations;
+        std::cout << (i > 0 ? "," : "") << "\n    {"
+                  << "\"name\": \"" << m.name << "\", "
+                  << "\"method\": \"" << m.method << "\", "
+                  << "\"summation\": \"" << m.summation << "\", "
+                  << "\"function\": " << m.functionChoice << ", "
+                  << "\"intervals\": " << m.intervals << ", "
+                  << "\"iterations\": " << m.iterations << ", "
+                  << "\"real_time\": " << m.secondsPerRun * 1e9 << ", "
+                  << "\"time_unit\": \"ns\", "
+                  << "\"evaluations\": " << m.evaluations << ", "
+                  << "\"ns_per_eval\": " << nsPerEval << ", "
+                  << "\"evals_per_second\": " << 1e9 / nsPerEval << ", "
+                  << "\"peak_rss_kib\": " << m.peakKiB << ", "
+                  << "\"result\": " << m.result << ", "
+                  << "\"error\": " << m.error << "}";
+    }
+    std::cout << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string program = argc > 0 ? argv[0] : "NumericalIntegrationBench";
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            printUsage(program);
+            return 0;
+        }
+    }
+
+    Settings settings;
+    std::string error;
+    if (!parseSettings(argc, argv, settings, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    utils::setSleepEnabled(false);
+
+    const bool json = settings.format == "json";
+    if (!json) {
+        std::cout << "SIMD kernels: " << kernels::instructionSet()
+                  << ", threads: " << settings.threads
+                  << ", peak RSS: " << (peakIsPerCase() ? "per case" : "whole process so far") << "\n\n";
+        printTextHeader();
+    }
+
+    std::vector<Measurement> measurements;
+    const int functionCount = static_cast<int>(Function::getAvailableFunctions().size());
+    for (const std::string& method : methodList()) {
+        for (int f = 1; f <= functionCount; ++f) {
+            // Methods that choose their own points have a single case
+            long long lastN = choosesOwnPoints(method) ? 1000 : settings.maxIntervals;
+            for (long long n = 1000; n <= lastN; n *= 10) {
+                for (bool expression : {false, true}) {
+                    for (Summation summation : settings.summations) {
+                        if ((expression && !settings.expressions)
+                            || caseName(method, f, expression, n, summation).find(settings.filter)
+                                   == std::string::npos) {
+                            continue;
+                        }
+
+                        Measurement m = measure(method, f, expression, n, summation, settings);
+                        if (!json) {
+                            printTextRow(m);
+                        }
+                        measurements.push_back(m);
+                    }
+                }
+            }
+        }
+    }
+
+    if (json) {
+        printJson(measurements, settings);
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "summation.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class BatchRunner
+ * @brief Integrates many problems read from a file in parallel
+ *
+ * Problems are read from a CSV file with a header line, or from a JSON Lines
+ * file with one flat object per line. Recognized columns/keys are function,
+ * expr, lower, upper, intervals, method, order, tolerance and summation; missing values
+ * take the command-line defaults, and a non-empty expr replaces function. Problems are scheduled on a work-stealing thread
+ * pool, every thread reuses its Input, Function and integrator objects, and
+ * results are written in input order as soon as they are available.
+ */
+class BatchRunner {
+public:
+    /**
+     * @struct Problem
+     * @brief One integration job
+     */
+    struct Problem {
+        int functionChoice = 1;           // Index of the predefined function
+        std::string expression;           // Expression of x used instead, if not empty
+        double lowerBound = 0.0;          // Lower bound of integration
+        double upperBound = 1.0;          // Upper bound of integration
+        int intervals = 100;              // Number of intervals
+        std::string method = "simpson13"; // Method name, as for --method
+        int order = 4;                    // Romberg order, or Gauss-Legendre points per panel
+        double tolerance = 1e-10;         // Romberg/adaptive/tanh-sinh tolerance
+        Summation summation = Summation::Naive; // How samples are added up
+    };
+
+    /**
+     * @brief Load problems from a CSV or JSON Lines file
+     * @param filename The name of the file to load from
+     * @param error Receives a message if loading fails
+     * @return True if successful, false otherwise
+     */
+    bool loadFromFile(const std::string& filename, std::string& error);
+
+    /**
+     * @brief Integrate all loaded problems
+     * @param out Stream receiving one result line per problem, in input order
+     * @param format "csv" or "json" (JSON Lines)
+     * @param threads Number of threads (0 uses all hardware threads)
+     * @return The number of problems that failed
+     */
+    std::size_t run(std::ostream& out, const std::string& format, unsigned threads);
+
+    /**
+     * @brief Get the loaded problems
+     * @return The problems in input order
+     */
+    const std::vector<Problem>& getProblems() const;
+
+    /**
+     * @brief Get the wall-clock time of the last run
+     * @return The elapsed time in seconds
+     */
+    double getElapsedSeconds() const;
+
+private:
+    /**
+     * @struct Outcome
+     * @brief Result of one problem, waiting to be written in order
+     */
+    struct Outcome {
+        bool done = false;
+        std::string line;
+    };
+
+    std::vector<Problem> problems;    // Loaded problems
+    double elapsedSeconds = 0.0;      // Duration of the last run
+
+    /**
+     * @brief Parse one CSV data line using the header's column order
+     * @param line The line to parse
+     * @param columns The column names from the header
+     * @param problem Receives the parsed problem
+     * @return True if successful, false otherwise
+     */
+    static bool parseCsvLine(const std::string& line, const std::vector<std::string>& columns,
+                             Problem& problem);
+
+    /**
+     * @brief Parse one flat JSON object
+     * @param line The line to parse
+     * @param problem Receives the parsed problem
+     * @return True if successful, false otherwise
+     */
+    static bool parseJsonLine(const std::string& line, Problem& problem);
+
+    /**
+     * @brief Apply one named value to a problem
+     * @param key The column or key name
+     * @param value The value as text
+     * @param problem The problem to update
+     * @return True if the key is known and the value valid, false otherwise
+     */
+    static bool setField(const std::string& key, const std::string& value, Problem& problem);
+};
+
+} // namespace numerical
+
+#endif // BATCH_H
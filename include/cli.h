@@ -0,0 +1,272 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include "integrator.h"
+#include "sampling.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @namespace cli
+ * @brief Non-interactive command-line mode
+ *
+ * Runs one integration described entirely by command-line flags, without
+ * prompts or pauses, and reports the outcome through the exit status.
+ */
+namespace cli {
+
+/**
+ * Exit status of a successful run
+ */
+constexpr int EXIT_OK = 0;
+
+/**
+ * Exit status for invalid flags or integration parameters
+ */
+constexpr int EXIT_USAGE = 1;
+
+/**
+ * Exit status when the method cannot be applied (e.g. n not divisible by 4 for Boole)
+ */
+constexpr int EXIT_NOT_APPLICABLE = 2;
+
+/**
+ * Exit status when the result could not be written
+ */
+constexpr int EXIT_IO_ERROR = 3;
+
+/**
+ * Exit status when at least one problem of a batch failed
+ */
+constexpr int EXIT_BATCH_FAILED = 4;
+
+/**
+ * @struct Options
+ * @brief Parameters of a command-line run
+ */
+struct Options {
+    int functionChoice = 1;        // Index of the predefined function
+    std::string expression;        // Expression of x used instead, if not empty
+    std::vector<std::string> moreExpressions; // Further expressions integrated in the same pass (repeated --expr)
+    double lowerBound = 0.0;       // Lower bound of integration
+    double upperBound = 1.0;       // Upper bound of integration
+    int intervals = 100;           // Number of intervals
+    std::string method = "simpson13"; // Method name (see methodNames())
+    int order = 4;                 // Romberg order, or Gauss-Legendre points per panel
+    double tolerance = 1e-10;      // Romberg/adaptive/tanh-sinh/auto tolerance
+    Summation summation = Summation::Naive; // How samples are added up
+    unsigned threads = 1;          // Threads for grid sums (0 = all)
+    std::string format = "text";   // Output format: text, csv or json
+    bool showSteps = false;        // Print the intermediate steps
+    std::string saveFile;          // Optional file for saveResultToFile()
+    std::string samplesFile;       // Optional binary file for saveSamplesToFile()
+    std::string replayFile;        // Optional sample file to integrate instead of the function
+    std::string batchFile;         // Optional CSV/JSONL file of problems
+    int sweepLevels = 0;           // Levels of a convergence sweep (0 = single run)
+    std::string streamFile;        // Optional file of tabulated samples ("-" = stdin)
+    bool streamBinary = false;     // Samples are raw doubles instead of text
+    bool streamPairs = false;      // Samples are (x, y) pairs instead of values
+    double step = 0.0;             // Step of equally spaced samples (0 = from the bounds)
+    std::string grid = "uniform";  // Grid kind: uniform, chebyshev, graded or geometric
+    std::string gridFile;          // Optional file of grid points replacing the grid kind
+    double grading = 0.0;          // Grading exponent or geometric ratio (see gradingGiven)
+    bool towardUpper = false;      // Grade the grid toward b instead of a
+    std::string yBounds;           // "LOWER:UPPER" bounds of y for a double integral (expressions of x)
+    std::string zBounds;           // "LOWER:UPPER" bounds of z for a triple integral (expressions of x, y)
+    int sparseLevel = -1;          // Sparse-grid level of a cubature (-1 = tensor product)
+    std::string parameters;        // "FIRST:LAST:COUNT" values of p for a parametric sweep
+    Sampling sampling = Sampling::Sobol; // Monte Carlo sample points
+    std::uint64_t seed = 0;        // Seed of the Monte Carlo sample points
+    long long budgetEvaluations = 0; // Evaluation budget of automatic selection (0 = none)
+    double budgetSeconds = 0.0;    // Time budget of automatic selection (0 = none)
+    std::string profileFile;       // Optional file of earlier automatic decisions
+    bool threadsGiven = false;     // Set when --threads was passed
+    bool gradingGiven = false;     // Set when --grading was passed (otherwise the grid's default)
+};
+
+/**
+ * @brief Parse command-line flags
+ * @param argc Argument count from main()
+ * @param argv Argument vector from main()
+ * @param options Receives the parsed options
+ * @param error Receives a message if parsing fails
+ * @return True if successful, false otherwise
+ */
+bool parseArguments(int argc, char* argv[], Options& options, std::string& error);
+
+/**
+ * @brief Get the method names accepted by --method
+ * @return Comma-separated list of method names
+ */
+std::string methodNames();
+
+/**
+ * @brief Get the panel width a method requires of the interval count
+ * @param method The method name
+ * @return 1, 2, 3 or 4 for the Newton-Cotes rules, 1 for the other methods
+ */
+int requiredDivisor(const std::string& method);
+
+/**
+ * @brief Create the integrator for a method name
+ * @param method The method name (see methodNames())
+ * @param input Parameters for integration
+ * @param function Function to integrate
+ * @param order Romberg order, or Gauss-Legendre points per panel
+ * @param tolerance Romberg/adaptive/tanh-sinh/auto tolerance
+ * @return The integrator, or nullptr if the method name is unknown
+ */
+std::unique_ptr<Integrator> createIntegrator(const std::string& method, const Input& input,
+                                             const Function& function, int order, double tolerance);
+
+/**
+ * @brief Parse a whole string as an int
+ *
+ * Unlike std::stoi alone, text after the number ("1e9", "4x") is an error.
+ *
+ * @param text The text
+ * @return The value
+ * @throws std::invalid_argument or std::out_of_range if the text is not an int
+ */
+int parseInt(const std::string& text);
+
+/**
+ * @brief Parse a whole string as a long long
+ * @param text The text
+ * @return The value
+ * @throws std::invalid_argument or std::out_of_range if the text is not a long long
+ */
+long long parseLongLong(const std::string& text);
+
+/**
+ * @brief Parse a whole string as an unsigned 64-bit integer
+ * @param text The text, without a sign (std::stoull would wrap "-1" to 2^64 - 1)
+ * @return The value
+ * @throws std::invalid_argument or std::out_of_range if the text is not such an integer
+ */
+std::uint64_t parseUnsigned(const std::string& text);
+
+/**
+ * @brief Parse a whole string as a double
+ * @param text The text
+ * @return The value
+ * @throws std::invalid_argument or std::out_of_range if the text is not a number
+ */
+double parseDouble(const std::string& text);
+
+/**
+ * @brief Escape a string for use inside a JSON string literal
+ *
+ * Quotes and backslashes are escaped, and so is every control character:
+ * line breaks and tabs with their short escapes, the others as Unicode
+ * escapes.
+ *
+ * @param text The text to escape
+ * @return The escaped text
+ */
+std::string jsonEscape(const std::string& text);
+
+/**
+ * @brief Quote a CSV field if it contains a separator or a quote
+ * @param text The field value
+ * @return The field as it should be written
+ */
+std::string csvField(const std::string& text);
+
+/**
+ * @brief Print the command-line usage
+ * @param program The program name
+ */
+void printUsage(const std::string& program);
+
+/**
+ * @brief Run a batch of problems read from options.batchFile
+ * @param options The parsed options (only batchFile, threads and format are used)
+ * @return The process exit status
+ */
+int runBatch(const Options& options);
+
+/**
+ * @brief Run a convergence sweep over n, 2n, ..., 2^(levels-1) n intervals
+ *
+ * The grid is refined in place, so only the new midpoints are evaluated at
+ * each level.
+ *
+ * @param options The parsed options (a Newton-Cotes method and sweepLevels)
+ * @param input Parameters for integration; the interval count is the first level
+ * @param function Function to integrate
+ * @return The process exit status
+ */
+int runSweep(const Options& options, const Input& input, const Function& function);
+
+/**
+ * @brief Build the grid selected by --grid or --grid-file
+ * @param options The parsed options
+ * @return The grid, or nullptr for the default uniform grid
+ * @throws std::invalid_argument if the grid cannot be built
+ * @throws std::runtime_error if the grid file cannot be read
+ */
+std::unique_ptr<Grid> createGrid(const Options& options);
+
+/**
+ * @brief Integrate tabulated samples read from options.streamFile
+ *
+ * The samples are read and integrated in fixed-size chunks, so files of any
+ * size are processed in constant memory.
+ *
+ * @param options The parsed options (a Newton-Cotes method and the stream settings)
+ * @return The process exit status
+ */
+int runStream(const Options& options);
+
+/**
+ * @brief Integrate an expression of x, y (and z) over the region given by the bounds
+ *
+ * The tensor product uses the method with the given intervals in every
+ * dimension; with a sparse-grid level the Smolyak construction is used instead.
+ *
+ * @param options The parsed options (expression, bounds, method and cubature settings)
+ * @return The process exit status
+ */
+int runCubature(const Options& options);
+
+/**
+ * @brief Integrate several expressions of x over the same grid in one pass
+ *
+ * Used when --expr is given more than once. Every grid point is generated
+ * once and all expressions are evaluated there; the results are identical
+ * to integrating each expression on its own.
+ *
+ * @param options The parsed options (the expressions, bounds and a Newton-Cotes method)
+ * @return The process exit status
+ */
+int runMulti(const Options& options);
+
+/**
+ * @brief Integrate an expression of x and p for evenly spaced values of p
+ *
+ * All parameter values are integrated together by a ParametricSweep, which
+ * evaluates the expression across many values of p at once.
+ *
+ * @param options The parsed options (expression, bounds, method and parameters)
+ * @return The process exit status
+ */
+int runParametric(const Options& options);
+
+/**
+ * @brief Run the command-line mode
+ * @param argc Argument count from main()
+ * @param argv Argument vector from main()
+ * @return The process exit status
+ */
+int run(int argc, char* argv[]);
+
+} // namespace cli
+
+} // namespace numerical
+
+#endif // CLI_H
@@ -0,0 +1,37 @@
+#ifndef CONSOLE_OBSERVER_H
+#define CONSOLE_OBSERVER_H
+
+#include "observer.h"
+
+namespace numerical {
+
+/**
+ * @class ConsoleObserver
+ * @brief Prints the steps of a calculation to the console
+ *
+ * Used by the interactive menu and the command-line mode. Undefined function
+ * values are always reported on stderr; the steps, the sample table and the
+ * pauses between them only when showSteps is set.
+ */
+class ConsoleObserver : public IntegrationObserver {
+public:
+    /**
+     * @brief Constructor
+     * @param showSteps Whether to print the intermediate steps
+     */
+    explicit ConsoleObserver(bool showSteps = true);
+
+    bool wantsSteps() const override;
+    void onStep(const std::string& text) override;
+    void onSamples(const std::vector<double>& x, const std::vector<double>& y, double h) override;
+    void onPause(int milliseconds) override;
+    void onNotApplicable(const std::string& reason) override;
+    void onUndefinedValue(double x, const std::string& message) override;
+
+private:
+    bool showSteps;   // Whether to print the intermediate steps
+};
+
+} // namespace numerical
+
+#endif // CONSOLE_OBSERVER_H
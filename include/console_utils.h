@@ -0,0 +1,48 @@
+#ifndef CONSOLE_UTILS_H
+#define CONSOLE_UTILS_H
+
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+namespace utils {
+
+/**
+ * @brief Display a menu and get user choice
+ * @param title The menu title
+ * @param options The menu options
+ * @param minOption The minimum allowed option number
+ * @param maxOption The maximum allowed option number
+ * @return The chosen option
+ */
+int getMenuChoice(const std::string& title, const std::vector<std::string>& options, 
+                  int minOption = 1, int maxOption = -1);
+
+/**
+ * @brief Wait for user to press a key
+ */
+void waitForKeyPress();
+
+/**
+ * @brief Clear the console screen
+ */
+void clearScreen();
+
+/**
+ * @brief Wait for specified milliseconds
+ * @param ms The number of milliseconds to wait
+ */
+void sleep(int ms);
+
+/**
+ * @brief Enable or disable the pauses made by sleep()
+ * @param enabled Whether sleep() should wait (true by default)
+ */
+void setSleepEnabled(bool enabled);
+
+} // namespace utils
+
+} // namespace numerical
+
+#endif // CONSOLE_UTILS_H
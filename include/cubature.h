@@ -0,0 +1,239 @@
+#ifndef CUBATURE_H
+#define CUBATURE_H
+
+#include "expression.h"
+#include "integrator.h"
+#include "observer.h"
+#include "region.h"
+#include "sampling.h"
+#include "summation.h"
+#include "thread_pool.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class Cubature
+ * @brief Integrates an expression of x, y and z over a Region
+ *
+ * Every dimension is mapped onto [0, 1] and integrated with a
+ * one-dimensional rule: the trapezoidal, Simpson 1/3, Simpson 3/8 or Boole
+ * rule, or composite Gauss-Legendre. For regions whose bounds depend on the
+ * outer variables the map is applied dimension by dimension, so the inner
+ * rule is stretched between the inner bounds at each outer point.
+ *
+ * The tensor-product construction applies the rule in every dimension, which
+ * costs (points per dimension)^d evaluations. The innermost dimension is
+ * evaluated as a batched sweep, and the points of the outer dimensions are
+ * split into blocks that run on the configured threads.
+ *
+ * The sparse-grid (Smolyak) construction combines tensor products of coarse
+ * and fine rules so that most of the points lie along the axes; for smooth
+ * integrands it reaches the accuracy of a full tensor product with far
+ * fewer points, which matters most in three dimensions. At level k the
+ * finest rule along each axis is the one of createLevelRule(method, k). The
+ * Newton-Cotes rules are nested, so points shared by several of the
+ * combined products are evaluated once.
+ *
+ * The Monte Carlo construction uses no rule at all: it averages the
+ * integrand at Sobol, Halton or pseudo-random points of the unit cube, mapped
+ * onto the region, and reports the standard error like MonteCarlo does in
+ * one dimension. Its cost does not grow with the dimension, which makes it
+ * the choice for rough integrands where the rules converge slowly.
+ *
+ * Results do not depend on the thread count.
+ */
+class Cubature {
+public:
+    /**
+     * @brief How the one-dimensional rules are combined
+     */
+    enum class Construction {
+        TensorProduct,   // The rule in every dimension
+        Smolyak,         // Sparse combination of coarse and fine products
+        MonteCarlo       // Mean over (quasi-)random points, see setSampling()
+    };
+
+    /**
+     * Largest sparse-grid level
+     */
+    static constexpr int MAX_LEVEL = 12;
+
+    /**
+     * @struct Rule
+     * @brief A one-dimensional rule on [0, 1]
+     */
+    struct Rule {
+        std::vector<double> nodes;     // Nodes in increasing order
+        std::vector<double> weights;   // Weight of each node (summing to 1)
+    };
+
+    /**
+     * @brief Constructor
+     * @param region The domain of integration
+     * @param integrand The integrand, an expression of the region's variables
+     * @param method The one-dimensional rule: trapezoidal, simpson13,
+     *        simpson38, boole or gauss (ignored by Monte Carlo)
+     * @param size Intervals per dimension for the tensor product, the
+     *        level (0 to MAX_LEVEL) of the sparse grid, or the number of
+     *        Monte Carlo points
+     * @param construction How the rules are combined
+     * @throws std::invalid_argument if the method is unknown, the size does
+     *         not suit it, or the integrand uses other variables than the region
+     */
+    Cubature(const Region& region, const Expression& integrand, const std::string& method, int size,
+             Construction construction = Construction::TensorProduct);
+
+    /**
+     * @brief Set the number of Gauss-Legendre points per panel
+     * @param points Points per panel (1 to GaussLegendre::MAX_POINTS, default 4);
+     *        ignored by the sparse grid, whose Gauss rules grow with the level
+     * @throws std::invalid_argument if points is out of range
+     */
+    void setGaussPoints(int points);
+
+    /**
+     * @brief Set how the Monte Carlo points are generated
+     * @param method The sampling method (default Sampling::Sobol)
+     * @param seed The seed of the random numbers and randomizations (default 0)
+     */
+    void setSampling(Sampling method, std::uint64_t seed);
+
+    /**
+     * @brief Set the number of threads used to evaluate and sum the points
+     * @param threads The number of threads (0 uses all hardware threads)
+     */
+    void setThreadCount(unsigned threads);
+
+    /**
+     * @brief Set how the weighted values are added up
+     * @param method The summation method (default Summation::Naive)
+     */
+    void setSummation(Summation method);
+
+    /**
+     * @brief Perform the integration
+     *
+     * The sparse grid also computes the level below from the same points,
+     * plus those it does not share, and reports the difference as the error
+     * estimate, and Monte Carlo the standard error; the tensor product gives
+     * no estimate.
+     *
+     * @param observer Optional observer receiving the steps and undefined values
+     * @return The value, error estimate, evaluation count and timing
+     */
+    IntegrationResult integrate(IntegrationObserver* observer = nullptr);
+
+    /**
+     * @brief Get the name of the method
+     * @return E.g. "Tensor-product Simpson's 1/3 Rule (100 x 100 intervals)"
+     */
+    std::string getMethodName() const;
+
+    /**
+     * @brief Get the display name of a one-dimensional rule
+     * @param method The rule name (see the constructor)
+     * @return E.g. "Simpson's 1/3 Rule"
+     */
+    static std::string getRuleName(const std::string& method);
+
+    /**
+     * @brief Get the one-dimensional rule a construction uses
+     * @param method The rule name (see the constructor)
+     * @param intervals Intervals, or Gauss-Legendre panels
+     * @param gaussPoints Gauss-Legendre points per panel
+     * @return The rule on [0, 1]
+     * @throws std::invalid_argument if the method is unknown or the intervals do not suit it
+     */
+    static Rule createRule(const std::string& method, long long intervals, int gaussPoints);
+
+    /**
+     * @brief Get the rule of a sparse-grid level
+     *
+     * The Newton-Cotes rules double their intervals from level to level,
+     * starting with one panel; Gauss-Legendre uses 2^(level+1) - 1 points
+     * on a single panel.
+     *
+     * @param method The rule name (see the constructor)
+     * @param level The one-dimensional level (0 to MAX_LEVEL)
+     * @return The rule on [0, 1]
+     */
+    static Rule createLevelRule(const std::string& method, int level);
+
+private:
+    /**
+     * @struct SparsePoint
+     * @brief A point of the sparse grid on [0, 1]^d with its combined weights
+     */
+    struct SparsePoint {
+        std::array<double, Region::MAX_DIMENSION> t;   // Coordinates on the unit cube
+        double weight;                                 // Weight at the requested level
+        double coarseWeight;                           // Weight at the level below
+    };
+
+    /**
+     * Number of function values per summation block
+     */
+    static constexpr int BLOCK_POINTS = 8192;
+
+    /**
+     * Number of points handed to Expression::evaluate() at once
+     */
+    static constexpr int BATCH_SIZE = 256;
+
+    const Region& region;               // Domain of integration
+    const Expression& integrand;        // Integrand
+    std::string method;                 // One-dimensional rule
+    int size;                           // Intervals per dimension, or sparse-grid level
+    Construction construction;          // How the rules are combined
+    int gaussPoints;                    // Gauss-Legendre points per panel (tensor product)
+    Sampling sampling;                  // How Monte Carlo points are generated
+    std::uint64_t seed;                 // Seed of the Monte Carlo points
+    BlockRunner blocks;                 // Runs the blocks of points on the configured threads
+    Summation summation;                // How weighted values are added up
+    IntegrationObserver* observer;      // Observer of the running calculation (may be null)
+    long long evaluations;              // Evaluations of the last calculation
+    double errorEstimate;               // Error estimate of the last calculation
+
+    /**
+     * @brief Integrate with the tensor-product construction
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result
+     */
+    double computeTensorProduct(bool showSteps);
+
+    /**
+     * @brief Integrate with the sparse-grid construction
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result
+     */
+    double computeSmolyak(bool showSteps);
+
+    /**
+     * @brief Integrate with the Monte Carlo construction
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result
+     */
+    double computeMonteCarlo(bool showSteps);
+
+    /**
+     * @brief Build the merged points of the sparse grid
+     * @param level The level of the grid
+     * @return The points in lexicographic order, each with its weights at
+     *         level and level - 1
+     */
+    std::vector<SparsePoint> buildSparseGrid(int level) const;
+
+    /**
+     * @brief Start a line of step output for the observer
+     * @return A writer that passes the line on at the end of the statement
+     */
+    StepWriter step() const;
+};
+
+} // namespace numerical
+
+#endif // CUBATURE_H
@@ -0,0 +1,57 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include "expression.h"
+#include "function.h"
+#include "observer.h"
+
+namespace numerical {
+
+/**
+ * @brief Evaluate a function at a point, reporting and zeroing an undefined value
+ *
+ * Reports may come from the worker threads of a parallel sum; they reach
+ * the observer one at a time.
+ *
+ * @param function The function
+ * @param x The point
+ * @param observer Receives the undefined value (may be null)
+ * @return f(x), or 0 if the function is undefined at x
+ */
+double evaluateOrZero(const Function& function, double x, IntegrationObserver* observer);
+
+/**
+ * @brief Evaluate a function at a batch of points, reporting and zeroing undefined values
+ *
+ * Uses the batch kernel of the function. If any point is undefined the
+ * batch is evaluated again point by point, so that only the undefined
+ * values become 0.
+ *
+ * @param function The function
+ * @param x The points
+ * @param y Output array receiving the values
+ * @param count The number of points
+ * @param observer Receives the undefined values (may be null)
+ */
+void evaluateOrZero(const Function& function, const double* x, double* y, int count,
+                    IntegrationObserver* observer);
+
+/**
+ * @brief Evaluate an expression of several variables at a batch of points,
+ *        reporting and zeroing undefined values
+ *
+ * Like the one-variable version; an undefined value is reported at the
+ * first variable of its point.
+ *
+ * @param expression The expression
+ * @param variables variables[k][i] is variable k at point i
+ * @param y Output array receiving the values
+ * @param count The number of points
+ * @param observer Receives the undefined values (may be null)
+ */
+void evaluateOrZero(const Expression& expression, const double* const* variables, double* y, int count,
+                    IntegrationObserver* observer);
+
+} // namespace numerical
+
+#endif // EVALUATION_H
@@ -0,0 +1,185 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class Expression
+ * @brief A function of x given as text, compiled to register bytecode
+ *
+ * The text is parsed once into an expression graph in which identical
+ * subexpressions are shared and constant subexpressions are folded, and the
+ * graph is then compiled to a short list of register instructions. Batches
+ * of points are evaluated one instruction at a time over blocks of points,
+ * so the interpreter overhead is paid once per block rather than per point.
+ *
+ * Supported syntax: numbers, the variables (x by default), pi, e,
+ * + - * / ^ (right-associative), unary minus, parentheses and the functions
+ * sin, cos, tan, asin, acos, atan, sinh, cosh, tanh, exp, ln, log (natural),
+ * log10, sqrt and abs. An expression may have several variables, e.g. x, y
+ * and z for a cubature integrand; variable k is then read from the k-th
+ * input array.
+ */
+class Expression {
+public:
+    /**
+     * @brief Parse and compile an expression
+     * @param text The expression, e.g. "exp(-x^2)*cos(3*x)"
+     * @param variables The names of the variables, in input order (may be empty)
+     * @throws std::invalid_argument if the text is not a valid expression
+     */
+    explicit Expression(const std::string& text, std::vector<std::string> variables = {"x"});
+
+    /**
+     * @brief Evaluate the expression at a point
+     * @param x The point at which to evaluate the expression
+     * @return The value of the expression
+     * @throws std::domain_error if the value is not finite
+     */
+    double evaluate(double x) const;
+
+    /**
+     * @brief Evaluate the expression at a batch of points
+     *
+     * Gives exactly the same values as evaluate(double) point by point.
+     *
+     * @param x The points at which to evaluate the expression
+     * @param y Output array receiving the values
+     * @param count The number of points
+     * @throws std::domain_error if any value is not finite
+     * @throws std::invalid_argument if the expression has more than one variable
+     */
+    void evaluate(const double* x, double* y, std::size_t count) const;
+
+    /**
+     * @brief Evaluate an expression of several variables at a batch of points
+     * @param variables variables[k][i] is the value of variable k at point i
+     * @param y Output array receiving the values
+     * @param count The number of points
+     * @throws std::domain_error if any value is not finite
+     */
+    void evaluate(const double* const* variables, double* y, std::size_t count) const;
+
+    /**
+     * @brief Get the text the expression was created from
+     * @return The expression text
+     */
+    const std::string& getText() const;
+
+    /**
+     * @brief Get the names of the variables
+     * @return The variable names, in input order
+     */
+    const std::vector<std::string>& getVariables() const;
+
+    /**
+     * @brief Check whether the value does not depend on the variables
+     * @return True if the expression folded to a single constant
+     */
+    bool isConstant() const;
+
+    /**
+     * @brief Get the number of bytecode instructions
+     * @return The instruction count after folding and sharing
+     */
+    std::size_t getInstructionCount() const;
+
+    /**
+     * @brief Get the number of registers used by the bytecode
+     * @return The register count
+     */
+    std::size_t getRegisterCount() const;
+
+private:
+    /**
+     * Operations of graph nodes and instructions. The *Constant forms take
+     * one operand from a register and the other from the instruction.
+     */
+    enum class Op : std::uint8_t {
+        Constant, Variable,
+        Add, Subtract, Multiply, Divide, Power, Negate, Square,
+        AddConstant, SubtractFromConstant, MultiplyConstant, DivideByConstant,
+        DivideConstant, PowerConstant, ConstantPower,
+        Sin, Cos, Tan, Asin, Acos, Atan, Sinh, Cosh, Tanh,
+        Exp, Log, Log10, Sqrt, Abs
+    };
+
+    /**
+     * @struct Node
+     * @brief A node of the expression graph
+     */
+    struct Node {
+        Op op;
+        int left;        // Operand node (-1 if none)
+        int right;       // Second operand node (-1 if none)
+        double value;    // Value of a Constant node, or index of a Variable node
+    };
+
+    /**
+     * @struct Instruction
+     * @brief One bytecode instruction: target = op(left, right or constant)
+     */
+    struct Instruction {
+        Op op;
+        std::uint16_t target;
+        std::uint16_t left;
+        std::uint16_t right;
+        double constant;
+    };
+
+    /**
+     * Number of points evaluated together by each instruction
+     */
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    std::string text;                    // Source text
+    std::vector<std::string> variables;  // Variable names; variable k lives in register k
+    std::vector<Node> nodes;             // Expression graph, operands before users
+    std::vector<Instruction> code;       // Compiled bytecode
+    std::size_t registerCount;           // Registers used by the bytecode
+    std::uint16_t resultRegister;        // Register holding the value after the code ran
+
+    /**
+     * @brief Add a node, folding constants and reusing an identical node
+     * @param op The operation
+     * @param left The first operand node (-1 if none)
+     * @param right The second operand node (-1 if none)
+     * @param value The value of a Constant node
+     * @return The index of the node
+     */
+    int addNode(Op op, int left = -1, int right = -1, double value = 0.0);
+
+    /**
+     * @brief Compile the graph below root to bytecode
+     * @param root The node of the whole expression
+     */
+    void compile(int root);
+
+    /**
+     * @brief Apply a unary operation to a value
+     * @param op The operation
+     * @param a The operand
+     * @return The result
+     */
+    static double applyUnary(Op op, double a);
+
+    /**
+     * @brief Apply a binary operation to two values
+     * @param op The operation
+     * @param a The first operand
+     * @param b The second operand
+     * @return The result
+     */
+    static double applyBinary(Op op, double a, double b);
+
+    class Parser; // Recursive-descent parser building the graph
+};
+
+} // namespace numerical
+
+#endif // EXPRESSION_H
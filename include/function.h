@@ -1,7 +1,11 @@
 #ifndef FUNCTION_H
 #define FUNCTION_H
 
+#include "expression.h"
+#include "function_kernels.h"
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -21,6 +25,13 @@ public:
      * @param choice The index of the predefined function to use
      */
     explicit Function(int choice);
+    
+    /**
+     * @brief Constructor for a user-supplied expression of x
+     * @param expression The expression, e.g. "exp(-x^2)*cos(3*x)" (see Expression)
+     * @throws std::invalid_argument if the expression cannot be parsed
+     */
+    explicit Function(const std::string& expression);
 
     /**
      * @brief Evaluates the function at a given point
@@ -29,12 +40,38 @@ public:
      */
     double evaluate(double x) const;
     
+    /**
+     * @brief Evaluates the function at a batch of points
+     * 
+     * Uses the vectorized kernel of the predefined function, or the compiled
+     * bytecode of an expression, so the hot loops of the integrators avoid
+     * one indirect call per sample.
+     * 
+     * @param x The points at which to evaluate the function
+     * @param y Output array receiving f(x[i]) for each point
+     * @param count The number of points
+     * @throws std::domain_error if any point is outside the function's domain
+     */
+    void evaluate(const double* x, double* y, std::size_t count) const;
+    
     /**
      * @brief Get the function's description for display
      * @return The function description as a string
      */
     std::string getDescription() const;
     
+    /**
+     * @brief Get the index of the predefined function
+     * @return The choice passed to the constructor, or 0 for an expression
+     */
+    int getChoice() const;
+    
+    /**
+     * @brief Get the source text of an expression function
+     * @return The expression, or an empty string for a predefined function
+     */
+    std::string getExpression() const;
+    
     /**
      * @brief Get the list of available predefined functions
      * @return Vector of function descriptions
@@ -43,7 +80,11 @@ public:
 
 private:
     std::function<double(double)> func; // Function to evaluate
+    kernels::BatchKernel batchKernel;   // Batch version of func
+    std::shared_ptr<const Expression> expression; // Compiled expression (null for predefined functions)
     std::string description;            // Function description
+    int choice;                         // Predefined function index (0 for expressions)
+    std::string source;                 // Expression text (empty for predefined functions)
 };
 
 } // namespace numerical
@@ -0,0 +1,43 @@
+#ifndef FUNCTION_KERNELS_H
+#define FUNCTION_KERNELS_H
+
+#include <cstddef>
+
+namespace numerical {
+
+/**
+ * @namespace kernels
+ * @brief Batch evaluation kernels for the predefined functions
+ */
+namespace kernels {
+
+/**
+ * @brief Evaluates a function at count points, writing y[i] = f(x[i])
+ *
+ * Kernels throw std::domain_error if any point is outside the domain.
+ */
+using BatchKernel = void (*)(const double* x, double* y, std::size_t count);
+
+/**
+ * @brief Select the batch kernel for a predefined function
+ *
+ * The instruction set (AVX-512, AVX2 or scalar) is detected once at run
+ * time. All kernels only use correctly rounded operations, so every
+ * instruction set produces exactly the same values as Function::evaluate().
+ *
+ * @param choice The index of the predefined function
+ * @return The kernel for the function
+ */
+BatchKernel selectKernel(int choice);
+
+/**
+ * @brief Get the name of the instruction set used by the kernels
+ * @return "AVX-512", "AVX2" or "scalar"
+ */
+const char* instructionSet();
+
+} // namespace kernels
+
+} // namespace numerical
+
+#endif // FUNCTION_KERNELS_H
@@ -0,0 +1,140 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class Grid
+ * @brief Integration points on [a, b], with precomputed rule weights
+ *
+ * A grid stores its points and the composite trapezoidal and Simpson 1/3
+ * weights of every point in separate arrays, so a rule is a single weighted
+ * sum over contiguous data. The weights hold for arbitrary spacing; Simpson's
+ * rule uses its form for unequal intervals on each pair of intervals.
+ *
+ * Non-uniform grids put the points where the integrand needs them. Grading
+ * toward an endpoint resolves integrable endpoint singularities such as
+ * ln(x) or sqrt(x) at 0, where a uniform grid converges slowly: on [0, 1],
+ * Simpson's rule on sqrt(x) is accurate to 1e-9 with 257 points graded with
+ * exponent 4, against 2e-5 for 257 uniform points. The endpoint itself is
+ * still evaluated, so a value that is undefined there counts as 0.
+ */
+class Grid {
+public:
+    /**
+     * @brief The endpoint a graded grid is refined toward
+     */
+    enum class Endpoint {
+        Lower,   // Points cluster at a
+        Upper    // Points cluster at b
+    };
+
+    /**
+     * @brief Equally spaced points a + i*(b-a)/n
+     * @param a Lower bound
+     * @param b Upper bound
+     * @param n Number of intervals
+     * @return The grid
+     * @throws std::invalid_argument if b <= a or n < 1
+     */
+    static Grid uniform(double a, double b, long long n);
+
+    /**
+     * @brief Chebyshev-Lobatto points (a+b)/2 - (b-a)/2 * cos(pi*i/n), clustered at both ends
+     * @param a Lower bound
+     * @param b Upper bound
+     * @param n Number of intervals
+     * @return The grid
+     * @throws std::invalid_argument if b <= a or n < 1
+     */
+    static Grid chebyshev(double a, double b, long long n);
+
+    /**
+     * @brief Power-law graded points a + (b-a) * (i/n)^exponent (mirrored toward b)
+     *
+     * For an integrand behaving like (x-a)^alpha, an exponent of at least
+     * (order of the rule) / (1 + alpha) restores the rule's uniform-grid
+     * convergence order.
+     *
+     * @param a Lower bound
+     * @param b Upper bound
+     * @param n Number of intervals
+     * @param exponent The grading exponent (1 gives a uniform grid)
+     * @param toward The endpoint the points cluster at
+     * @return The grid
+     * @throws std::invalid_argument if b <= a, n < 1, exponent <= 0 or points coincide
+     */
+    static Grid graded(double a, double b, long long n, double exponent, Endpoint toward = Endpoint::Lower);
+
+    /**
+     * @brief Points whose interval widths grow by a constant ratio away from an endpoint
+     * @param a Lower bound
+     * @param b Upper bound
+     * @param n Number of intervals
+     * @param ratio Width of each interval over that of its neighbour nearer the endpoint
+     * @param toward The endpoint the points cluster at
+     * @return The grid
+     * @throws std::invalid_argument if b <= a, n < 1, ratio < 1 or points coincide
+     */
+    static Grid geometric(double a, double b, long long n, double ratio, Endpoint toward = Endpoint::Lower);
+
+    /**
+     * @brief Constructor for user-supplied points
+     * @param points The points, strictly increasing, at least two
+     * @param description How the grid was made, for display
+     * @throws std::invalid_argument if there are fewer than two points or they do not increase
+     */
+    explicit Grid(std::vector<double> points, std::string description = "user-supplied");
+
+    /**
+     * @brief Get the number of intervals
+     * @return The number of points minus one
+     */
+    long long getIntervals() const;
+
+    /**
+     * @brief Get the first point
+     * @return The lower bound
+     */
+    double getLowerBound() const;
+
+    /**
+     * @brief Get the last point
+     * @return The upper bound
+     */
+    double getUpperBound() const;
+
+    /**
+     * @brief Get the points
+     * @return The points in increasing order
+     */
+    const std::vector<double>& getPoints() const;
+
+    /**
+     * @brief Get the weight of every point for a composite rule
+     * @param panel 1 for the trapezoidal rule or 2 for Simpson's 1/3 rule
+     * @return The weights, so that the rule is sum(weights[i] * f(points[i]))
+     * @throws std::invalid_argument for another panel width, or Simpson's
+     *         rule on an odd number of intervals
+     */
+    const std::vector<double>& getWeights(int panel) const;
+
+    /**
+     * @brief Get a description of the grid
+     * @return E.g. "graded toward a, exponent 3"
+     */
+    std::string getDescription() const;
+
+private:
+    std::vector<double> points;             // The points
+    std::vector<double> trapezoidWeights;   // Composite trapezoidal weights
+    std::vector<double> simpsonWeights;     // Composite Simpson 1/3 weights (empty for odd n)
+    std::string description;                // How the grid was made
+};
+
+} // namespace numerical
+
+#endif // GRID_H
@@ -10,7 +10,8 @@ namespace numerical {
  * @brief Handles user input for integration parameters
  * 
  * This class manages the input of integration boundaries, interval count,
- * and function selection.
+ * and function selection. The console members, the prompting constructor
+ * and display(), are built with the front end rather than numerical_core.
  */
 class Input {
 public:
@@ -2,12 +2,32 @@
 #define INTEGRATOR_H
 
 #include "function.h"
+#include "grid.h"
 #include "input.h"
+#include "observer.h"
+#include "sample_cache.h"
+#include "summation.h"
+#include "thread_pool.h"
+#include <array>
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace numerical {
 
+/**
+ * @struct IntegrationResult
+ * @brief Outcome of one calculation
+ */
+struct IntegrationResult {
+    double value = 0.0;              // Approximation of the integral
+    double errorEstimate = 0.0;      // Estimated absolute error (NaN if the method has none)
+    long long evaluations = 0;       // Function evaluations used
+    double seconds = 0.0;            // Wall-clock time of the calculation
+    bool applicable = true;          // False if the method cannot be applied to the input
+};
+
 /**
  * @class Integrator
  * @brief Base class for numerical integration methods
@@ -31,10 +51,14 @@ public:
 
     /**
      * @brief Perform the numerical integration
-     * @param showSteps Whether to display intermediate steps
-     * @return The result of the integration
+     * 
+     * Does no console output and never pauses; intermediate steps are only
+     * produced when an observer is given.
+     * 
+     * @param observer Optional observer receiving the intermediate steps
+     * @return The value, error estimate, evaluation count and timing
      */
-    virtual double calculate(bool showSteps = true) = 0;
+    IntegrationResult integrate(IntegrationObserver* observer = nullptr);
     
     /**
      * @brief Get the name of the integration method
@@ -42,25 +66,156 @@ public:
      */
     virtual std::string getMethodName() const = 0;
     
+    /**
+     * @brief Check if the method is applicable to the integration parameters
+     * @return True if applicable, false otherwise
+     */
+    virtual bool isApplicable() const;
+    
+    /**
+     * @brief Get the estimated absolute error of the last calculation
+     * @return The error estimate, or NaN if the method does not provide one
+     */
+    virtual double getErrorEstimate() const;
+    
     /**
      * @brief Get the result of the integration
      * @return The result (only valid after calculate() is called)
      */
     double getResult() const;
     
+    /**
+     * @brief Get the number of function evaluations of the last calculation
+     * @return The evaluation count (only valid after calculate() is called)
+     */
+    long long getEvaluationCount() const;
+    
     /**
      * @brief Save the results to a file
      * @param filename The name of the file to save to
      * @return True if successful, false otherwise
      */
     bool saveResultToFile(const std::string& filename) const;
+    
+    /**
+     * @brief Save the function values on the input's grid as a binary SampleFile
+     * 
+     * Stored or cached values are written as they are; missing ones are
+     * evaluated chunk by chunk on the configured threads, so memory use stays
+     * bounded for any number of intervals.
+     * 
+     * @param filename The name of the file to save to
+     * @param error Receives a message if saving fails
+     * @return True if successful, false otherwise
+     */
+    bool saveSamplesToFile(const std::string& filename, std::string& error) const;
+    
+    /**
+     * @brief Set the number of threads used to evaluate and sum the grid
+     * 
+     * Results do not depend on the thread count: the grid is always split
+     * into the same fixed-size blocks whose partial sums are combined in order.
+     * 
+     * @param threads The number of threads (0 uses all hardware threads)
+     */
+    void setThreadCount(unsigned threads);
+    
+    /**
+     * @brief Get the number of threads used by calculate()
+     * @return The thread count (0 means all hardware threads)
+     */
+    unsigned getThreadCount() const;
+    
+    /**
+     * @brief Set how the samples are added up
+     * 
+     * Naive summation is the fastest; the compensated methods keep the
+     * rounding error small when the number of intervals is very large.
+     * 
+     * @param method The summation method (default Summation::Naive)
+     */
+    void setSummation(Summation method);
+    
+    /**
+     * @brief Get the summation method used by calculate()
+     * @return The summation method
+     */
+    Summation getSummation() const;
+    
+    /**
+     * @brief Share function values with other integrators through a cache
+     * 
+     * Grid-based rules read their samples from the cache, evaluating and
+     * storing the grid on a miss. The result does not change; only the
+     * function evaluations are saved. While steps are shown only grids
+     * already in the cache are read.
+     * 
+     * @param cache The cache, or nullptr to evaluate every sample
+     */
+    void setSampleCache(SampleCache* cache);
+    
+    /**
+     * @brief Integrate over a given grid instead of the input's uniform one
+     * 
+     * Supported by the trapezoidal and Simpson 1/3 rules, which then sum
+     * the grid's precomputed weights times the function values; the other
+     * methods ignore the grid. The grid must outlive the calculations.
+     * 
+     * @param grid The grid, or nullptr for the uniform grid of the input
+     */
+    void setGrid(const Grid* grid);
 
 protected:
     const Input& input;              // Integration parameters
     const Function& function;        // Function to integrate
     double result;                   // Integration result
+    long long evaluations;           // Function evaluations used for the result
     std::vector<double> xValues;     // x values used in integration
     std::vector<double> yValues;     // Corresponding function values
+    bool gridSampled;                // Whether calculate() sampled the uniform grid
+    mutable BlockRunner blocks;      // Runs the blocks of grid sums on the configured threads
+    Summation summation;             // How samples are added up
+    IntegrationObserver* observer;   // Observer of the running calculation (may be null)
+    SampleCache* sampleCache;        // Shared function values (may be null)
+    const double* cachedSamples;     // Grid values taken from the cache (null if none)
+    long long cachedStride;          // Distance between grid points in cachedSamples
+    const Grid* grid;                // Grid replacing the uniform one (may be null)
+    
+    /**
+     * Number of intervals per reduction block. A multiple of every panel
+     * width (1, 2, 3 and 4) so that blocks always start on a panel boundary.
+     */
+    static constexpr int BLOCK_INTERVALS = 12 * 4096;
+    
+    /**
+     * Number of samples handed to Function::evaluate() at once
+     */
+    static constexpr int BATCH_SIZE = 256;
+    
+    /**
+     * @brief Compute the integral, storing it in result and evaluations
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    virtual double compute(bool showSteps) = 0;
+    
+    /**
+     * @brief Start a line of step output for the observer
+     * @return A writer that passes the line on at the end of the statement
+     */
+    StepWriter step() const;
+    
+    /**
+     * @brief Let an interactive observer pause
+     * @param milliseconds The suggested pause
+     */
+    void pause(int milliseconds) const;
+    
+    /**
+     * @brief Tell the observer that the method cannot be applied
+     * @param reason Why the method is not applicable
+     */
+    void reportNotApplicable(const std::string& reason) const;
     
     /**
      * @brief Calculate the step size
@@ -74,9 +229,130 @@ protected:
     void generatePoints();
     
     /**
-     * @brief Display intermediate values during integration
+     * @brief Prepare the uniform grid for a calculation
+     * @param storePoints Whether to materialize xValues/yValues (needed for
+     *        displaying steps); otherwise samples come from the sample cache
+     *        if one is set, or are evaluated on the fly
+     */
+    void preparePoints(bool storePoints);
+    
+    /**
+     * @brief Get the function value at the i-th grid point
+     * 
+     * Reads the stored or cached value when there is one, otherwise evaluates
+     * the function at a + i*h. Undefined values are reported to the observer
+     * and replaced by 0.
+     * 
+     * @param i The grid index (0 to n)
+     * @return The function value at the grid point
+     */
+    double sampleAt(int i) const;
+    
+    /**
+     * @brief Evaluate the function, reporting and zeroing undefined values
+     * @param x The point at which to evaluate the function
+     * @return The function value, or 0 if the function is undefined at x
+     */
+    double evaluatePoint(double x) const;
+    
+    /**
+     * @brief Evaluate the function at a batch of points
+     * 
+     * Uses the batch kernel of the function. If any point is undefined the
+     * batch is re-evaluated point by point, reporting and zeroing undefined values.
+     * 
+     * @param x The points at which to evaluate the function
+     * @param y Output array receiving the function values
+     * @param count The number of points
+     */
+    void evaluateBatch(const double* x, double* y, int count) const;
+    
+    /**
+     * @brief Get the function values at consecutive grid points
+     * @param begin The first grid index
+     * @param count The number of grid points (at most BATCH_SIZE)
+     * @param y Output array receiving the function values
+     */
+    void sampleRange(int begin, int count, double* y) const;
+    
+    /**
+     * @brief Sum the interior samples f(x_1) ... f(x_{n-1}) by index residue
+     * 
+     * sums[r] holds the sum of the samples whose index i satisfies
+     * i % period == r, added up with the configured summation method. The
+     * grid is processed in blocks of BLOCK_INTERVALS, in parallel when more
+     * than one thread is configured, and the block sums are combined in
+     * block order so the result is bit-reproducible.
+     * 
+     * @param period The panel width of the rule (1 to 4)
+     * @return The per-residue sums
+     */
+    std::array<double, 4> sumInteriorByResidue(int period) const;
+    
+    /**
+     * @brief Sum f(origin + (first + stride*k) * step) for k = 0 .. count-1
+     * 
+     * Uses the same blocked, thread-count-independent reduction as
+     * sumInteriorByResidue(); undefined values are reported and zeroed.
+     * 
+     * @param origin The origin of the point sequence
+     * @param step The unit by which point offsets are scaled
+     * @param first The offset of the first point, in units of step
+     * @param stride The distance between points, in units of step
+     * @param count The number of points
+     * @param samples Optional precomputed values; point k is then read from
+     *        samples[(first + stride*k) * sampleStride] instead of evaluated
+     * @param sampleStride The distance between unit steps in samples
+     * @return The sum of the function values
+     */
+    double sumStrided(double origin, double step, long long first, long long stride,
+                      long long count, const double* samples = nullptr, long long sampleStride = 1) const;
+    
+    /**
+     * @brief Sum weights[i] * f(x[i]) for i = 0 .. count-1
+     * 
+     * Uses the same blocked, thread-count-independent reduction as
+     * sumInteriorByResidue(); undefined values are reported and zeroed.
+     * 
+     * @param x The points
+     * @param weights The weight of each point
+     * @param count The number of points
+     * @return The weighted sum
+     */
+    double sumWeighted(const double* x, const double* weights, long long count) const;
+    
+    /**
+     * @brief Apply a rule to the grid set with setGrid()
+     * 
+     * Stores the result and the evaluation count, and reports the steps.
+     * 
+     * @param panel 1 for the trapezoidal rule or 2 for Simpson's 1/3 rule
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double computeOnGrid(int panel, bool showSteps);
+    
+    /**
+     * @brief Run sumBlock(block) for every block on the configured threads
+     * @param blockCount The number of blocks
+     * @param sumBlock The per-block work
+     */
+    void forEachBlock(long long blockCount, const std::function<void(std::size_t)>& sumBlock) const;
+    
+    /**
+     * @brief Get a grid on [a, b] from the sample cache
+     * @param n Number of intervals of the grid
+     * @param stride Receives the distance between grid points in the returned values
+     * @param fill Whether to evaluate and store the grid on a miss
+     * @return f(a + i*(b-a)/n) at index i*stride, or nullptr if there is no
+     *         cache or the grid is neither stored nor filled
+     */
+    const double* lookupCachedGrid(int n, long long& stride, bool fill);
+    
+    /**
+     * @brief Pass the stored sample points to the observer
      */
-    void displayIntermediateValues() const;
+    void reportSamples() const;
 };
 
 } // namespace numerical
@@ -0,0 +1,89 @@
+#ifndef METHOD_PROFILE_H
+#define METHOD_PROFILE_H
+
+#include "function.h"
+#include <map>
+#include <string>
+
+namespace numerical {
+
+/**
+ * @struct MethodDecision
+ * @brief The method chosen for an integration problem and its settings
+ */
+struct MethodDecision {
+    std::string method;                 // Method name as accepted by --method
+    int intervals = 0;                  // Intervals, or Gauss-Legendre panels (0 if unused)
+    int order = 0;                      // Romberg order, or Gauss-Legendre points (0 if unused)
+    long long predictedEvaluations = 0; // Evaluations the cost model expects
+    std::string reason;                 // Short explanation of the choice
+};
+
+/**
+ * @class MethodProfile
+ * @brief Remembers the method chosen for each integration problem
+ *
+ * A problem is identified by the function, the bounds and the tolerance
+ * (see makeKey()). The profile is kept in a small tab-separated text file,
+ * one problem per line, so repeated jobs can reuse a decision instead of
+ * probing the integrand again.
+ */
+class MethodProfile {
+public:
+    /**
+     * @brief Read the decisions stored in a file
+     *
+     * A file that does not exist yet gives an empty profile. Lines that
+     * cannot be parsed are skipped.
+     *
+     * @param filename The profile file
+     * @param error Receives a message if the file exists but cannot be read
+     * @return True if successful, false otherwise
+     */
+    bool load(const std::string& filename, std::string& error);
+
+    /**
+     * @brief Write all decisions to a file, replacing its contents
+     * @param filename The profile file
+     * @param error Receives a message if the file cannot be written
+     * @return True if successful, false otherwise
+     */
+    bool save(const std::string& filename, std::string& error) const;
+
+    /**
+     * @brief Look up the decision for a problem
+     * @param key The problem (see makeKey())
+     * @return The decision, or nullptr if there is none
+     */
+    const MethodDecision* find(const std::string& key) const;
+
+    /**
+     * @brief Store the decision for a problem, replacing any earlier one
+     * @param key The problem (see makeKey())
+     * @param decision The decision
+     */
+    void record(const std::string& key, const MethodDecision& decision);
+
+    /**
+     * @brief Get the number of stored decisions
+     * @return The number of problems
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Build the key of a problem
+     * @param function The integrand
+     * @param lowerBound Lower bound of integration
+     * @param upperBound Upper bound of integration
+     * @param tolerance The requested tolerance
+     * @return The function description, bounds and tolerance in one string
+     */
+    static std::string makeKey(const Function& function, double lowerBound, double upperBound, double tolerance);
+
+private:
+    std::map<std::string, MethodDecision> decisions;   // Decisions by key
+};
+
+} // namespace numerical
+
+#endif // METHOD_PROFILE_H
@@ -0,0 +1,87 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include "../integrator.h"
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class AdaptiveQuadrature
+ * @brief Implements adaptive Gauss-Kronrod (G7/K15) quadrature
+ *
+ * The interval is repeatedly bisected where the local error estimate is
+ * largest until the total estimated error meets the requested tolerance.
+ * Smooth regions therefore get few nodes and difficult regions (such as
+ * endpoint singularities) get many. The function is never evaluated at the
+ * endpoints of the interval, and the interval count of the input is ignored.
+ */
+class AdaptiveQuadrature : public Integrator {
+public:
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration
+     * @param function Function to integrate
+     * @param absTolerance Absolute error tolerance
+     * @param relTolerance Relative error tolerance
+     * @param maxSegments Maximum number of subintervals
+     */
+    AdaptiveQuadrature(const Input& input, const Function& function,
+                       double absTolerance = 1e-10, double relTolerance = 1e-10,
+                       int maxSegments = 10000);
+
+    /**
+     * @brief Get the name of the method
+     * @return The method name
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Get the estimated absolute error of the last calculation
+     * @return The error estimate
+     */
+    double getErrorEstimate() const override;
+
+    /**
+     * @brief Get the number of subintervals used by the last calculation
+     * @return The segment count
+     */
+    int getSegmentCount() const;
+
+protected:
+    /**
+     * @brief Compute the integral using adaptive Gauss-Kronrod quadrature
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    /**
+     * @struct Segment
+     * @brief A subinterval with its Kronrod estimate and error estimate
+     */
+    struct Segment {
+        double left;
+        double right;
+        double value;
+        double error;
+    };
+
+    double absTolerance;                // Absolute error tolerance
+    double relTolerance;                // Relative error tolerance
+    int maxSegments;                    // Maximum number of subintervals
+    double errorEstimate;               // Estimated error of the result
+    std::vector<Segment> segments;      // Arena holding every live segment
+    std::vector<int> heap;              // Max-heap of segment indices keyed by error
+
+    /**
+     * @brief Apply the 15-point Kronrod rule (with embedded 7-point Gauss rule) to a segment
+     * @param segment The segment, whose value and error are filled in
+     */
+    void applyRule(Segment& segment);
+};
+
+} // namespace numerical
+
+#endif // ADAPTIVE_H
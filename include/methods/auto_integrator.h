@@ -0,0 +1,132 @@
+#ifndef AUTO_INTEGRATOR_H
+#define AUTO_INTEGRATOR_H
+
+#include "../integrator.h"
+#include "../method_profile.h"
+#include <memory>
+
+namespace numerical {
+
+/**
+ * @class AutoIntegrator
+ * @brief Chooses the cheapest method for a tolerance and then applies it
+ *
+ * Before integrating, the integrand is probed on a uniform grid of 65
+ * points plus two 8-point Gauss-Legendre rules (89 evaluations):
+ *
+ * - the evaluation time per point;
+ * - whether f is undefined or infinite at an endpoint;
+ * - the observed convergence order of the trapezoidal, Simpson 1/3 and
+ *   Boole rules on 16, 32 and 64 intervals, which tells smooth integrands
+ *   (order 4 or more for Simpson) from rough ones;
+ * - for rough integrands, whether the largest second difference lies next
+ *   to an endpoint or inside the interval.
+ *
+ * A cost model then predicts the evaluations each candidate needs to meet
+ * max(tolerance, tolerance * |I|): the Newton-Cotes rules from their
+ * observed order and error, Romberg from its diagonal on the probe grid,
+ * Gauss-Legendre (8 points per panel) from the two probe rules, adaptive
+ * Gauss-Kronrod from the number of bisections the observed order implies,
+ * and tanh-sinh from the number of digits (only when the integrand is
+ * smooth inside the interval). Rules that evaluate the endpoints are not
+ * considered if f is undefined there. The cheapest candidate within the
+ * budget wins; if none fits, the cheapest overall is used.
+ *
+ * With a MethodProfile the decision is looked up before probing and stored
+ * afterwards, so repeated problems skip the probe.
+ */
+class AutoIntegrator : public Integrator {
+public:
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration (the interval count is ignored)
+     * @param function Function to integrate
+     * @param tolerance Target error, absolute or relative to the result
+     */
+    AutoIntegrator(const Input& input, const Function& function, double tolerance = 1e-10);
+
+    /**
+     * @brief Limit the cost of the chosen method
+     * @param maxEvaluations Largest number of evaluations (0 = no limit)
+     * @param maxSeconds Largest predicted time in seconds (0 = no limit)
+     */
+    void setBudget(long long maxEvaluations, double maxSeconds);
+
+    /**
+     * @brief Use a profile of earlier decisions
+     * @param profile The profile, or nullptr; must outlive the integrator
+     */
+    void setProfile(MethodProfile* profile);
+
+    /**
+     * @brief Get the decision of the last calculation
+     * @return The chosen method and its settings
+     */
+    const MethodDecision& getDecision() const;
+
+    /**
+     * @brief Check whether the last decision came from the profile
+     * @return True if the probe was skipped
+     */
+    bool usedProfile() const;
+
+    /**
+     * @brief Get the name of the method
+     * @return "Automatic" followed by the chosen method once it is known
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Get the estimated absolute error of the last calculation
+     * @return The chosen method's estimate, or NaN if it has none
+     */
+    double getErrorEstimate() const override;
+
+protected:
+    /**
+     * @brief Probe the integrand (or consult the profile), choose a method and apply it
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    /**
+     * Intervals of the probe grid
+     */
+    static constexpr int PROBE_INTERVALS = 64;
+
+    /**
+     * Gauss-Legendre points per panel of the probe and of the chosen rule
+     */
+    static constexpr int GAUSS_POINTS = 8;
+
+    double tolerance;                       // Target error
+    long long maxEvaluations;               // Evaluation budget (0 = none)
+    double maxSeconds;                      // Time budget (0 = none)
+    MethodProfile* profile;                 // Earlier decisions (may be null)
+    MethodDecision decision;                // Decision of the last calculation
+    bool fromProfile;                       // Whether the decision was looked up
+    std::unique_ptr<Input> chosenInput;     // Input of the chosen method
+    std::unique_ptr<Integrator> chosen;     // The chosen method
+
+    /**
+     * @brief Probe the integrand and choose a method
+     * @param showSteps Whether to pass the probe results to the observer
+     * @param probeEvaluations Receives the evaluations of the probe
+     * @return The decision
+     */
+    MethodDecision probe(bool showSteps, long long& probeEvaluations);
+
+    /**
+     * @brief Check whether a decision fits the budget
+     * @param evaluations The predicted evaluations
+     * @param secondsPerEvaluation The measured evaluation time
+     * @return True if both limits are kept
+     */
+    bool withinBudget(double evaluations, double secondsPerEvaluation) const;
+};
+
+} // namespace numerical
+
+#endif // AUTO_INTEGRATOR_H
@@ -21,13 +21,6 @@ public:
      */
     BooleRule(const Input& input, const Function& function);
     
-    /**
-     * @brief Perform the integration using Boole's rule
-     * @param showSteps Whether to display intermediate steps
-     * @return The result of the integration
-     */
-    double calculate(bool showSteps = true) override;
-    
     /**
      * @brief Get the name of the method
      * @return The method name
@@ -38,7 +31,15 @@ public:
      * @brief Check if the method is applicable for the given number of intervals
      * @return True if applicable, false otherwise
      */
-    bool isApplicable() const;
+    bool isApplicable() const override;
+
+protected:
+    /**
+     * @brief Compute the integral using Boole's rule
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
 };
 
 } // namespace numerical
@@ -0,0 +1,96 @@
+#ifndef GAUSS_LEGENDRE_H
+#define GAUSS_LEGENDRE_H
+
+#include "../integrator.h"
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class GaussLegendre
+ * @brief Implements composite Gauss-Legendre quadrature
+ *
+ * The interval is divided into as many equal panels as the input has
+ * intervals, and each panel is integrated with a fixed Gauss-Legendre rule.
+ * A rule with p points is exact for polynomials of degree 2p-1, so smooth
+ * integrands converge much faster than with the Newton-Cotes rules for the
+ * same number of evaluations. The function is never evaluated at the
+ * endpoints of the panels.
+ */
+class GaussLegendre : public Integrator {
+public:
+    /**
+     * Largest number of points per panel
+     */
+    static constexpr int MAX_POINTS = 256;
+
+    /**
+     * @struct Rule
+     * @brief Nodes and weights of a Gauss-Legendre rule on [-1, 1]
+     *
+     * Only the non-negative half is stored, in descending order; the nodes
+     * of the negative half are the mirrored values with the same weights.
+     * For an odd number of points the last node is 0.
+     */
+    struct Rule {
+        int points;
+        std::vector<double> nodes;
+        std::vector<double> weights;
+    };
+
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration
+     * @param function Function to integrate
+     * @param points Number of points per panel (1 to MAX_POINTS)
+     */
+    GaussLegendre(const Input& input, const Function& function, int points = 8);
+
+    /**
+     * @brief Get the name of the method
+     * @return The method name
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Get the number of points per panel
+     * @return The point count
+     */
+    int getPoints() const;
+
+    /**
+     * @brief Get the Gauss-Legendre rule with the given number of points
+     *
+     * Rules for common orders come from built-in tables; others are computed
+     * once by Newton iteration on the Legendre recurrence. Every rule is kept
+     * in a process-wide cache, so repeated calls return the same object. Safe
+     * to call from several threads.
+     *
+     * @param points Number of points (1 to MAX_POINTS)
+     * @return The rule
+     * @throws std::invalid_argument if points is out of range
+     */
+    static const Rule& getRule(int points);
+
+protected:
+    /**
+     * @brief Compute the integral using composite Gauss-Legendre quadrature
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    int points;                 // Points per panel
+
+    /**
+     * @brief Compute a rule by Newton iteration
+     * @param points Number of points
+     * @return The rule
+     */
+    static Rule computeRule(int points);
+};
+
+} // namespace numerical
+
+#endif // GAUSS_LEGENDRE_H
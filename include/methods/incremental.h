@@ -0,0 +1,116 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "../integrator.h"
+#include <array>
+
+namespace numerical {
+
+/**
+ * @class IncrementalIntegrator
+ * @brief A composite Newton-Cotes rule whose grid can be refined in place
+ *
+ * The integrator keeps f(a), f(b) and the sums of the interior samples
+ * grouped by grid index modulo 12, which is enough to apply any of the
+ * trapezoidal, Simpson 1/3, Simpson 3/8 and Boole rules. Refining the grid
+ * by an integer factor k only evaluates the new points: the old points keep
+ * their values and just move to index k*i. A convergence sweep over n, 2n,
+ * 4n, ... therefore costs about as many evaluations as the finest run alone.
+ *
+ * Results agree with the corresponding rule classes up to rounding, since
+ * the samples are added up in a different order.
+ */
+class IncrementalIntegrator : public Integrator {
+public:
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration; the interval count is the
+     *        starting level
+     * @param function Function to integrate
+     * @param panel Panel width of the rule: 1 trapezoidal, 2 Simpson 1/3,
+     *        3 Simpson 3/8 or 4 Boole
+     */
+    IncrementalIntegrator(const Input& input, const Function& function, int panel = 2);
+
+    /**
+     * @brief Get the name of the method
+     * @return The method name
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Check if the rule fits the current number of intervals
+     * @return True if the interval count is a multiple of the panel width
+     */
+    bool isApplicable() const override;
+
+    /**
+     * @brief Multiply the number of intervals, evaluating only the new points
+     *
+     * The next call of integrate() returns the rule on the refined grid.
+     * Samples are taken from the input's interval count first if needed.
+     *
+     * @param factor The refinement factor (at least 2)
+     * @throws std::invalid_argument if factor is less than 2
+     */
+    void refine(int factor);
+
+    /**
+     * @brief Discard the samples, so the next calculation starts again from the input
+     */
+    void reset();
+
+    /**
+     * @brief Get the number of intervals of the current grid
+     * @return The interval count (the input's before the first calculation)
+     */
+    long long getIntervals() const;
+
+protected:
+    /**
+     * @brief Apply the rule to the current grid
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    /**
+     * Residue classes kept for the interior sums (a multiple of every panel width)
+     */
+    static constexpr int CLASSES = 12;
+
+    /**
+     * Interleaved partial sums per block: a multiple of CLASSES and of the SIMD width
+     */
+    static constexpr int LANES = 24;
+
+    int panel;                                   // Panel width of the rule
+    long long intervals;                         // Intervals of the sampled grid (0 = not sampled)
+    int baseIntervals;                           // Input interval count the samples started from
+    double lowerBound;                           // Bounds the samples were taken on
+    double upperBound;
+    double fa;                                   // f(a)
+    double fb;                                   // f(b)
+    std::array<Accumulator, CLASSES> classSums;  // Interior sums by grid index % CLASSES
+    long long pendingEvaluations;                // Evaluations since the last calculation
+
+    /**
+     * @brief Sample the input's grid from scratch
+     */
+    void start();
+
+    /**
+     * @brief Add f(a + (factor*j + offset) * h) for j = first .. last-1 to the class sums
+     * @param h The step of the grid
+     * @param factor The distance between the points, in grid steps
+     * @param offset The grid index of the point with j = 0
+     * @param first The first j
+     * @param last One past the last j
+     */
+    void addPoints(double h, long long factor, long long offset, long long first, long long last);
+};
+
+} // namespace numerical
+
+#endif // INCREMENTAL_H
@@ -0,0 +1,158 @@
+#ifndef INLINE_RULES_H
+#define INLINE_RULES_H
+
+#include <algorithm>
+
+namespace numerical {
+
+/**
+ * @namespace rules
+ * @brief Compile-time descriptions of the composite Newton-Cotes rules
+ *
+ * Each rule lists its panel width, the constexpr weight of every residue
+ * class of interior indices (weights[i % panel]) and how the endpoint and
+ * residue sums are combined. TrapezoidalRule, SimpsonOneThird,
+ * SimpsonThreeEighth and BooleRule combine their sums with these functions,
+ * so numerical::integrate() returns bit-identical results to those classes.
+ */
+namespace rules {
+
+/**
+ * Number of intervals per summation block (equal to Integrator::BLOCK_INTERVALS)
+ */
+constexpr int BLOCK_INTERVALS = 12 * 4096;
+
+/**
+ * @brief Number of interleaved partial sums used for a panel width
+ *
+ * Interior samples are added to laneCount(panel) running sums, sample i of a
+ * block going to sum i % laneCount(panel). The count is a multiple of the
+ * panel width, so each sum collects a single residue class, and a multiple of
+ * the SIMD width, so whole rows are added with vector instructions.
+ *
+ * @param panel The panel width (1 to 4)
+ * @return 8, or 24 for a panel width of 3
+ */
+constexpr int laneCount(int panel) {
+    return panel == 3 ? 24 : 8;
+}
+
+/**
+ * @brief Trapezoidal rule: h/2 * [f(a) + f(b) + 2 * sum(f(x_i))]
+ */
+struct Trapezoidal {
+    static constexpr int panel = 1;
+    static constexpr double endWeight = 1.0;
+    static constexpr double weights[panel] = {2.0};
+
+    static constexpr double combine(double fa, double fb, const double* sums, double h) {
+        return (h / 2) * (endWeight * (fa + fb) + weights[0] * sums[0]);
+    }
+};
+
+/**
+ * @brief Simpson's 1/3 rule: h/3 * [f(a) + f(b) + 4 * sum(f(x_odd)) + 2 * sum(f(x_even))]
+ */
+struct SimpsonOneThird {
+    static constexpr int panel = 2;
+    static constexpr double endWeight = 1.0;
+    static constexpr double weights[panel] = {2.0, 4.0};
+
+    static constexpr double combine(double fa, double fb, const double* sums, double h) {
+        return (h / 3) * (endWeight * (fa + fb) + (weights[1] * sums[1] + weights[0] * sums[0]));
+    }
+};
+
+/**
+ * @brief Simpson's 3/8 rule: 3h/8 * [f(a) + f(b) + 3 * sum(f(not divisible by 3)) + 2 * sum(f(divisible by 3))]
+ */
+struct SimpsonThreeEighth {
+    static constexpr int panel = 3;
+    static constexpr double endWeight = 1.0;
+    static constexpr double weights[panel] = {2.0, 3.0, 3.0};
+
+    static constexpr double combine(double fa, double fb, const double* sums, double h) {
+        return (3 * h / 8) * (endWeight * (fa + fb) + (weights[0] * sums[0] + weights[1] * (sums[1] + sums[2])));
+    }
+};
+
+/**
+ * @brief Boole's rule: 4h/90 * [7(f(a) + f(b)) + 32(sum1 + sum3) + 12(sum2) + 14(sum4)]
+ */
+struct Boole {
+    static constexpr int panel = 4;
+    static constexpr double endWeight = 7.0;
+    static constexpr double weights[panel] = {14.0, 32.0, 12.0, 32.0};
+
+    static constexpr double combine(double fa, double fb, const double* sums, double h) {
+        return (4 * h / 90) * (endWeight * (fa + fb) + weights[1] * (sums[1] + sums[3])
+                               + weights[2] * sums[2] + weights[0] * sums[0]);
+    }
+};
+
+} // namespace rules
+
+/**
+ * @brief Integrate a callable over [a, b] with a composite rule chosen at compile time
+ *
+ * The integrand is called directly (no std::function, no virtual calls), so
+ * it is inlined into the summation loop. Interior samples are summed in
+ * interleaved partial sums (see rules::laneCount()) in blocks of
+ * rules::BLOCK_INTERVALS, exactly as Integrator does with naive summation,
+ * and f is never called concurrently. Exceptions thrown by f propagate.
+ *
+ * Example: numerical::integrate<numerical::rules::Boole>([](double x) { return x * x; }, 0.0, 1.0, 400)
+ *
+ * @tparam Rule One of the structs in numerical::rules
+ * @param f The integrand, callable as double(double)
+ * @param a Lower bound of integration
+ * @param b Upper bound of integration
+ * @param n Number of intervals (must be a multiple of Rule::panel)
+ * @return The result of the integration, or 0 if n is not a multiple of Rule::panel
+ */
+template <typename Rule, typename F>
+double integrate(F&& f, double a, double b, int n) {
+    constexpr int P = Rule::panel;
+    constexpr int L = rules::laneCount(P);
+    if (n < 1 || n % P != 0) {
+        return 0.0;
+    }
+
+    const double h = (b - a) / n;
+    double sums[P] = {};
+
+    for (long long first = 0; first < n; first += rules::BLOCK_INTERVALS) {
+        const int begin = static_cast<int>(std::max(first, 1LL));
+        const int end = static_cast<int>(std::min(first + rules::BLOCK_INTERVALS, static_cast<long long>(n)));
+
+        // Blocks start on lane 0, so index i goes to lane (i - first) % L, whose
+        // residue class is lane % P; walk whole rows to avoid a modulo per sample
+        double lanes[L] = {};
+        int i = begin;
+        for (int lane = begin - static_cast<int>(first); lane < L && i < end; ++lane, ++i) {
+            lanes[lane] += f(a + i * h);
+        }
+        for (; i + L <= end; i += L) {
+            for (int lane = 0; lane < L; ++lane) {
+                lanes[lane] += f(a + (i + lane) * h);
+            }
+        }
+        for (int lane = 0; i < end; ++lane, ++i) {
+            lanes[lane] += f(a + i * h);
+        }
+
+        for (int r = 0; r < P; ++r) {
+            double blockSum = 0.0;
+            for (int lane = r; lane < L; lane += P) {
+                blockSum += lanes[lane];
+            }
+            sums[r] += blockSum;
+        }
+    }
+
+    return Rule::combine(f(a), f(a + n * h), sums, h);
+}
+
+} // namespace numerical
+
+#endif // INLINE_RULES_H
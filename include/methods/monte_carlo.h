@@ -0,0 +1,80 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "../integrator.h"
+#include "../sampling.h"
+#include <cstdint>
+
+namespace numerical {
+
+/**
+ * @class MonteCarlo
+ * @brief Implements Monte Carlo and quasi-Monte Carlo integration
+ *
+ * Averages f at N sample points of [a, b], where N is the interval count of
+ * the input, and multiplies by b - a. Pseudo-random points come from Philox
+ * streams; the error estimate is the standard error sqrt(s^2 / N) of the
+ * sample variance s^2, which shrinks like 1/sqrt(N).
+ *
+ * Sobol and Halton points fill the interval more evenly and converge close
+ * to 1/N for smooth integrands, but the spread of their values says nothing
+ * about the error. They are therefore split into REPLICATES independently
+ * randomized sequences (one per point when N is smaller) whose sizes differ
+ * by at most one and add up to N; the result is the mean of the replicate
+ * means and the error estimate their standard error.
+ *
+ * The points are generated and evaluated in fixed blocks that run on the
+ * configured threads and are combined in order, so the result only depends
+ * on the seed, never on the thread count.
+ */
+class MonteCarlo : public Integrator {
+public:
+    /**
+     * Number of randomized replicates of the quasi-random sequences
+     */
+    static constexpr int REPLICATES = 16;
+
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration (the interval count is the number of samples)
+     * @param function Function to integrate
+     * @param sampling How the sample points are generated
+     * @param seed The seed of the random numbers and randomizations
+     */
+    MonteCarlo(const Input& input, const Function& function, Sampling sampling = Sampling::Sobol,
+               std::uint64_t seed = 0);
+
+    /**
+     * @brief Get the name of the method
+     * @return The method name
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Get the estimated absolute error of the last calculation
+     * @return The standard error of the result
+     */
+    double getErrorEstimate() const override;
+
+protected:
+    /**
+     * @brief Compute the integral as the mean of the sampled values
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    /**
+     * Number of sample points per reduction block
+     */
+    static constexpr int BLOCK_POINTS = 8192;
+
+    Sampling sampling;          // How the sample points are generated
+    std::uint64_t seed;         // Seed of the random numbers
+    double standardError;       // Standard error of the result
+};
+
+} // namespace numerical
+
+#endif // MONTE_CARLO_H
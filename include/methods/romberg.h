@@ -11,7 +11,8 @@ namespace numerical {
  * @brief Implements Romberg integration method
  * 
  * Romberg integration uses extrapolation to improve the accuracy of
- * the trapezoidal rule.
+ * the trapezoidal rule. With a tolerance, the table is only extended until
+ * two successive diagonal entries agree.
  */
 class RombergIntegration : public Integrator {
 public:
@@ -19,26 +20,57 @@ public:
      * @brief Constructor
      * @param input Parameters for integration
      * @param function Function to integrate
-     * @param order The order of Romberg integration
+     * @param order The (maximum) order of Romberg integration, 1 to MAX_ORDER
+     * @param tolerance Stop once successive diagonal entries differ by at most
+     *        this amount, absolutely or relatively, from order 4 on (0 always
+     *        builds the full table)
      */
-    RombergIntegration(const Input& input, const Function& function, int order = 4);
-    
-    /**
-     * @brief Perform the integration using Romberg method
-     * @param showSteps Whether to display intermediate steps
-     * @return The result of the integration
-     */
-    double calculate(bool showSteps = true) override;
+    RombergIntegration(const Input& input, const Function& function, int order = 4,
+                       double tolerance = 0.0);
     
     /**
      * @brief Get the name of the method
      * @return The method name
      */
     std::string getMethodName() const override;
+    
+    /**
+     * @brief Get the order reached by the last calculation
+     * @return The reached order (equal to the order unless the tolerance was met earlier)
+     */
+    int getReachedOrder() const;
+    
+    /**
+     * @brief Get the difference between the last two diagonal entries
+     * @return The error estimate of the last calculation
+     */
+    double getErrorEstimate() const override;
+    
+    /**
+     * Highest supported order (2^30 intervals in the finest trapezoidal sum)
+     */
+    static constexpr int MAX_ORDER = 30;
+
+protected:
+    /**
+     * @brief Compute the integral using Romberg method
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
 
 private:
+    /**
+     * Lowest order at which the tolerance may end the calculation
+     */
+    static constexpr int MIN_CONVERGED_ORDER = 4;
+    
     int order;                          // Order of Romberg integration
-    std::vector<std::vector<double>> R; // Romberg table
+    double tolerance;                   // Convergence tolerance (0 = none)
+    int reachedOrder;                   // Order reached by the last calculation
+    double errorEstimate;               // |R[k][k] - R[k-1][k-1]| of the last calculation
+    std::vector<double> rows;           // Previous and current rows, stored flat
+    std::vector<double> table;          // Full triangular table, kept only to display steps
 };
 
 } // namespace numerical
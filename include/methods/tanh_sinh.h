@@ -0,0 +1,119 @@
+#ifndef TANH_SINH_H
+#define TANH_SINH_H
+
+#include "../integrator.h"
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class TanhSinh
+ * @brief Implements tanh-sinh (double exponential) quadrature
+ *
+ * The substitution x = (a+b)/2 + (b-a)/2 * tanh(pi/2 * sinh(t)) turns the
+ * integral into one over the whole real line whose integrand decays double
+ * exponentially, which the trapezoidal rule in t integrates with exponential
+ * convergence, even when f has an integrable singularity at an endpoint
+ * (ln(x) at 0, 1/sqrt(1-x^2) at +/-1). Each level halves the step in t and
+ * only evaluates the new nodes; levels are added until two successive
+ * results agree to the tolerance.
+ *
+ * The nodes cluster at the endpoints but are never evaluated there: they are
+ * computed from their distance to the nearer endpoint, and nodes that would
+ * round onto an endpoint are left out. Near a = 0 this resolves distances
+ * down to about 1e-300; near other endpoints the resolution is the spacing of
+ * the doubles there, which limits the accuracy for strong singularities.
+ * The error estimate includes this truncation, estimated from the terms at
+ * the outermost nodes, and the calculation only counts as converged when the
+ * estimate meets the tolerance; it stops early, unconverged, once the levels
+ * agree to within the truncation. The interval count of the input is ignored.
+ */
+class TanhSinh : public Integrator {
+public:
+    /**
+     * Largest number of step halvings (the step in t is 2^-level)
+     */
+    static constexpr int MAX_LEVEL = 12;
+
+    /**
+     * @struct Level
+     * @brief The nodes a level adds, for the interval [-1, 1]
+     *
+     * distances[j] is 1 - |x_j|, the distance of the node pair x = +/-(1 -
+     * distance) from the endpoints, and weights[j] the weight of each node of
+     * the pair, dx/dt. Level 0 starts with the centre node (distance 1),
+     * which is counted once. Nodes are in increasing t, so distances decrease.
+     */
+    struct Level {
+        double step;
+        std::vector<double> distances;
+        std::vector<double> weights;
+    };
+
+    /**
+     * @brief Constructor
+     * @param input Parameters for integration
+     * @param function Function to integrate
+     * @param tolerance Stop when the error estimate (see getErrorEstimate())
+     *        is at most max(tolerance, tolerance * |result|)
+     * @param maxLevel Largest level to compute (0 to MAX_LEVEL)
+     */
+    TanhSinh(const Input& input, const Function& function, double tolerance = 1e-10, int maxLevel = MAX_LEVEL);
+
+    /**
+     * @brief Get the name of the method
+     * @return The method name
+     */
+    std::string getMethodName() const override;
+
+    /**
+     * @brief Get the estimated absolute error of the last calculation
+     * @return The difference between the last two levels plus the
+     *         truncation at the endpoints
+     */
+    double getErrorEstimate() const override;
+
+    /**
+     * @brief Get the level at which the last calculation stopped
+     * @return The level
+     */
+    int getReachedLevel() const;
+
+    /**
+     * @brief Get the nodes and weights of a level
+     *
+     * Every level is computed once, in extended precision, and kept in a
+     * process-wide cache, so repeated calls return the same object. Safe to
+     * call from several threads.
+     *
+     * @param level The level (0 to MAX_LEVEL)
+     * @return The level's nodes and weights
+     * @throws std::invalid_argument if level is out of range
+     */
+    static const Level& getLevel(int level);
+
+protected:
+    /**
+     * @brief Compute the integral using tanh-sinh quadrature
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
+
+private:
+    double tolerance;           // Convergence tolerance
+    int maxLevel;               // Largest level to compute
+    double errorEstimate;       // Estimated error of the result
+    int reachedLevel;           // Level of the result
+
+    /**
+     * @brief Compute the nodes and weights of a level
+     * @param level The level
+     * @return The level
+     */
+    static Level computeLevel(int level);
+};
+
+} // namespace numerical
+
+#endif // TANH_SINH_H
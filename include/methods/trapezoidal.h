@@ -21,18 +21,19 @@ public:
      */
     TrapezoidalRule(const Input& input, const Function& function);
     
-    /**
-     * @brief Perform the integration using the Trapezoidal rule
-     * @param showSteps Whether to display intermediate steps
-     * @return The result of the integration
-     */
-    double calculate(bool showSteps = true) override;
-    
     /**
      * @brief Get the name of the method
      * @return The method name
      */
     std::string getMethodName() const override;
+
+protected:
+    /**
+     * @brief Compute the integral using the Trapezoidal rule
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The result of the integration
+     */
+    double compute(bool showSteps) override;
 };
 
 } // namespace numerical
@@ -0,0 +1,108 @@
+#ifndef MULTI_INTEGRATOR_H
+#define MULTI_INTEGRATOR_H
+
+#include "function.h"
+#include "input.h"
+#include "integrator.h"
+#include "observer.h"
+#include "summation.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class MultiIntegrator
+ * @brief Integrates several functions over the same grid in one pass
+ *
+ * Applies a composite Newton-Cotes rule to k integrands at once. Each batch
+ * of grid points is generated once and every integrand is evaluated on it
+ * while it is in cache; the interior sums of all integrands are kept side
+ * by side (one row of lanes or residue-class accumulators per integrand),
+ * so the grid is walked, split into blocks and distributed over the threads
+ * only once instead of k times.
+ *
+ * The grid is blocked, batched and summed exactly as by the rule classes,
+ * so each result is bit-identical to integrating that function alone with
+ * TrapezoidalRule, SimpsonOneThird, SimpsonThreeEighth or BooleRule, with
+ * any thread count.
+ */
+class MultiIntegrator {
+public:
+    /**
+     * @brief Constructor
+     * @param input Bounds and number of intervals (the function choice is ignored)
+     * @param integrands The functions to integrate; must outlive the integrator
+     * @param panel Panel width of the rule: 1 trapezoidal, 2 Simpson 1/3,
+     *        3 Simpson 3/8 or 4 Boole
+     * @throws std::invalid_argument if there are no integrands or the panel width is not 1 to 4
+     */
+    MultiIntegrator(const Input& input, const std::vector<Function>& integrands, int panel);
+
+    /**
+     * @brief Set the number of threads used to evaluate and sum the grid
+     * @param threads The number of threads (0 uses all hardware threads)
+     */
+    void setThreadCount(unsigned threads);
+
+    /**
+     * @brief Set how the samples are added up
+     * @param method The summation method (default Summation::Naive)
+     */
+    void setSummation(Summation method);
+
+    /**
+     * @brief Perform the integration
+     *
+     * If the number of intervals is not a multiple of the panel width the
+     * observer is told why, and every result has applicable set to false.
+     *
+     * @param observer Optional observer receiving the steps and undefined values
+     * @return One result per integrand, in order; the evaluations and time
+     *         are those of the shared pass
+     */
+    std::vector<IntegrationResult> integrate(IntegrationObserver* observer = nullptr);
+
+    /**
+     * @brief Get the name of the rule
+     * @return E.g. "Simpson's 1/3 Rule"
+     */
+    std::string getMethodName() const;
+
+private:
+    /**
+     * Number of intervals per reduction block (as in Integrator)
+     */
+    static constexpr int BLOCK_INTERVALS = 12 * 4096;
+
+    /**
+     * Number of samples handed to Function::evaluate() at once
+     */
+    static constexpr int BATCH_SIZE = 256;
+
+    const Input& input;                         // Bounds and intervals
+    const std::vector<Function>& integrands;    // Functions to integrate
+    int panel;                                  // Panel width of the rule
+    BlockRunner blocks;                         // Runs the blocks of samples on the configured threads
+    Summation summation;                        // How samples are added up
+    IntegrationObserver* observer;              // Observer of the running calculation (may be null)
+
+    /**
+     * @brief Apply the rule to every integrand
+     * @param showSteps Whether to pass intermediate steps to the observer
+     * @return The results, in the order of the integrands
+     */
+    std::vector<double> compute(bool showSteps);
+
+    /**
+     * @brief Start a line of step output for the observer
+     * @return A writer that passes the line on at the end of the statement
+     */
+    StepWriter step() const;
+};
+
+} // namespace numerical
+
+#endif // MULTI_INTEGRATOR_H
@@ -0,0 +1,120 @@
+#ifndef OBSERVER_H
+#define OBSERVER_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class IntegrationObserver
+ * @brief Receives the intermediate steps of a calculation
+ *
+ * Integrators never print or pause by themselves; everything a user might
+ * want to follow is passed to an observer. All callbacks do nothing by
+ * default, so an observer only overrides what it is interested in.
+ */
+class IntegrationObserver {
+public:
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~IntegrationObserver() = default;
+
+    /**
+     * @brief Whether step-by-step output is wanted
+     *
+     * When false, only onNotApplicable() and onUndefinedValue() are called
+     * and the integrator does not store the sample points.
+     *
+     * @return True to receive the steps
+     */
+    virtual bool wantsSteps() const { return true; }
+
+    /**
+     * @brief Called with each line of the step-by-step explanation
+     * @param text The line, without a trailing newline
+     */
+    virtual void onStep(const std::string& text) { (void)text; }
+
+    /**
+     * @brief Called with the sample points of a grid-based rule
+     * @param x The sample points
+     * @param y The function values at the sample points
+     * @param h The step size
+     */
+    virtual void onSamples(const std::vector<double>& x, const std::vector<double>& y, double h) {
+        (void)x; (void)y; (void)h;
+    }
+
+    /**
+     * @brief Called where an interactive display should pause
+     * @param milliseconds The suggested pause
+     */
+    virtual void onPause(int milliseconds) { (void)milliseconds; }
+
+    /**
+     * @brief Called when the method cannot be applied to the input
+     * @param reason Why the method is not applicable
+     */
+    virtual void onNotApplicable(const std::string& reason) { (void)reason; }
+
+    /**
+     * @brief Called when the function is undefined at a sample, which then counts as 0
+     *
+     * May be called from the worker threads of a parallel sum; calls are
+     * serialized by the integrator.
+     *
+     * @param x The point at which the function is undefined
+     * @param message The error message of the function
+     */
+    virtual void onUndefinedValue(double x, const std::string& message) { (void)x; (void)message; }
+};
+
+/**
+ * @class StepWriter
+ * @brief Collects one line of step output and passes it to an observer
+ *
+ * Used as a temporary: step() << "h = " << h; hands the line over when the
+ * statement ends.
+ */
+class StepWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param observer The observer receiving the line
+     */
+    explicit StepWriter(IntegrationObserver* observer) : observer(observer) {}
+
+    /**
+     * @brief Destructor, passes the collected line to the observer
+     */
+    ~StepWriter() {
+        if (observer) {
+            observer->onStep(text.str());
+        }
+    }
+
+    StepWriter(const StepWriter&) = delete;
+    StepWriter& operator=(const StepWriter&) = delete;
+
+    /**
+     * @brief Append a value or stream manipulator to the line
+     * @param value The value to append
+     * @return This writer
+     */
+    template<typename T>
+    StepWriter& operator<<(const T& value) {
+        text << value;
+        return *this;
+    }
+
+private:
+    IntegrationObserver* observer;   // Receives the line (may be null)
+    std::ostringstream text;         // The line being collected
+};
+
+} // namespace numerical
+
+#endif // OBSERVER_H
@@ -0,0 +1,128 @@
+#ifndef PARAMETRIC_SWEEP_H
+#define PARAMETRIC_SWEEP_H
+
+#include "cubature.h"
+#include "expression.h"
+#include "observer.h"
+#include "summation.h"
+#include "thread_pool.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class ParametricSweep
+ * @brief Integrates a family f(x; p) over [a, b] for many values of p
+ *
+ * The integrand is an expression of x and p. For each parameter value the
+ * integral is approximated with the same one-dimensional rule (see
+ * Cubature::createRule()), so the rule is built once for the whole sweep.
+ *
+ * The (p, x) grid is processed in tiles of PARAMETER_TILE consecutive
+ * parameters by NODE_TILE nodes: every tile is one batched call of the
+ * expression, with the parameters as the fast index so the bytecode and the
+ * weighted accumulation run across p in SIMD lanes, and the running sums of
+ * a parameter tile stay in cache while all nodes pass by. Parameter tiles
+ * are independent and run on the configured threads.
+ *
+ * The weighted values of each parameter are added up with the configured
+ * summation method. Results do not depend on the thread count.
+ */
+class ParametricSweep {
+public:
+    /**
+     * @brief Constructor
+     * @param integrand The integrand, an expression of x and p (in that order)
+     * @param lowerBound Lower bound of integration
+     * @param upperBound Upper bound of integration
+     * @param method The rule: trapezoidal, simpson13, simpson38, boole or gauss
+     * @param intervals Intervals, or Gauss-Legendre panels
+     * @throws std::invalid_argument if the integrand does not use the
+     *         variables x and p, or the method does not suit the intervals
+     */
+    ParametricSweep(const Expression& integrand, double lowerBound, double upperBound, const std::string& method,
+                    int intervals);
+
+    /**
+     * @brief Set the number of Gauss-Legendre points per panel
+     * @param points Points per panel (1 to GaussLegendre::MAX_POINTS, default 4)
+     * @throws std::invalid_argument if points is out of range
+     */
+    void setGaussPoints(int points);
+
+    /**
+     * @brief Set the number of threads the parameter tiles run on
+     * @param threads The number of threads (0 uses all hardware threads)
+     */
+    void setThreadCount(unsigned threads);
+
+    /**
+     * @brief Set how the weighted values of each parameter are added up
+     * @param method The summation method (default Summation::Naive)
+     */
+    void setSummation(Summation method);
+
+    /**
+     * @brief Integrate for every parameter value
+     * @param parameters The parameter values, contiguous
+     * @param count The number of parameter values
+     * @param results Output array receiving the integral for each parameter value
+     * @param observer Optional observer receiving the steps and undefined values
+     */
+    void integrate(const double* parameters, std::size_t count, double* results,
+                   IntegrationObserver* observer = nullptr);
+
+    /**
+     * @brief Integrate for every parameter value
+     * @param parameters The parameter values
+     * @param observer Optional observer receiving the steps and undefined values
+     * @return The integral for each parameter value, in the same order
+     */
+    std::vector<double> integrate(const std::vector<double>& parameters, IntegrationObserver* observer = nullptr);
+
+    /**
+     * @brief Get the number of function evaluations of the last sweep
+     * @return Nodes times parameter values
+     */
+    long long getEvaluationCount() const;
+
+    /**
+     * @brief Get the name of the method
+     * @return E.g. "Simpson's 1/3 Rule (1000 intervals)"
+     */
+    std::string getMethodName() const;
+
+private:
+    /**
+     * Number of parameter values per tile (the SIMD direction)
+     */
+    static constexpr int PARAMETER_TILE = 256;
+
+    /**
+     * Number of nodes per tile
+     */
+    static constexpr int NODE_TILE = 8;
+
+    const Expression& integrand;    // Integrand f(x; p)
+    double lowerBound;              // Lower bound of integration
+    double upperBound;              // Upper bound of integration
+    std::string method;             // Rule
+    int intervals;                  // Intervals, or Gauss-Legendre panels
+    int gaussPoints;                // Gauss-Legendre points per panel
+    BlockRunner blocks;             // Runs the parameter tiles on the configured threads
+    Summation summation;            // How weighted values are added up
+    IntegrationObserver* observer;  // Observer of the running sweep (may be null)
+    long long evaluations;          // Evaluations of the last sweep
+
+    /**
+     * @brief Start a line of step output for the observer
+     * @return A writer that passes the line on at the end of the statement
+     */
+    StepWriter step() const;
+};
+
+} // namespace numerical
+
+#endif // PARAMETRIC_SWEEP_H
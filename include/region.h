@@ -0,0 +1,118 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include "expression.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class Region
+ * @brief A domain of integration in one to three dimensions
+ *
+ * The region is given by nested bounds: the first variable x runs between
+ * two constants, the second variable y between two expressions of x, and
+ * the third variable z between two expressions of x and y. Rectangles and
+ * boxes have constant bounds throughout; triangles, discs, simplices and
+ * other simple regions have bounds that depend on the outer variables, e.g.
+ * 0 <= x <= 1, 0 <= y <= x for a triangle.
+ *
+ * If an upper bound is below its lower bound, that part of the region
+ * counts negatively, as for a one-dimensional integral from b to a.
+ */
+class Region {
+public:
+    /**
+     * Largest number of dimensions
+     */
+    static constexpr int MAX_DIMENSION = 3;
+
+    /**
+     * @brief A box with constant bounds
+     * @param lower Lower bound of each dimension
+     * @param upper Upper bound of each dimension
+     * @return The region
+     * @throws std::invalid_argument if the bounds do not have 1 to MAX_DIMENSION
+     *         entries each, or are not finite
+     */
+    static Region box(const std::vector<double>& lower, const std::vector<double>& upper);
+
+    /**
+     * @brief Constructor for bounds given as expressions
+     * @param lower Lower bound of each dimension; bound k may use the first k
+     *        variables of x, y, z
+     * @param upper Upper bound of each dimension, like lower
+     * @throws std::invalid_argument if the bounds do not have 1 to MAX_DIMENSION
+     *         entries each or an expression is invalid
+     */
+    Region(const std::vector<std::string>& lower, const std::vector<std::string>& upper);
+
+    /**
+     * @brief Get the number of dimensions
+     * @return 1, 2 or 3
+     */
+    int getDimension() const;
+
+    /**
+     * @brief Get the variable names of the dimensions
+     * @return The first getDimension() of x, y and z
+     */
+    std::vector<std::string> getVariables() const;
+
+    /**
+     * @brief Check whether the bounds of a dimension are constant
+     * @param dimension The dimension (0 to getDimension() - 1)
+     * @return True if neither bound depends on the outer variables
+     */
+    bool hasConstantBounds(int dimension) const;
+
+    /**
+     * @brief Check whether every bound is constant
+     * @return True for a rectangle or box
+     */
+    bool isBox() const;
+
+    /**
+     * @brief Get the bounds of a dimension at a batch of points
+     *
+     * A bound that is undefined at a point is a domain error of the region,
+     * not of the integrand, so it is not caught here.
+     *
+     * @param dimension The dimension (0 to getDimension() - 1)
+     * @param outer outer[k][i] is variable k at point i, for k < dimension
+     * @param lower Output array receiving the lower bounds
+     * @param upper Output array receiving the upper bounds
+     * @param count The number of points
+     * @throws std::domain_error if a bound is not finite
+     */
+    void getBounds(int dimension, const double* const* outer, double* lower, double* upper,
+                   std::size_t count) const;
+
+    /**
+     * @brief Get a description of the region for display
+     * @return E.g. "0 <= x <= 1, 0 <= y <= x"
+     */
+    std::string getDescription() const;
+
+private:
+    /**
+     * @struct Bounds
+     * @brief The bounds of one dimension
+     */
+    struct Bounds {
+        std::shared_ptr<const Expression> lower;   // Lower bound, an expression of the outer variables
+        std::shared_ptr<const Expression> upper;   // Upper bound
+        bool constant;                             // Whether both bounds are constants
+        double lowerValue;                         // Value of a constant lower bound
+        double upperValue;                         // Value of a constant upper bound
+    };
+
+    std::vector<Bounds> bounds;   // Bounds of each dimension, outermost first
+};
+
+} // namespace numerical
+
+#endif // REGION_H
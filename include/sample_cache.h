@@ -0,0 +1,115 @@
+#ifndef SAMPLE_CACHE_H
+#define SAMPLE_CACHE_H
+
+#include "function.h"
+#include <cstddef>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class SampleCache
+ * @brief Function values on uniform grids, shared between integrators
+ *
+ * A grid is identified by the Function object, the bounds and the number of
+ * intervals. A grid with n intervals also serves every grid whose interval
+ * count divides n by a power of two, because those points are computed to
+ * exactly the same doubles; Romberg integration uses this to read its dyadic
+ * levels from a finer grid. Integrators using a cache return bit-identical
+ * results to integrators without one.
+ *
+ * Grids are keyed by the address of the Function, so the cache must not
+ * outlive the functions it holds values for. A cache is not thread-safe; it
+ * may be shared by integrators that run one after another.
+ */
+class SampleCache {
+public:
+    /**
+     * Default limit on the number of stored samples (128 MiB of values)
+     */
+    static constexpr std::size_t DEFAULT_MAX_SAMPLES = std::size_t(1) << 24;
+
+    /**
+     * @brief Constructor
+     * @param maxSamples Largest total number of samples to keep
+     */
+    explicit SampleCache(std::size_t maxSamples = DEFAULT_MAX_SAMPLES);
+
+    /**
+     * @brief Find the values of a grid, or of a finer grid containing it
+     * @param function The function
+     * @param a Lower bound of the grid
+     * @param b Upper bound of the grid
+     * @param n Number of intervals of the grid
+     * @param stride Receives the distance between consecutive points of the
+     *        requested grid in the returned array
+     * @return f(a + i*h) for the stored grid, or nullptr if there is none
+     */
+    const double* find(const Function& function, double a, double b, long long n, long long& stride) const;
+
+    /**
+     * @brief Check whether a grid with n intervals fits into the cache
+     * @param n Number of intervals
+     * @return True if store() would keep the grid
+     */
+    bool canStore(long long n) const;
+
+    /**
+     * @brief Store the values of a grid
+     * @param function The function
+     * @param a Lower bound of the grid
+     * @param b Upper bound of the grid
+     * @param n Number of intervals of the grid
+     * @param values The n + 1 function values
+     * @return The stored values
+     */
+    const double* store(const Function& function, double a, double b, long long n, std::vector<double> values);
+
+    /**
+     * @brief Serve a grid from values kept elsewhere, e.g. a mapped SampleFile
+     * 
+     * The values are neither copied nor counted against the size limit or the
+     * evaluation count; they must stay valid while the cache is used.
+     * 
+     * @param function The function
+     * @param a Lower bound of the grid
+     * @param b Upper bound of the grid
+     * @param n Number of intervals of the grid
+     * @param values The n + 1 function values
+     */
+    void attach(const Function& function, double a, double b, long long n, const double* values);
+
+    /**
+     * @brief Get the number of function evaluations spent on stored grids
+     * @return The evaluation count
+     */
+    long long getEvaluationCount() const;
+
+    /**
+     * @brief Remove all grids
+     */
+    void clear();
+
+private:
+    /**
+     * @struct Grid
+     * @brief The values of one grid
+     */
+    struct Grid {
+        const Function* function;
+        double a;
+        double b;
+        long long n;
+        const double* data;           // The values (owned or attached)
+        std::vector<double> values;   // Owned values (empty for attached grids)
+    };
+
+    std::vector<Grid> grids;          // Stored grids (few, searched linearly)
+    std::size_t maxSamples;           // Largest total number of samples
+    std::size_t storedSamples;        // Samples currently stored
+    long long evaluationCount;        // Evaluations spent on stored grids
+};
+
+} // namespace numerical
+
+#endif // SAMPLE_CACHE_H
@@ -0,0 +1,130 @@
+#ifndef SAMPLE_FILE_H
+#define SAMPLE_FILE_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class SampleFile
+ * @brief Binary file of the function values on a uniform grid
+ *
+ * The file starts with a header holding the method, the function (its
+ * description plus the predefined index or expression needed to rebuild it),
+ * the bounds and the number of intervals, followed by the n + 1 values
+ * f(a + i*h) as packed native doubles, aligned to 8 bytes. A grid of 10^8
+ * intervals takes 800 MB instead of several GB of text.
+ *
+ * Reading maps the file into memory (on POSIX systems; elsewhere it is read
+ * in one go), so the values are available without parsing or copying and
+ * pages are only loaded as a rule walks over them. Handing the values to a
+ * SampleCache lets any grid-based rule re-integrate them without evaluating
+ * the function.
+ */
+class SampleFile {
+public:
+    /**
+     * @struct Header
+     * @brief Description of the stored grid
+     */
+    struct Header {
+        std::string method;          // Name of the method that sampled the grid
+        std::string description;     // Function description for display
+        int functionChoice = 1;      // Predefined function index (0 for an expression)
+        std::string expression;      // Expression of x (empty for a predefined function)
+        double lowerBound = 0.0;     // Lower bound of the grid
+        double upperBound = 1.0;     // Upper bound of the grid
+        long long intervals = 0;     // Number of intervals (n + 1 values are stored)
+    };
+
+    /**
+     * Produces values[0 .. count-1] = f(x_begin) ... f(x_{begin+count-1})
+     */
+    using Producer = std::function<void(long long begin, std::size_t count, double* values)>;
+
+    /**
+     * Number of values written per chunk (8 MiB)
+     */
+    static constexpr std::size_t CHUNK_VALUES = std::size_t(1) << 20;
+
+    /**
+     * @brief Write a sample file
+     *
+     * The values are requested from produce() in chunks of CHUNK_VALUES and
+     * written with one large write per chunk, so memory use does not grow
+     * with the grid.
+     *
+     * @param filename The name of the file to write
+     * @param header The grid description
+     * @param produce Callback filling each chunk of values
+     * @param error Receives a message if writing fails
+     * @return True if successful, false otherwise
+     */
+    static bool write(const std::string& filename, const Header& header, const Producer& produce,
+                      std::string& error);
+
+    /**
+     * @brief Check whether a file starts like a sample file
+     * @param filename The name of the file
+     * @return True if the file has the sample file signature
+     */
+    static bool isSampleFile(const std::string& filename);
+
+    /**
+     * @brief Constructor, with no file open
+     */
+    SampleFile();
+
+    /**
+     * @brief Destructor, unmapping the file
+     */
+    ~SampleFile();
+
+    SampleFile(const SampleFile&) = delete;
+    SampleFile& operator=(const SampleFile&) = delete;
+
+    /**
+     * @brief Open and map a sample file, closing any previous one
+     * @param filename The name of the file to open
+     * @param error Receives a message if the file cannot be read or is malformed
+     * @return True if successful, false otherwise
+     */
+    bool open(const std::string& filename, std::string& error);
+
+    /**
+     * @brief Unmap the file; values returned earlier become invalid
+     */
+    void close();
+
+    /**
+     * @brief Check whether a file is open
+     * @return True if open() succeeded and close() was not called since
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get the description of the stored grid
+     * @return The header of the open file
+     */
+    const Header& getHeader() const;
+
+    /**
+     * @brief Get the stored values
+     * @return f(a + i*h) at index i, for i = 0 .. intervals, or nullptr if no file is open
+     */
+    const double* getValues() const;
+
+private:
+    Header header;               // Header of the open file
+    const double* values;        // Stored values inside the mapping or buffer
+    void* mapping;               // Start of the mapped file (null when read into buffer)
+    std::size_t mappedBytes;     // Length of the mapping
+    std::vector<double> buffer;  // File contents where mapping is not available
+};
+
+} // namespace numerical
+
+#endif // SAMPLE_FILE_H
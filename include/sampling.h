@@ -0,0 +1,197 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @brief How Monte Carlo sample points are generated
+ */
+enum class Sampling {
+    Pseudo,   // Independent pseudo-random points (Philox4x32-10)
+    Sobol,    // Sobol low-discrepancy sequence with a random digital shift
+    Halton    // Halton low-discrepancy sequence with a random rotation
+};
+
+/**
+ * @brief Get the command-line name of a sampling method
+ * @param method The sampling method
+ * @return "pseudo", "sobol" or "halton"
+ */
+std::string samplingName(Sampling method);
+
+/**
+ * @brief Look up a sampling method by its command-line name
+ * @param name The name (see samplingName())
+ * @param method Receives the method if the name is known
+ * @return True if the name is known
+ */
+bool parseSampling(const std::string& name, Sampling& method);
+
+/**
+ * @brief Get the number of points of one replicate when points are split over replicates
+ *
+ * The first points % replicates replicates get one point more than the
+ * others, so the sizes add up to points.
+ *
+ * @param points The total number of points
+ * @param replicates The number of replicates
+ * @param replicate The replicate (0 to replicates - 1)
+ * @return The points of the replicate
+ */
+long long replicateSize(long long points, int replicates, int replicate);
+
+/**
+ * @brief Describe how points are split over replicates (see replicateSize())
+ * @param points The total number of points
+ * @param replicates The number of replicates
+ * @return E.g. "16 x 64 points" or "8 x 8 + 8 x 7 points"
+ */
+std::string describeReplicates(long long points, int replicates);
+
+/**
+ * @struct SampleMoments
+ * @brief Count, mean and sum of squared deviations of a set of values
+ *
+ * Sets are merged with the pairwise update of Chan, Golub and LeVeque,
+ * which stays accurate when the mean is large compared to the spread.
+ * Merging the same sets in the same order gives the same result.
+ */
+struct SampleMoments {
+    long long count = 0;      // Number of values
+    double mean = 0.0;        // Mean of the values
+    double squares = 0.0;     // Sum of squared deviations from the mean
+
+    /**
+     * @brief Add a batch of values
+     * @param values The values
+     * @param n The number of values
+     */
+    void add(const double* values, std::size_t n);
+
+    /**
+     * @brief Add the values of another set
+     * @param other The other set
+     */
+    void merge(const SampleMoments& other);
+
+    /**
+     * @brief Get the sample variance
+     * @return The unbiased variance, or 0 for fewer than two values
+     */
+    double variance() const;
+};
+
+/**
+ * @class Philox
+ * @brief The Philox4x32-10 counter-based random number generator
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits with ten
+ * rounds of multiplications and key additions. There is no state: any
+ * number of threads can generate any part of any stream directly, so
+ * results never depend on how the work is split.
+ */
+class Philox {
+public:
+    /**
+     * @brief Constructor
+     * @param seed The key
+     */
+    explicit Philox(std::uint64_t seed);
+
+    /**
+     * @brief Get the random bits for a counter
+     * @param counter The counter
+     * @return Four random 32-bit words
+     */
+    std::array<std::uint32_t, 4> generate(const std::array<std::uint32_t, 4>& counter) const;
+
+    /**
+     * @brief Get uniform doubles u_first .. u_{first+count-1} of a stream
+     *
+     * Every value is an odd multiple of 2^-53 with 52 random bits, so it lies
+     * strictly inside (0, 1).
+     *
+     * @param stream The stream (e.g. replicate and dimension)
+     * @param first The index of the first value in the stream
+     * @param u Output array receiving the values
+     * @param count The number of values
+     */
+    void uniforms(std::uint64_t stream, std::uint64_t first, double* u, std::size_t count) const;
+
+private:
+    std::uint32_t key[2];   // The key (seed)
+};
+
+/**
+ * @class SamplingSequence
+ * @brief Sample points in the unit cube (0, 1)^d for Monte Carlo integration
+ *
+ * Points are addressed by replicate and index, so any block of any
+ * replicate can be generated independently. Replicates of the Sobol and
+ * Halton sequences are randomized independently (a digital shift or a
+ * rotation modulo 1 drawn from the seed), which keeps their low discrepancy
+ * while making the replicate means independent, unbiased estimates whose
+ * spread gives a standard error. Pseudo-random replicates are independent
+ * Philox streams.
+ */
+class SamplingSequence {
+public:
+    /**
+     * Largest number of dimensions
+     */
+    static constexpr int MAX_DIMENSION = 8;
+
+    /**
+     * @brief Constructor
+     * @param method How the points are generated
+     * @param dimension The number of coordinates (1 to MAX_DIMENSION)
+     * @param seed The seed of the random numbers and randomizations
+     * @throws std::invalid_argument if the dimension is out of range
+     */
+    SamplingSequence(Sampling method, int dimension, std::uint64_t seed);
+
+    /**
+     * @brief Generate consecutive points of a replicate
+     * @param replicate The replicate
+     * @param first The index of the first point
+     * @param count The number of points
+     * @param coordinates coordinates[k][i] receives coordinate k of point first + i
+     */
+    void generate(std::uint32_t replicate, std::uint64_t first, std::size_t count,
+                  double* const* coordinates) const;
+
+    /**
+     * @brief Get the sampling method
+     * @return The method
+     */
+    Sampling getMethod() const;
+
+private:
+    /**
+     * Bits of the Sobol direction numbers (and the largest number of Sobol points)
+     */
+    static constexpr int SOBOL_BITS = 32;
+
+    Sampling method;                          // How the points are generated
+    int dimension;                            // Number of coordinates
+    Philox philox;                            // Random numbers and randomizations
+    std::vector<std::array<std::uint32_t, SOBOL_BITS>> directions;   // Sobol direction numbers per dimension
+
+    /**
+     * @brief Get the randomization of a replicate in one dimension
+     * @param replicate The replicate
+     * @param k The dimension
+     * @return 32 random bits
+     */
+    std::uint32_t shift(std::uint32_t replicate, int k) const;
+};
+
+} // namespace numerical
+
+#endif // SAMPLING_H
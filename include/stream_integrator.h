@@ -0,0 +1,171 @@
+#ifndef STREAM_INTEGRATOR_H
+#define STREAM_INTEGRATOR_H
+
+#include "summation.h"
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace numerical {
+
+/**
+ * @class StreamIntegrator
+ * @brief Applies a composite Newton-Cotes rule to samples arriving in chunks
+ *
+ * Tabulated data (measurements, simulation output) is fed in with addValues()
+ * for equally spaced samples or addPoints() for (x, y) pairs, in chunks of any
+ * size. Only a handful of values are carried from one chunk to the next, so
+ * the memory use does not depend on the length of the data, and the rule
+ * weights are applied across chunk boundaries exactly as on one array.
+ *
+ * Equally spaced samples are added up in the same blocks, batches and lanes
+ * as Integrator::sumInteriorByResidue(), so a stream of the values of a grid
+ * gives bit-identical results to the corresponding rule class. (x, y) pairs
+ * support the trapezoidal rule and Simpson's 1/3 rule in its form for
+ * unequal intervals.
+ */
+class StreamIntegrator {
+public:
+    /**
+     * @brief Constructor
+     * @param panel Panel width of the rule: 1 trapezoidal, 2 Simpson 1/3,
+     *        3 Simpson 3/8 or 4 Boole
+     * @param summation How the samples are added up
+     * @throws std::invalid_argument if the panel width is not 1 to 4
+     */
+    explicit StreamIntegrator(int panel, Summation summation = Summation::Naive);
+
+    /**
+     * @brief Place equally spaced samples between two bounds
+     *
+     * The step is (upperBound - lowerBound) / intervals, known once the
+     * stream has ended.
+     *
+     * @param lowerBound The x of the first sample
+     * @param upperBound The x of the last sample
+     */
+    void setBounds(double lowerBound, double upperBound);
+
+    /**
+     * @brief Place equally spaced samples at a fixed step
+     * @param lowerBound The x of the first sample
+     * @param step The distance between samples
+     */
+    void setStep(double lowerBound, double step);
+
+    /**
+     * @brief Add the next equally spaced samples
+     * @param y The sample values
+     * @param count The number of samples
+     * @throws std::logic_error if points were added before
+     */
+    void addValues(const double* y, std::size_t count);
+
+    /**
+     * @brief Add the next (x, y) samples
+     * @param x The abscissas, strictly increasing across the whole stream
+     * @param y The sample values
+     * @param count The number of samples
+     * @throws std::logic_error if equally spaced values were added before
+     * @throws std::invalid_argument for Simpson 3/8 or Boole, or if x does not increase
+     */
+    void addPoints(const double* x, const double* y, std::size_t count);
+
+    /**
+     * @brief Apply the rule to everything added so far
+     * @param error Receives a message if the rule cannot be applied
+     * @return True if successful, false otherwise
+     */
+    bool finish(std::string& error);
+
+    /**
+     * @brief Get the name of the rule
+     * @return The method name
+     */
+    std::string getMethodName() const;
+
+    /**
+     * @brief Get the result of the last finish()
+     * @return The integral of the samples
+     */
+    double getResult() const;
+
+    /**
+     * @brief Get the number of samples added
+     * @return The sample count
+     */
+    long long getSampleCount() const;
+
+    /**
+     * @brief Get the x of the first sample
+     * @return The lower bound of the data
+     */
+    double getLowerBound() const;
+
+    /**
+     * @brief Get the x of the last sample
+     * @return The upper bound of the data
+     */
+    double getUpperBound() const;
+
+private:
+    /**
+     * Samples per summation block and per batch, as in Integrator
+     */
+    static constexpr long long BLOCK_INTERVALS = 12 * 4096;
+    static constexpr int BATCH_SIZE = 256;
+
+    enum class Layout { None, Values, Points };
+
+    int panel;                              // Panel width of the rule
+    Summation summation;                    // How samples are added up
+    Layout layout;                          // Kind of samples added so far
+    double lowerBound;                      // x of the first sample
+    double upperBound;                      // x of the last sample (bounds mode)
+    double step;                            // Step (0 = derive from the bounds)
+    long long count;                        // Samples added
+    double result;                          // Result of the last finish()
+
+    // Equally spaced samples
+    double first;                           // f(x_0)
+    double last;                            // Latest sample, held back until the next arrives
+    double batch[BATCH_SIZE];               // Interior samples not yet summed
+    int batchCount;                         // Samples in batch
+    long long batchStart;                   // Index of batch[0]
+    double lanes[MAX_INTERLEAVED_LANES];    // Interleaved sums of the current block (naive)
+    std::array<Accumulator, 4> blockSums;   // Residue sums of the current block
+    std::array<Accumulator, 4> totals;      // Residue sums of the finished blocks
+
+    // (x, y) samples
+    double previousX[2];                    // The last two points of the stream
+    double previousY[2];
+    Accumulator pointSum;                   // Sum of the finished panels
+
+    /**
+     * @brief Add interior sample i, which is known not to be the last one
+     * @param i The sample index
+     * @param value The sample value
+     */
+    void commit(long long i, double value);
+
+    /**
+     * @brief Add the batch to the block sums
+     */
+    void flushBatch();
+
+    /**
+     * @brief Add the block sums to the totals and start a new block
+     */
+    void flushBlock();
+
+    /**
+     * @brief Add one (x, y) point, closing a panel when it is complete
+     * @param x The abscissa
+     * @param y The value
+     */
+    void addPoint(double x, double y);
+};
+
+} // namespace numerical
+
+#endif // STREAM_INTEGRATOR_H
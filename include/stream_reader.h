@@ -0,0 +1,68 @@
+#ifndef STREAM_READER_H
+#define STREAM_READER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class StreamReader
+ * @brief Reads tabulated samples from a stream in fixed-size chunks
+ *
+ * Text input has one sample per line: a value y, or a pair x, y separated by
+ * a comma, semicolon or whitespace. Empty lines, lines starting with '#' and
+ * a non-numeric header line are skipped. Binary input is a sequence of native
+ * doubles (y, or x and y interleaved) and is read with one large read per
+ * chunk, which keeps up with the disk.
+ */
+class StreamReader {
+public:
+    /**
+     * @brief Constructor
+     * @param in The stream to read (opened in binary mode for binary input)
+     * @param binary Whether the input is raw doubles instead of text
+     * @param pairs Whether every sample is an (x, y) pair instead of a value
+     */
+    StreamReader(std::istream& in, bool binary, bool pairs);
+
+    /**
+     * @brief Read the next samples
+     * @param x Receives the abscissas (pairs only; may be null otherwise)
+     * @param y Receives the values
+     * @param capacity The largest number of samples to read
+     * @param error Receives a message if the input is malformed
+     * @return The number of samples read; 0 at the end of the input or on an error
+     */
+    std::size_t read(double* x, double* y, std::size_t capacity, std::string& error);
+
+    /**
+     * @brief Get the number of bytes consumed so far
+     * @return The byte count
+     */
+    long long getBytesRead() const;
+
+private:
+    std::istream& in;            // The input
+    bool binary;                 // Raw doubles instead of text
+    bool pairs;                  // (x, y) pairs instead of values
+    long long bytesRead;         // Bytes consumed so far
+    long long lineNumber;        // Current line of text input
+    std::vector<double> buffer;  // Interleaved pairs of binary input
+    std::string line;            // Current line of text input
+
+    /**
+     * @brief Parse one line of text input
+     * @param x Receives the abscissa of a pair
+     * @param y Receives the value
+     * @param error Receives a message if the line is malformed
+     * @return 1 if a sample was read, 0 if the line is skipped, -1 on an error
+     */
+    int parseLine(double& x, double& y, std::string& error);
+};
+
+} // namespace numerical
+
+#endif // STREAM_READER_H
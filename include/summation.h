@@ -0,0 +1,130 @@
+#ifndef SUMMATION_H
+#define SUMMATION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @brief How the samples of a rule are added up
+ *
+ * With naive summation the rounding error grows with the number of samples
+ * and, at around 10^8 intervals, exceeds the truncation error of the higher
+ * order rules. The compensated methods keep it close to one rounding.
+ */
+enum class Summation {
+    Naive,       // Plain running sum (fastest, error grows like n)
+    Kahan,       // Kahan compensated sum
+    Neumaier,    // Kahan-Babuska-Neumaier sum, also exact when terms exceed the sum
+    Pairwise,    // Pairwise sums of batches, combined in a binary cascade (error grows like log n)
+    Vectorized   // Eight interleaved Kahan sums, computed with SIMD where available
+};
+
+/**
+ * @brief Get the command-line name of a summation method
+ * @param method The summation method
+ * @return "naive", "kahan", "neumaier", "pairwise" or "vectorized"
+ */
+std::string summationName(Summation method);
+
+/**
+ * @brief Look up a summation method by its command-line name
+ * @param name The name (see summationName())
+ * @param method Receives the method if the name is known
+ * @return True if the name is known
+ */
+bool parseSummation(const std::string& name, Summation& method);
+
+/**
+ * @brief Get every summation method, cheapest first
+ * @return The summation methods
+ */
+std::vector<Summation> allSummations();
+
+/**
+ * Largest lane count accepted by addInterleaved()
+ */
+constexpr int MAX_INTERLEAVED_LANES = 24;
+
+/**
+ * @brief Add values to interleaved running sums
+ *
+ * values[k] is added to lanes[(offset + k) % laneCount]. Whole rows of
+ * laneCount values are added with SIMD where available; every instruction
+ * set performs the same additions in the same order, so the lane sums are
+ * identical everywhere.
+ *
+ * @param values The values to add
+ * @param count The number of values
+ * @param offset The lane receiving values[0] (0 to laneCount - 1)
+ * @param lanes The lane sums
+ * @param laneCount The number of lanes: 8 or 24
+ */
+void addInterleaved(const double* values, int count, int offset, double* lanes, int laneCount);
+
+/**
+ * @class Accumulator
+ * @brief A running sum using one of the summation methods
+ *
+ * Values are best added in batches, which lets the pairwise and vectorized
+ * methods work on whole arrays. For a given sequence of calls the result is
+ * the same on every instruction set.
+ */
+class Accumulator {
+public:
+    /**
+     * @brief Constructor, starting from 0
+     * @param method The summation method
+     */
+    explicit Accumulator(Summation method = Summation::Naive);
+
+    /**
+     * @brief Add one value
+     * @param value The value to add
+     */
+    void add(double value);
+
+    /**
+     * @brief Add values[0], values[stride], ..., values[(count - 1) * stride]
+     * @param values The values to add
+     * @param count The number of values
+     * @param stride The distance between consecutive values
+     */
+    void add(const double* values, int count, int stride = 1);
+
+    /**
+     * @brief Add the total of another accumulator
+     * @param other The accumulator to add
+     */
+    void add(const Accumulator& other);
+
+    /**
+     * @brief Get the sum of everything added so far
+     * @return The sum, including the compensation
+     */
+    double total() const;
+
+private:
+    static constexpr int LANES = 8;    // Interleaved sums of the vectorized method
+    static constexpr int LEVELS = 64;  // Cascade levels of the pairwise method
+
+    Summation method;                  // Summation method
+    double sum;                        // Running sum (naive, Kahan, Neumaier)
+    double compensation;               // Accumulated rounding error (Kahan, Neumaier)
+    double lanes[LANES];               // Per-lane sums (vectorized)
+    double laneCompensations[LANES];   // Per-lane rounding errors (vectorized)
+    double levels[LEVELS];             // levels[k] sums 2^k leaves when bit k of leaves is set (pairwise)
+    std::uint64_t leaves;              // Number of leaves pushed into the cascade (pairwise)
+
+    /**
+     * @brief Push one leaf into the pairwise cascade
+     * @param value The sum of the leaf
+     */
+    void pushLeaf(double value);
+};
+
+} // namespace numerical
+
+#endif // SUMMATION_H
@@ -0,0 +1,165 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace numerical {
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size pool of worker threads for data-parallel loops
+ *
+ * The calling thread takes part in every loop, so a pool of size 1 runs
+ * everything inline without creating any worker threads. Threads are
+ * numbered 0 (the caller) to size() - 1.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount Total number of threads, including the caller
+     *        (0 uses all hardware threads)
+     */
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    /**
+     * @brief Destructor, joins all worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of threads taking part in a loop
+     * @return The thread count, including the caller
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Run body(i) for every i in [0, count) and wait for completion
+     *
+     * Indices are handed out dynamically, so the order in which they run is
+     * unspecified. The first exception thrown by body is rethrown here.
+     *
+     * @param count The number of loop iterations
+     * @param body The loop body
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    /**
+     * @brief Run body(i, thread) for every i in [0, count) with work stealing
+     *
+     * Each thread owns a contiguous range of indices and works through it
+     * from the front; a thread that runs dry steals the back half of the
+     * largest remaining range. Suited to iterations of very uneven cost.
+     * The thread number lets the body reuse per-thread state.
+     *
+     * @param count The number of loop iterations
+     * @param body The loop body, given the index and the thread number
+     */
+    void parallelForStealing(std::size_t count,
+                             const std::function<void(std::size_t, unsigned)>& body);
+
+    /**
+     * @brief Get the number of hardware threads (at least 1)
+     * @return The hardware thread count
+     */
+    static unsigned hardwareThreads();
+
+private:
+    /**
+     * @struct IndexRange
+     * @brief Indices [begin, end) still owned by one thread
+     */
+    struct IndexRange {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<std::thread> workers;                    // Worker threads
+    std::mutex mutex;                                    // Guards the task state
+    std::condition_variable wakeUp;                      // Signals a new task or shutdown
+    std::condition_variable finished;                    // Signals that workers are idle
+    const std::function<void(unsigned)>* task;           // Current per-thread task
+    std::size_t busyWorkers;                             // Workers still running the task
+    unsigned long long generation;                       // Incremented for every task
+    bool stopping;                                       // Set when the pool shuts down
+    std::exception_ptr error;                            // First exception of the task
+
+    /**
+     * @brief Run threadTask(thread) once on every thread and wait for all of them
+     * @param threadTask The task, given the thread number
+     */
+    void runOnAllThreads(const std::function<void(unsigned)>& threadTask);
+
+    /**
+     * @brief Run work, recording the first exception thrown by any thread
+     * @param work The work to run
+     * @return True if work completed, false if it threw
+     */
+    bool runGuarded(const std::function<void()>& work);
+
+    /**
+     * @brief Main loop of a worker thread
+     * @param index The thread number
+     */
+    void workerLoop(unsigned index);
+};
+
+/**
+ * @class BlockRunner
+ * @brief Runs independent blocks of work on a configurable number of threads
+ *
+ * The ThreadPool is started on the first call that uses more than one thread
+ * and reused by later calls, such as the levels of Romberg or the tiles of
+ * a refinement sweep. With one thread, or one block, everything runs inline.
+ */
+class BlockRunner {
+public:
+    /**
+     * @brief Constructor
+     * @param threadCount The number of threads (0 uses all hardware threads)
+     */
+    explicit BlockRunner(unsigned threadCount = 1);
+
+    /**
+     * @brief Set the number of threads
+     * @param threads The number of threads (0 uses all hardware threads)
+     */
+    void setThreadCount(unsigned threads);
+
+    /**
+     * @brief Get the configured number of threads
+     * @return The thread count (0 means all hardware threads)
+     */
+    unsigned getThreadCount() const;
+
+    /**
+     * @brief Run body(block) for every block in [0, blockCount) and wait for completion
+     *
+     * The order in which blocks run is unspecified. The first exception
+     * thrown by body is rethrown here.
+     *
+     * @param blockCount The number of blocks
+     * @param body The per-block work
+     */
+    void run(long long blockCount, const std::function<void(std::size_t)>& body);
+
+private:
+    unsigned threadCount;               // Threads (0 = all)
+    std::unique_ptr<ThreadPool> pool;   // Workers, kept between calls (null until needed)
+};
+
+} // namespace numerical
+
+#endif // THREAD_POOL_H
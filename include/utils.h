@@ -2,43 +2,18 @@
 #define UTILS_H
 
 #include <string>
-#include <vector>
 
 namespace numerical {
 
 /**
  * @namespace utils
  * @brief Utility functions for the numerical integration library
+ *
+ * The console helpers (menus, key presses, pauses) are declared in
+ * console_utils.h and built with the front end, not numerical_core.
  */
 namespace utils {
 
-/**
- * @brief Display a menu and get user choice
- * @param title The menu title
- * @param options The menu options
- * @param minOption The minimum allowed option number
- * @param maxOption The maximum allowed option number
- * @return The chosen option
- */
-int getMenuChoice(const std::string& title, const std::vector<std::string>& options, 
-                  int minOption = 1, int maxOption = -1);
-
-/**
- * @brief Wait for user to press a key
- */
-void waitForKeyPress();
-
-/**
- * @brief Clear the console screen
- */
-void clearScreen();
-
-/**
- * @brief Wait for specified milliseconds
- * @param ms The number of milliseconds to wait
- */
-void sleep(int ms);
-
 /**
  * @brief Format a number with specified precision
  * @param value The value to format
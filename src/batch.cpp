@@ -0,0 +1,292 @@
+#include "../include/batch.h"
+#include "../include/cli.h"
+#include "../include/console_observer.h"
+#include "../include/function.h"
+#include "../include/input.h"
+#include "../include/integrator.h"
+#include "../include/thread_pool.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+// Remove leading and trailing whitespace (and a surrounding pair of quotes)
+std::string trimValue(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r\n");
+    std::string value = text.substr(first, last - first + 1);
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+// Split a line on a separator that is not inside double quotes
+std::vector<std::string> splitOutsideQuotes(const std::string& line, char separator) {
+    std::vector<std::string> parts;
+    std::string current;
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        }
+        if (c == separator && !quoted) {
+            parts.push_back(current);
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    parts.push_back(current);
+    return parts;
+}
+
+/**
+ * Objects reused by one thread for all of its problems. The integrators
+ * keep references to input and function, which are reassigned per problem.
+ */
+struct ThreadState {
+    Input input{0.0, 1.0, 1, 1};
+    Function function{1};
+    std::string functionKey = "1";  // Function choice or expression of function
+    ConsoleObserver console{false}; // Reports undefined values only
+    std::map<std::string, std::unique_ptr<Integrator>> integrators;
+};
+
+} // namespace
+
+bool BatchRunner::loadFromFile(const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        error = "Could not open batch file '" + filename + "'";
+        return false;
+    }
+
+    problems.clear();
+    std::vector<std::string> columns;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::string content = trimValue(line);
+
+        // Skip comments and empty lines
+        if (content.empty() || content[0] == '#') {
+            continue;
+        }
+
+        Problem problem;
+        bool parsed;
+        if (content[0] == '{') {
+            parsed = parseJsonLine(content, problem);
+        } else if (columns.empty()) {
+            // The first CSV line is the header
+            for (const auto& column : splitOutsideQuotes(content, ',')) {
+                columns.push_back(trimValue(column));
+            }
+            continue;
+        } else {
+            parsed = parseCsvLine(content, columns, problem);
+        }
+
+        if (!parsed) {
+            error = "Invalid problem on line " + std::to_string(lineNumber) + " of '" + filename + "'";
+            return false;
+        }
+        problems.push_back(problem);
+    }
+    return true;
+}
+
+std::size_t BatchRunner::run(std::ostream& out, const std::string& format, unsigned threads) {
+    const bool json = format == "json";
+    if (!json) {
+        out << "index,method,function,lower,upper,intervals,result,evaluations,error\n";
+    }
+
+    ThreadPool pool(threads);
+    std::vector<std::unique_ptr<ThreadState>> states(pool.size());
+    for (auto& state : states) {
+        state = std::make_unique<ThreadState>();
+    }
+
+    std::vector<Outcome> outcomes(problems.size());
+    std::size_t nextToWrite = 0;
+    std::size_t failures = 0;
+    std::mutex outputMutex;
+
+    auto solve = [&](std::size_t index, unsigned thread) {
+        const Problem& problem = problems[index];
+        ThreadState& state = *states[thread];
+
+        std::string methodName = problem.method;
+        std::string functionName;
+        std::string errorMessage;
+        double result = 0.0;
+        long long evaluations = 0;
+
+        try {
+            state.input = Input(problem.lowerBound, problem.upperBound, problem.intervals,
+                                problem.functionChoice);
+            // Keep the function (and a parsed expression) while it does not change
+            std::string functionKey = problem.expression.empty() ? std::to_string(problem.functionChoice)
+                                                                 : problem.expression;
+            if (state.functionKey != functionKey) {
+                state.function = problem.expression.empty() ? Function(problem.functionChoice)
+                                                            : Function(problem.expression);
+                state.functionKey = functionKey;
+            }
+            functionName = state.function.getDescription();
+
+            int divisor = cli::requiredDivisor(problem.method);
+            if (divisor == 0) {
+                throw std::invalid_argument("Unknown method '" + problem.method + "'");
+            }
+            if (problem.intervals % divisor != 0) {
+                throw std::invalid_argument("Method requires a number of intervals divisible by "
+                                            + std::to_string(divisor));
+            }
+
+            // Integrators are created once per thread and configuration
+            std::string key = problem.method + "/" + std::to_string(problem.order) + "/"
+                              + std::to_string(problem.tolerance);
+            std::unique_ptr<Integrator>& integrator = state.integrators[key];
+            if (!integrator) {
+                integrator = cli::createIntegrator(problem.method, state.input, state.function,
+                                                   problem.order, problem.tolerance);
+            }
+            integrator->setSummation(problem.summation);
+            result = integrator->integrate(&state.console).value;
+            methodName = integrator->getMethodName();
+            evaluations = integrator->getEvaluationCount();
+        } catch (const std::exception& e) {
+            errorMessage = e.what();
+        }
+
+        std::ostringstream line;
+        line.precision(17);
+        if (json) {
+            line << "{\"index\": " << index << ", \"method\": \"" << cli::jsonEscape(methodName) << "\", "
+                 << "\"function\": \"" << cli::jsonEscape(functionName) << "\", "
+                 << "\"lower\": " << problem.lowerBound << ", \"upper\": " << problem.upperBound << ", "
+                 << "\"intervals\": " << problem.intervals << ", ";
+            if (errorMessage.empty()) {
+                line << "\"result\": " << result << ", \"evaluations\": " << evaluations << "}\n";
+            } else {
+                line << "\"error\": \"" << cli::jsonEscape(errorMessage) << "\"}\n";
+            }
+        } else {
+            line << index << "," << cli::csvField(methodName) << "," << cli::csvField(functionName) << ","
+                 << problem.lowerBound << "," << problem.upperBound << "," << problem.intervals << ",";
+            if (errorMessage.empty()) {
+                line << result << "," << evaluations << ",\n";
+            } else {
+                line << ",," << cli::csvField(errorMessage) << "\n";
+            }
+        }
+
+        // Write every finished result that is next in input order
+        std::lock_guard<std::mutex> lock(outputMutex);
+        outcomes[index].line = line.str();
+        outcomes[index].done = true;
+        if (!errorMessage.empty()) {
+            ++failures;
+        }
+        while (nextToWrite < outcomes.size() && outcomes[nextToWrite].done) {
+            out << outcomes[nextToWrite].line;
+            std::string().swap(outcomes[nextToWrite].line);
+            ++nextToWrite;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelForStealing(problems.size(), solve);
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    out.flush();
+    return failures;
+}
+
+const std::vector<BatchRunner::Problem>& BatchRunner::getProblems() const {
+    return problems;
+}
+
+double BatchRunner::getElapsedSeconds() const {
+    return elapsedSeconds;
+}
+
+bool BatchRunner::parseCsvLine(const std::string& line, const std::vector<std::string>& columns,
+                               Problem& problem) {
+    std::vector<std::string> values = splitOutsideQuotes(line, ',');
+    if (values.size() != columns.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (!setField(columns[i], trimValue(values[i]), problem)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchRunner::parseJsonLine(const std::string& line, Problem& problem) {
+    if (line.size() < 2 || line.front() != '{' || line.back() != '}') {
+        return false;
+    }
+    std::string body = line.substr(1, line.size() - 2);
+    if (trimValue(body).empty()) {
+        return true;
+    }
+
+    for (const auto& member : splitOutsideQuotes(body, ',')) {
+        std::vector<std::string> pair = splitOutsideQuotes(member, ':');
+        if (pair.size() != 2) {
+            return false;
+        }
+        if (!setField(trimValue(pair[0]), trimValue(pair[1]), problem)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BatchRunner::setField(const std::string& key, const std::string& value, Problem& problem) {
+    try {
+        if (key == "function") {
+            problem.functionChoice = cli::parseInt(value);
+        } else if (key == "expr") {
+            problem.expression = value;
+        } else if (key == "lower") {
+            problem.lowerBound = cli::parseDouble(value);
+        } else if (key == "upper") {
+            problem.upperBound = cli::parseDouble(value);
+        } else if (key == "intervals") {
+            problem.intervals = cli::parseInt(value);
+        } else if (key == "method") {
+            problem.method = value;
+        } else if (key == "order") {
+            problem.order = cli::parseInt(value);
+        } else if (key == "tolerance") {
+            problem.tolerance = cli::parseDouble(value);
+        } else if (key == "summation") {
+            return parseSummation(value, problem.summation);
+        } else {
+            return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace numerical
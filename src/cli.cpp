@@ -0,0 +1,1099 @@
+#include "../include/cli.h"
+#include "../include/batch.h"
+#include "../include/console_observer.h"
+#include "../include/cubature.h"
+#include "../include/function.h"
+#include "../include/input.h"
+#include "../include/multi_integrator.h"
+#include "../include/parametric_sweep.h"
+#include "../include/sample_file.h"
+#include "../include/stream_integrator.h"
+#include "../include/stream_reader.h"
+#include "../include/console_utils.h"
+#include "../include/methods/trapezoidal.h"
+#include "../include/methods/simpson13.h"
+#include "../include/methods/simpson38.h"
+#include "../include/methods/boole.h"
+#include "../include/methods/romberg.h"
+#include "../include/methods/adaptive.h"
+#include "../include/methods/gauss_legendre.h"
+#include "../include/methods/incremental.h"
+#include "../include/methods/tanh_sinh.h"
+#include "../include/methods/monte_carlo.h"
+#include "../include/methods/auto_integrator.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace numerical {
+namespace cli {
+
+namespace {
+
+// Convert with parse, which reports the characters it used, and require the
+// whole text to be the number
+template <typename T, typename Parse>
+T parseWhole(const std::string& text, Parse parse) {
+    std::size_t used = 0;
+    T value = parse(text, &used);
+    if (used != text.size()) {
+        throw std::invalid_argument("'" + text + "' is not a number");
+    }
+    return value;
+}
+
+} // namespace
+
+int parseInt(const std::string& text) {
+    return parseWhole<int>(text, [](const std::string& t, std::size_t* used) { return std::stoi(t, used); });
+}
+
+long long parseLongLong(const std::string& text) {
+    return parseWhole<long long>(text, [](const std::string& t, std::size_t* used) { return std::stoll(t, used); });
+}
+
+std::uint64_t parseUnsigned(const std::string& text) {
+    const std::size_t start = text.find_first_not_of(" \t");
+    if (start != std::string::npos && text[start] == '-') {
+        throw std::invalid_argument("'" + text + "' is negative");
+    }
+    return parseWhole<std::uint64_t>(text, [](const std::string& t, std::size_t* used) {
+        return static_cast<std::uint64_t>(std::stoull(t, used));
+    });
+}
+
+double parseDouble(const std::string& text) {
+    return parseWhole<double>(text, [](const std::string& t, std::size_t* used) { return std::stod(t, used); });
+}
+
+bool parseArguments(int argc, char* argv[], Options& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        std::string value;
+        bool hasValue = false;
+
+        // Accept both "--flag value" and "--flag=value"
+        size_t equals = flag.find('=');
+        if (flag.compare(0, 2, "--") == 0 && equals != std::string::npos) {
+            value = flag.substr(equals + 1);
+            flag = flag.substr(0, equals);
+            hasValue = true;
+        }
+
+        auto next = [&](std::string& target) {
+            if (hasValue) {
+                target = value;
+                return true;
+            }
+            if (i + 1 >= argc) {
+                error = "Missing value for " + flag;
+                return false;
+            }
+            target = argv[++i];
+            return true;
+        };
+
+        try {
+            std::string text;
+            if (flag == "--function" || flag == "-f") {
+                if (!next(text)) return false;
+                options.functionChoice = parseInt(text);
+            } else if (flag == "--expr" || flag == "-e") {
+                if (!next(text)) return false;
+                if (options.expression.empty()) {
+                    options.expression = text;
+                } else {
+                    options.moreExpressions.push_back(text);
+                }
+            } else if (flag == "--lower" || flag == "-a") {
+                if (!next(text)) return false;
+                options.lowerBound = parseDouble(text);
+            } else if (flag == "--upper" || flag == "-b") {
+                if (!next(text)) return false;
+                options.upperBound = parseDouble(text);
+            } else if (flag == "--intervals" || flag == "-n") {
+                if (!next(text)) return false;
+                options.intervals = parseInt(text);
+            } else if (flag == "--method" || flag == "-m") {
+                if (!next(options.method)) return false;
+            } else if (flag == "--order") {
+                if (!next(text)) return false;
+                options.order = parseInt(text);
+            } else if (flag == "--tolerance") {
+                if (!next(text)) return false;
+                options.tolerance = parseDouble(text);
+            } else if (flag == "--summation") {
+                if (!next(text)) return false;
+                if (!parseSummation(text, options.summation)) {
+                    error = "Unknown summation '" + text + "' (expected naive, pairwise, vectorized, kahan or neumaier)";
+                    return false;
+                }
+            } else if (flag == "--threads") {
+                if (!next(text)) return false;
+                int threads = parseInt(text);
+                if (threads < 0) {
+                    error = "Thread count must not be negative";
+                    return false;
+                }
+                options.threads = static_cast<unsigned>(threads);
+                options.threadsGiven = true;
+            } else if (flag == "--format") {
+                if (!next(options.format)) return false;
+                if (options.format != "text" && options.format != "csv" && options.format != "json") {
+                    error = "Unknown format '" + options.format + "' (expected text, csv or json)";
+                    return false;
+                }
+            } else if (flag == "--sweep") {
+                if (!next(text)) return false;
+                options.sweepLevels = parseInt(text);
+                if (options.sweepLevels < 1 || options.sweepLevels > 30) {
+                    error = "Sweep levels must be between 1 and 30";
+                    return false;
+                }
+            } else if (flag == "--steps") {
+                options.showSteps = true;
+            } else if (flag == "--save") {
+                if (!next(options.saveFile)) return false;
+            } else if (flag == "--save-samples") {
+                if (!next(options.samplesFile)) return false;
+            } else if (flag == "--replay") {
+                if (!next(options.replayFile)) return false;
+            } else if (flag == "--stream") {
+                if (!next(options.streamFile)) return false;
+            } else if (flag == "--binary") {
+                options.streamBinary = true;
+            } else if (flag == "--pairs") {
+                options.streamPairs = true;
+            } else if (flag == "--step") {
+                if (!next(text)) return false;
+                options.step = parseDouble(text);
+                if (!(options.step > 0.0)) {
+                    error = "The step must be positive";
+                    return false;
+                }
+            } else if (flag == "--grid") {
+                if (!next(options.grid)) return false;
+                if (options.grid != "uniform" && options.grid != "chebyshev" && options.grid != "graded"
+                    && options.grid != "geometric") {
+                    error = "Unknown grid '" + options.grid + "' (expected uniform, chebyshev, graded or geometric)";
+                    return false;
+                }
+            } else if (flag == "--grid-file") {
+                if (!next(options.gridFile)) return false;
+            } else if (flag == "--grading") {
+                if (!next(text)) return false;
+                options.grading = parseDouble(text);
+                options.gradingGiven = true;
+            } else if (flag == "--toward") {
+                if (!next(text)) return false;
+                if (text != "a" && text != "b") {
+                    error = "--toward expects a or b";
+                    return false;
+                }
+                options.towardUpper = text == "b";
+            } else if (flag == "--y") {
+                if (!next(options.yBounds)) return false;
+            } else if (flag == "--z") {
+                if (!next(options.zBounds)) return false;
+            } else if (flag == "--sparse") {
+                if (!next(text)) return false;
+                options.sparseLevel = parseInt(text);
+                if (options.sparseLevel < 0 || options.sparseLevel > Cubature::MAX_LEVEL) {
+                    error = "Sparse-grid levels must be between 0 and " + std::to_string(Cubature::MAX_LEVEL);
+                    return false;
+                }
+            } else if (flag == "--parameters") {
+                if (!next(options.parameters)) return false;
+            } else if (flag == "--sampling") {
+                if (!next(text)) return false;
+                if (!parseSampling(text, options.sampling)) {
+                    error = "Unknown sampling '" + text + "' (expected pseudo, sobol or halton)";
+                    return false;
+                }
+            } else if (flag == "--seed") {
+                if (!next(text)) return false;
+                options.seed = parseUnsigned(text);
+            } else if (flag == "--budget-evals") {
+                if (!next(text)) return false;
+                options.budgetEvaluations = parseLongLong(text);
+            } else if (flag == "--budget-seconds") {
+                if (!next(text)) return false;
+                options.budgetSeconds = parseDouble(text);
+            } else if (flag == "--profile") {
+                if (!next(options.profileFile)) return false;
+            } else if (flag == "--batch") {
+                if (!next(options.batchFile)) return false;
+            } else {
+                error = "Unknown option '" + flag + "'";
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "Invalid value for " + flag;
+            return false;
+        }
+    }
+
+    if (requiredDivisor(options.method) == 0) {
+        error = "Unknown method '" + options.method + "' (expected one of " + methodNames() + ")";
+        return false;
+    }
+    if (options.sweepLevels > 0 && requiredDivisor(options.method) == 1 && options.method != "trapezoidal") {
+        error = "--sweep needs one of trapezoidal, simpson13, simpson38 or boole";
+        return false;
+    }
+    if ((options.grid != "uniform" || !options.gridFile.empty()) && options.method != "trapezoidal"
+        && options.method != "simpson13") {
+        error = "Non-uniform grids need trapezoidal or simpson13";
+        return false;
+    }
+    if (!options.zBounds.empty() && options.yBounds.empty()) {
+        error = "--z needs --y";
+        return false;
+    }
+    if (!options.yBounds.empty() || options.sparseLevel >= 0) {
+        if (options.expression.empty()) {
+            error = "Multiple integrals need an expression (--expr) of x, y and z";
+            return false;
+        }
+        if (requiredDivisor(options.method) == 1 && options.method != "trapezoidal" && options.method != "gauss"
+            && options.method != "montecarlo") {
+            error = "Multiple integrals need one of trapezoidal, simpson13, simpson38, boole, gauss or montecarlo";
+            return false;
+        }
+        if (options.method == "montecarlo" && options.sparseLevel >= 0) {
+            error = "--sparse does not apply to montecarlo";
+            return false;
+        }
+    }
+    if (!options.moreExpressions.empty()) {
+        if (requiredDivisor(options.method) == 1 && options.method != "trapezoidal") {
+            error = "Several expressions need one of trapezoidal, simpson13, simpson38 or boole";
+            return false;
+        }
+        if (!options.yBounds.empty() || options.sweepLevels > 0 || !options.streamFile.empty()
+            || !options.replayFile.empty() || options.grid != "uniform" || !options.gridFile.empty()
+            || !options.saveFile.empty() || !options.samplesFile.empty()) {
+            error = "Several expressions can only be integrated over a uniform grid, without "
+                    "--y, --sweep, --stream, --replay, --grid, --save or --save-samples";
+            return false;
+        }
+    }
+    if (!options.parameters.empty()) {
+        if (options.expression.empty()) {
+            error = "--parameters needs an expression (--expr) of x and p";
+            return false;
+        }
+        if (requiredDivisor(options.method) == 1 && options.method != "trapezoidal" && options.method != "gauss") {
+            error = "--parameters needs one of trapezoidal, simpson13, simpson38, boole or gauss";
+            return false;
+        }
+        if (!options.yBounds.empty() || options.sparseLevel >= 0 || options.sweepLevels > 0
+            || !options.streamFile.empty() || !options.moreExpressions.empty()) {
+            error = "--parameters cannot be combined with --y, --sparse, --sweep, --stream or several expressions";
+            return false;
+        }
+    }
+    if ((options.budgetEvaluations != 0 || options.budgetSeconds != 0.0 || !options.profileFile.empty())
+        && options.method != "auto") {
+        error = "--budget-evals, --budget-seconds and --profile need -m auto";
+        return false;
+    }
+    if (options.budgetEvaluations < 0 || options.budgetSeconds < 0.0) {
+        error = "Budgets must not be negative";
+        return false;
+    }
+    if (!options.streamFile.empty()) {
+        if (requiredDivisor(options.method) == 1 && options.method != "trapezoidal") {
+            error = "--stream needs one of trapezoidal, simpson13, simpson38 or boole";
+            return false;
+        }
+        if (options.streamPairs && requiredDivisor(options.method) > 2) {
+            error = "(x, y) pairs need trapezoidal or simpson13; the other rules need equally spaced samples";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string methodNames() {
+    return "trapezoidal, simpson13, simpson38, boole, romberg, adaptive, gauss, tanhsinh, montecarlo, auto";
+}
+
+int requiredDivisor(const std::string& method) {
+    if (method == "trapezoidal" || method == "romberg" || method == "adaptive"
+        || method == "gauss" || method == "tanhsinh" || method == "montecarlo" || method == "auto") {
+        return 1;
+    }
+    if (method == "simpson13") {
+        return 2;
+    }
+    if (method == "simpson38") {
+        return 3;
+    }
+    if (method == "boole") {
+        return 4;
+    }
+    return 0; // Unknown method
+}
+
+std::unique_ptr<Integrator> createIntegrator(const std::string& method, const Input& input,
+                                             const Function& function, int order, double tolerance) {
+    if (method == "trapezoidal") {
+        return std::make_unique<TrapezoidalRule>(input, function);
+    }
+    if (method == "simpson13") {
+        return std::make_unique<SimpsonOneThird>(input, function);
+    }
+    if (method == "simpson38") {
+        return std::make_unique<SimpsonThreeEighth>(input, function);
+    }
+    if (method == "boole") {
+        return std::make_unique<BooleRule>(input, function);
+    }
+    if (method == "romberg") {
+        return std::make_unique<RombergIntegration>(input, function, order, tolerance);
+    }
+    if (method == "adaptive") {
+        return std::make_unique<AdaptiveQuadrature>(input, function, tolerance, tolerance);
+    }
+    if (method == "gauss") {
+        return std::make_unique<GaussLegendre>(input, function, order);
+    }
+    if (method == "tanhsinh") {
+        return std::make_unique<TanhSinh>(input, function, tolerance);
+    }
+    if (method == "montecarlo") {
+        return std::make_unique<MonteCarlo>(input, function);
+    }
+    if (method == "auto") {
+        return std::make_unique<AutoIntegrator>(input, function, tolerance);
+    }
+    return nullptr;
+}
+
+std::string jsonEscape(const std::string& text) {
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string escaped;
+    for (char c : text) {
+        const unsigned char code = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (c == '\t') {
+            escaped += "\\t";
+        } else if (c == '\r') {
+            escaped += "\\r";
+        } else if (code < 0x20) {
+            // Other control characters may not appear in a JSON string at all
+            escaped += "\\u00";
+            escaped += hexDigits[code >> 4];
+            escaped += hexDigits[code & 0xf];
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"") == std::string::npos) {
+        return text;
+    }
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void printUsage(const std::string& program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "Without options the interactive menu is started.\n\n"
+              << "Options:\n"
+              << "  -f, --function N      Predefined function (1-" << Function::getAvailableFunctions().size() << ", default 1)\n"
+              << "  -e, --expr EXPR       Integrate an expression of x instead, e.g. \"exp(-x^2)*cos(3*x)\";\n"
+              << "                        repeat to integrate several expressions in one pass\n"
+              << "  -a, --lower A         Lower bound of integration (default 0)\n"
+              << "  -b, --upper B         Upper bound of integration (default 1)\n"
+              << "  -n, --intervals N     Number of intervals (default 100)\n"
+              << "  -m, --method M        " << methodNames() << " (default simpson13)\n"
+              << "      --order K         Romberg order, 1-" << RombergIntegration::MAX_ORDER
+              << ", or Gauss-Legendre points per panel, 1-" << GaussLegendre::MAX_POINTS << " (default 4)\n"
+              << "      --tolerance T     Romberg/adaptive/tanh-sinh/auto error tolerance (default 1e-10; 0 disables\n"
+              << "                        for Romberg and tanh-sinh)\n"
+              << "      --summation S     naive, pairwise, vectorized, kahan or neumaier (default naive)\n"
+              << "      --threads T       Threads for grid sums, 0 = all cores (default 1; batch default 0)\n"
+              << "      --format F        Output format: text, csv or json (default text)\n"
+              << "      --sweep L         Convergence sweep over n, 2n, ..., 2^(L-1)n intervals, evaluating\n"
+              << "                        only the new points at each level (Newton-Cotes methods)\n"
+              << "      --steps           Print the intermediate steps\n"
+              << "      --save FILE       Save the result and samples to FILE\n"
+              << "      --save-samples FILE  Save the grid values to FILE in binary form\n"
+              << "      --replay FILE     Integrate the values stored by --save-samples instead of\n"
+              << "                        evaluating the function (function, bounds and n come from FILE)\n"
+              << "      --grid G          uniform, chebyshev, graded or geometric (trapezoidal and simpson13)\n"
+              << "      --grading G       Exponent of a graded grid (default 4) or ratio of a geometric one\n"
+              << "                        (default 1 + 8/n)\n"
+              << "      --toward E        Endpoint a graded or geometric grid is refined toward: a or b (default a)\n"
+              << "      --grid-file FILE  Integrate over the increasing points listed in FILE, one per line\n"
+              << "      --y LO:HI         Integrate over y too, from LO to HI (expressions of x)\n"
+              << "      --z LO:HI         Integrate over z too, from LO to HI (expressions of x and y)\n"
+              << "      --sparse L        Use a sparse (Smolyak) grid of level L, 0-" << Cubature::MAX_LEVEL
+              << ", instead of\n"
+              << "                        the tensor product with -n intervals per dimension\n"
+              << "      --parameters P0:P1:N  Integrate an expression of x and p for N values of p from P0 to P1\n"
+              << "      --sampling S      Monte Carlo points: pseudo, sobol or halton (default sobol)\n"
+              << "      --seed S          Seed of the Monte Carlo points (default 0)\n"
+              << "      --budget-evals N  Largest number of evaluations auto may choose (default no limit)\n"
+              << "      --budget-seconds S  Largest predicted time auto may choose (default no limit)\n"
+              << "      --profile FILE    Reuse and store the decisions of auto in FILE\n"
+              << "      --batch FILE      Integrate every problem in a CSV or JSONL file\n"
+              << "      --stream FILE     Integrate tabulated samples from FILE (- for stdin) in constant memory;\n"
+              << "                        one value per line, spaced evenly from -a to -b or by --step\n"
+              << "      --pairs           Stream samples are x, y pairs (trapezoidal or simpson13)\n"
+              << "      --binary          Stream samples are native doubles instead of text\n"
+              << "      --step H          Spacing of streamed values, starting at -a\n"
+              << "  -h, --help            Show this help\n"
+              << "      --list-functions  List the predefined functions\n\n"
+              << "Exit status: 0 success, 1 invalid arguments, 2 method not applicable, 3 save/load failed,\n"
+              << "             4 some batch problems failed\n";
+}
+
+int runBatch(const Options& options) {
+    BatchRunner runner;
+    std::string error;
+    if (!runner.loadFromFile(options.batchFile, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return EXIT_IO_ERROR;
+    }
+
+    // Problems are independent, so a batch uses every core unless told otherwise
+    unsigned threads = options.threadsGiven ? options.threads : 0;
+    std::string format = options.format == "json" ? "json" : "csv";
+    std::size_t failures = runner.run(std::cout, format, threads);
+
+    double seconds = runner.getElapsedSeconds();
+    std::size_t count = runner.getProblems().size();
+    std::cerr << count << " problems in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cerr << " (" << count / seconds << " integrals/s)";
+    }
+    std::cerr << "\n";
+    if (failures > 0) {
+        std::cerr << failures << " problems failed\n";
+        return EXIT_BATCH_FAILED;
+    }
+    return EXIT_OK;
+}
+
+int runSweep(const Options& options, const Input& input, const Function& function) {
+    IncrementalIntegrator integrator(input, function, requiredDivisor(options.method));
+    integrator.setThreadCount(options.threads);
+    integrator.setSummation(options.summation);
+
+    std::cout << std::setprecision(17);
+    if (options.format == "csv") {
+        std::cout << "method,function,lower,upper,intervals,result,change,evaluations,seconds\n";
+    } else if (options.format == "text") {
+        std::cout << "Method: " << integrator.getMethodName() << "\n"
+                  << "Function: " << function.getDescription() << "\n"
+                  << "Bounds: [" << options.lowerBound << ", " << options.upperBound << "]\n\n"
+                  << std::setw(12) << "Intervals" << std::setw(26) << "Result"
+                  << std::setw(14) << "Change" << std::setw(14) << "Evaluations" << "\n";
+    }
+
+    ConsoleObserver console(options.showSteps);
+    double previous = 0.0;
+    long long total = 0;
+    for (int level = 0; level < options.sweepLevels; ++level) {
+        if (level > 0) {
+            integrator.refine(2);
+        }
+        IntegrationResult outcome = integrator.integrate(&console);
+        double change = level > 0 ? outcome.value - previous : 0.0;
+        previous = outcome.value;
+        total += outcome.evaluations;
+
+        if (options.format == "json") {
+            std::cout << "{\"method\": \"" << jsonEscape(integrator.getMethodName()) << "\", "
+                      << "\"function\": \"" << jsonEscape(function.getDescription()) << "\", "
+                      << "\"lower\": " << options.lowerBound << ", "
+                      << "\"upper\": " << options.upperBound << ", "
+                      << "\"intervals\": " << integrator.getIntervals() << ", "
+                      << "\"result\": " << outcome.value << ", "
+                      << "\"change\": " << change << ", "
+                      << "\"evaluations\": " << outcome.evaluations << ", "
+                      << "\"seconds\": " << outcome.seconds << "}\n";
+        } else if (options.format == "csv") {
+            std::cout << csvField(integrator.getMethodName()) << ","
+                      << csvField(function.getDescription()) << ","
+                      << options.lowerBound << "," << options.upperBound << ","
+                      << integrator.getIntervals() << "," << outcome.value << ","
+                      << change << "," << outcome.evaluations << "," << outcome.seconds << "\n";
+        } else {
+            std::cout << std::setw(12) << integrator.getIntervals()
+                      << std::setw(26) << std::setprecision(17) << outcome.value
+                      << std::setw(14) << std::setprecision(3);
+            if (level > 0) {
+                std::cout << change;
+            } else {
+                std::cout << "-";
+            }
+            std::cout << std::setw(14) << outcome.evaluations << "\n";
+        }
+    }
+
+    if (options.format == "text") {
+        std::cout << "\nTotal evaluations: " << total << "\n";
+    }
+    return EXIT_OK;
+}
+
+std::unique_ptr<Grid> createGrid(const Options& options) {
+    if (!options.gridFile.empty()) {
+        std::ifstream file(options.gridFile);
+        if (!file.is_open()) {
+            throw std::runtime_error("could not open " + options.gridFile);
+        }
+        StreamReader reader(file, false, false);
+        std::vector<double> points;
+        std::vector<double> chunk(4096);
+        std::string error;
+        std::size_t count;
+        while ((count = reader.read(nullptr, chunk.data(), chunk.size(), error)) > 0) {
+            points.insert(points.end(), chunk.begin(), chunk.begin() + count);
+        }
+        if (!error.empty()) {
+            throw std::runtime_error(options.gridFile + ": " + error);
+        }
+        return std::unique_ptr<Grid>(new Grid(std::move(points), "from " + options.gridFile));
+    }
+
+    const double a = options.lowerBound;
+    const double b = options.upperBound;
+    const int n = options.intervals;
+    Grid::Endpoint toward = options.towardUpper ? Grid::Endpoint::Upper : Grid::Endpoint::Lower;
+    if (options.grid == "chebyshev") {
+        return std::unique_ptr<Grid>(new Grid(Grid::chebyshev(a, b, n)));
+    }
+    if (options.grid == "graded") {
+        double exponent = options.gradingGiven ? options.grading : 4.0;
+        return std::unique_ptr<Grid>(new Grid(Grid::graded(a, b, n, exponent, toward)));
+    }
+    if (options.grid == "geometric") {
+        double ratio = options.gradingGiven ? options.grading : 1.0 + 8.0 / n;
+        return std::unique_ptr<Grid>(new Grid(Grid::geometric(a, b, n, ratio, toward)));
+    }
+    return nullptr;
+}
+
+int runStream(const Options& options) {
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    if (options.streamFile != "-") {
+        file.open(options.streamFile, options.streamBinary ? std::ios::binary : std::ios::in);
+        if (!file.is_open()) {
+            std::cerr << "Error: could not open " << options.streamFile << "\n";
+            return EXIT_IO_ERROR;
+        }
+        in = &file;
+    } else {
+        std::ios::sync_with_stdio(false);
+    }
+
+    StreamIntegrator integrator(requiredDivisor(options.method), options.summation);
+    if (options.step > 0.0) {
+        integrator.setStep(options.lowerBound, options.step);
+    } else {
+        integrator.setBounds(options.lowerBound, options.upperBound);
+    }
+
+    // Only one chunk of samples is held in memory at a time
+    constexpr std::size_t CHUNK_SAMPLES = std::size_t(1) << 16;
+    std::vector<double> x(options.streamPairs ? CHUNK_SAMPLES : 0);
+    std::vector<double> y(CHUNK_SAMPLES);
+    StreamReader reader(*in, options.streamBinary, options.streamPairs);
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        std::size_t count;
+        while ((count = reader.read(x.data(), y.data(), CHUNK_SAMPLES, error)) > 0) {
+            if (options.streamPairs) {
+                integrator.addPoints(x.data(), y.data(), count);
+            } else {
+                integrator.addValues(y.data(), count);
+            }
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    if (error.empty() && !integrator.finish(error)) {
+        std::cerr << "Error: " << error << "\n";
+        return EXIT_NOT_APPLICABLE;
+    }
+    std::string name = options.streamFile == "-" ? "stdin" : options.streamFile;
+    if (!error.empty()) {
+        std::cerr << "Error: " << name << ": " << error << "\n";
+        return EXIT_IO_ERROR;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::string source = "data from " + name;
+    long long intervals = integrator.getSampleCount() - 1;
+    std::cout << std::setprecision(17);
+    if (options.format == "json") {
+        std::cout << "{\"method\": \"" << jsonEscape(integrator.getMethodName()) << "\", "
+                  << "\"function\": \"" << jsonEscape(source) << "\", "
+                  << "\"lower\": " << integrator.getLowerBound() << ", "
+                  << "\"upper\": " << integrator.getUpperBound() << ", "
+                  << "\"intervals\": " << intervals << ", "
+                  << "\"result\": " << integrator.getResult() << ", "
+                  << "\"evaluations\": " << integrator.getSampleCount() << ", "
+                  << "\"seconds\": " << seconds << "}\n";
+    } else if (options.format == "csv") {
+        std::cout << "method,function,lower,upper,intervals,result,evaluations,seconds\n"
+                  << csvField(integrator.getMethodName()) << "," << csvField(source) << ","
+                  << integrator.getLowerBound() << "," << integrator.getUpperBound() << ","
+                  << intervals << "," << integrator.getResult() << ","
+                  << integrator.getSampleCount() << "," << seconds << "\n";
+    } else {
+        std::cout << "Method: " << integrator.getMethodName() << "\n"
+                  << "Function: " << source << "\n"
+                  << "Bounds: [" << integrator.getLowerBound() << ", " << integrator.getUpperBound() << "]\n"
+                  << "Intervals: " << intervals << "\n"
+                  << "Result: " << integrator.getResult() << "\n"
+                  << "Samples: " << integrator.getSampleCount() << "\n"
+                  << "Time: " << seconds << " s\n";
+    }
+
+    std::cerr << std::setprecision(4) << integrator.getSampleCount() << " samples, "
+              << reader.getBytesRead() / 1e6 << " MB in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cerr << " (" << reader.getBytesRead() / 1e6 / seconds << " MB/s)";
+    }
+    std::cerr << "\n";
+    return EXIT_OK;
+}
+
+int runCubature(const Options& options) {
+    // Bounds are "LOWER:UPPER"; the bounds of x are the plain numbers, written
+    // with enough digits to parse back to the same doubles
+    auto exact = [](double value) {
+        std::ostringstream text;
+        text << std::setprecision(17) << value;
+        return text.str();
+    };
+    std::vector<std::string> lower = {exact(options.lowerBound)};
+    std::vector<std::string> upper = {exact(options.upperBound)};
+    for (const std::string* bounds : {&options.yBounds, &options.zBounds}) {
+        if (bounds->empty()) {
+            continue;
+        }
+        size_t colon = bounds->find(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Error: bounds '" << *bounds << "' must have the form LOWER:UPPER\n";
+            return EXIT_USAGE;
+        }
+        lower.push_back(bounds->substr(0, colon));
+        upper.push_back(bounds->substr(colon + 1));
+    }
+
+    bool sparse = options.sparseLevel >= 0;
+    int divisor = requiredDivisor(options.method);
+    if (!sparse && options.intervals % divisor != 0) {
+        std::cerr << "Error: method '" << options.method << "' requires a number of intervals divisible by "
+                  << divisor << "\n";
+        return EXIT_NOT_APPLICABLE;
+    }
+
+    try {
+        Region region(lower, upper);
+        Expression integrand(options.expression, region.getVariables());
+        Cubature::Construction construction = sparse ? Cubature::Construction::Smolyak
+                                             : options.method == "montecarlo" ? Cubature::Construction::MonteCarlo
+                                                                              : Cubature::Construction::TensorProduct;
+        Cubature cubature(region, integrand, options.method, sparse ? options.sparseLevel : options.intervals,
+                          construction);
+        if (options.method == "gauss" && !sparse) {
+            cubature.setGaussPoints(options.order);
+        }
+        cubature.setSampling(options.sampling, options.seed);
+        cubature.setThreadCount(options.threads);
+        cubature.setSummation(options.summation);
+
+        ConsoleObserver console(options.showSteps);
+        IntegrationResult outcome = cubature.integrate(&console);
+
+        std::cout << std::setprecision(17);
+        if (options.format == "json") {
+            std::cout << "{\"method\": \"" << jsonEscape(cubature.getMethodName()) << "\", "
+                      << "\"function\": \"" << jsonEscape(options.expression) << "\", "
+                      << "\"region\": \"" << jsonEscape(region.getDescription()) << "\", "
+                      << "\"result\": " << outcome.value << ", "
+                      << "\"error_estimate\": ";
+            if (std::isnan(outcome.errorEstimate)) {
+                std::cout << "null";
+            } else {
+                std::cout << outcome.errorEstimate;
+            }
+            std::cout << ", \"evaluations\": " << outcome.evaluations << ", "
+                      << "\"seconds\": " << outcome.seconds << "}\n";
+        } else if (options.format == "csv") {
+            std::cout << "method,function,region,result,error_estimate,evaluations,seconds\n"
+                      << csvField(cubature.getMethodName()) << "," << csvField(options.expression) << ","
+                      << csvField(region.getDescription()) << "," << outcome.value << ",";
+            if (!std::isnan(outcome.errorEstimate)) {
+                std::cout << outcome.errorEstimate;
+            }
+            std::cout << "," << outcome.evaluations << "," << outcome.seconds << "\n";
+        } else {
+            std::cout << "Method: " << cubature.getMethodName() << "\n"
+                      << "Function: f(" << (region.getDimension() == 2 ? "x, y" : "x, y, z") << ") = "
+                      << options.expression << "\n"
+                      << "Region: " << region.getDescription() << "\n"
+                      << "Result: " << outcome.value << "\n";
+            if (!std::isnan(outcome.errorEstimate)) {
+                std::cout << "Error estimate: " << std::setprecision(3) << outcome.errorEstimate
+                          << std::setprecision(17) << "\n";
+            }
+            std::cout << "Evaluations: " << outcome.evaluations << "\n"
+                      << "Time: " << outcome.seconds << " s\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_USAGE;
+    }
+    return EXIT_OK;
+}
+
+int runMulti(const Options& options) {
+    int divisor = requiredDivisor(options.method);
+    if (options.intervals % divisor != 0) {
+        std::cerr << "Error: method '" << options.method << "' requires a number of intervals divisible by "
+                  << divisor << "\n";
+        return EXIT_NOT_APPLICABLE;
+    }
+
+    try {
+        std::vector<Function> functions;
+        functions.emplace_back(options.expression);
+        for (const std::string& expression : options.moreExpressions) {
+            functions.emplace_back(expression);
+        }
+        Input input(options.lowerBound, options.upperBound, options.intervals, options.functionChoice);
+        MultiIntegrator integrator(input, functions, divisor);
+        integrator.setThreadCount(options.threads);
+        integrator.setSummation(options.summation);
+
+        ConsoleObserver console(options.showSteps);
+        std::vector<IntegrationResult> outcomes = integrator.integrate(&console);
+
+        std::cout << std::setprecision(17);
+        if (options.format == "csv") {
+            std::cout << "method,function,lower,upper,intervals,result,evaluations,seconds\n";
+        } else if (options.format == "text") {
+            std::cout << "Method: " << integrator.getMethodName() << "\n"
+                      << "Bounds: [" << options.lowerBound << ", " << options.upperBound << "]\n"
+                      << "Intervals: " << options.intervals << "\n\n";
+        }
+        for (std::size_t j = 0; j < functions.size(); ++j) {
+            const IntegrationResult& outcome = outcomes[j];
+            const std::string description = functions[j].getDescription();
+            if (options.format == "json") {
+                std::cout << "{\"method\": \"" << jsonEscape(integrator.getMethodName()) << "\", "
+                          << "\"function\": \"" << jsonEscape(description) << "\", "
+                          << "\"lower\": " << options.lowerBound << ", "
+                          << "\"upper\": " << options.upperBound << ", "
+                          << "\"intervals\": " << options.intervals << ", "
+                          << "\"result\": " << outcome.value << ", "
+                          << "\"evaluations\": " << outcome.evaluations << ", "
+                          << "\"seconds\": " << outcome.seconds << "}\n";
+            } else if (options.format == "csv") {
+                std::cout << csvField(integrator.getMethodName()) << "," << csvField(description) << ","
+                          << options.lowerBound << "," << options.upperBound << "," << options.intervals << ","
+                          << outcome.value << "," << outcome.evaluations << "," << outcome.seconds << "\n";
+            } else {
+                std::cout << description << "\n    Result: " << outcome.value << "\n";
+            }
+        }
+        if (options.format == "text") {
+            std::cout << "\nEvaluations: " << functions.size() << " x " << outcomes[0].evaluations << "\n"
+                      << "Time: " << outcomes[0].seconds << " s (one pass for all functions)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_USAGE;
+    }
+    return EXIT_OK;
+}
+
+int runParametric(const Options& options) {
+    // FIRST:LAST:COUNT
+    std::vector<double> parameters;
+    try {
+        size_t first = options.parameters.find(':');
+        size_t second = first == std::string::npos ? first : options.parameters.find(':', first + 1);
+        if (second == std::string::npos) {
+            throw std::invalid_argument("format");
+        }
+        double from = parseDouble(options.parameters.substr(0, first));
+        double to = parseDouble(options.parameters.substr(first + 1, second - first - 1));
+        long long count = parseLongLong(options.parameters.substr(second + 1));
+        if (count < 1) {
+            throw std::invalid_argument("count");
+        }
+        parameters.resize(count);
+        for (long long i = 0; i < count; ++i) {
+            parameters[i] = count == 1 ? from : from + (to - from) * static_cast<double>(i) / (count - 1);
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: parameters '" << options.parameters
+                  << "' must have the form FIRST:LAST:COUNT with a positive count\n";
+        return EXIT_USAGE;
+    }
+
+    int divisor = requiredDivisor(options.method);
+    if (options.intervals % divisor != 0) {
+        std::cerr << "Error: method '" << options.method << "' requires a number of intervals divisible by "
+                  << divisor << "\n";
+        return EXIT_NOT_APPLICABLE;
+    }
+
+    try {
+        Expression integrand(options.expression, {"x", "p"});
+        ParametricSweep sweep(integrand, options.lowerBound, options.upperBound, options.method, options.intervals);
+        if (options.method == "gauss") {
+            sweep.setGaussPoints(options.order);
+        }
+        sweep.setThreadCount(options.threads);
+        sweep.setSummation(options.summation);
+
+        ConsoleObserver console(options.showSteps);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<double> results = sweep.integrate(parameters, &console);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setprecision(17);
+        if (options.format == "json") {
+            for (size_t i = 0; i < parameters.size(); ++i) {
+                std::cout << "{\"p\": " << parameters[i] << ", \"result\": " << results[i] << "}\n";
+            }
+        } else if (options.format == "csv") {
+            std::cout << "p,result\n";
+            for (size_t i = 0; i < parameters.size(); ++i) {
+                std::cout << parameters[i] << "," << results[i] << "\n";
+            }
+        } else {
+            std::cout << "Method: " << sweep.getMethodName() << "\n"
+                      << "Function: f(x; p) = " << options.expression << "\n"
+                      << "Bounds: [" << options.lowerBound << ", " << options.upperBound << "]\n\n"
+                      << std::setw(26) << "p" << std::setw(26) << "Result" << "\n";
+            for (size_t i = 0; i < parameters.size(); ++i) {
+                std::cout << std::setw(26) << parameters[i] << std::setw(26) << results[i] << "\n";
+            }
+            std::cout << "\nEvaluations: " << sweep.getEvaluationCount() << "\n"
+                      << "Time: " << seconds << " s\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_USAGE;
+    }
+    return EXIT_OK;
+}
+
+int run(int argc, char* argv[]) {
+    std::string program = argc > 0 ? argv[0] : "NumericalIntegration";
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            printUsage(program);
+            return EXIT_OK;
+        }
+        if (flag == "--list-functions") {
+            std::vector<std::string> functions = Function::getAvailableFunctions();
+            for (size_t f = 0; f < functions.size(); ++f) {
+                std::cout << (f + 1) << ". " << functions[f] << "\n";
+            }
+            return EXIT_OK;
+        }
+    }
+
+    // Nobody is watching the steps scroll by, so never pause
+    utils::setSleepEnabled(false);
+    
+    Options options;
+    std::string error;
+    if (!parseArguments(argc, argv, options, error)) {
+        std::cerr << "Error: " << error << "\n";
+        std::cerr << "Run '" << program << " --help' for usage.\n";
+        return EXIT_USAGE;
+    }
+
+    if (!options.batchFile.empty()) {
+        return runBatch(options);
+    }
+    if (!options.streamFile.empty()) {
+        return runStream(options);
+    }
+    if (!options.yBounds.empty() || options.sparseLevel >= 0) {
+        return runCubature(options);
+    }
+    if (!options.moreExpressions.empty()) {
+        return runMulti(options);
+    }
+    if (!options.parameters.empty()) {
+        return runParametric(options);
+    }
+
+    // A replay takes the problem from the sample file and reads its values
+    SampleFile samples;
+    if (!options.replayFile.empty()) {
+        if (!samples.open(options.replayFile, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return EXIT_IO_ERROR;
+        }
+        const SampleFile::Header& header = samples.getHeader();
+        if (header.intervals > std::numeric_limits<int>::max()) {
+            std::cerr << "Error: " << options.replayFile << " has too many intervals\n";
+            return EXIT_IO_ERROR;
+        }
+        options.functionChoice = header.expression.empty() ? header.functionChoice : 1;
+        options.expression = header.expression;
+        options.lowerBound = header.lowerBound;
+        options.upperBound = header.upperBound;
+        options.intervals = static_cast<int>(header.intervals);
+    }
+
+    try {
+        // A grid file decides the bounds and the number of intervals
+        std::unique_ptr<Grid> grid = createGrid(options);
+        if (grid && !options.gridFile.empty()) {
+            if (grid->getIntervals() > std::numeric_limits<int>::max()) {
+                throw std::invalid_argument(options.gridFile + " has too many points");
+            }
+            options.lowerBound = grid->getLowerBound();
+            options.upperBound = grid->getUpperBound();
+            options.intervals = static_cast<int>(grid->getIntervals());
+        }
+
+        Input input(options.lowerBound, options.upperBound, options.intervals, options.functionChoice);
+        Function function = options.expression.empty() ? Function(options.functionChoice)
+                                                       : Function(options.expression);
+
+        int divisor = requiredDivisor(options.method);
+        if (options.intervals % divisor != 0) {
+            std::cerr << "Error: method '" << options.method << "' requires a number of intervals divisible by "
+                      << divisor << "\n";
+            return EXIT_NOT_APPLICABLE;
+        }
+
+        if (options.sweepLevels > 0) {
+            return runSweep(options, input, function);
+        }
+
+        std::unique_ptr<Integrator> integrator;
+        MethodProfile profile;
+        AutoIntegrator* automatic = nullptr;
+        if (options.method == "montecarlo") {
+            integrator = std::make_unique<MonteCarlo>(input, function, options.sampling, options.seed);
+        } else if (options.method == "auto") {
+            if (!options.profileFile.empty() && !profile.load(options.profileFile, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return EXIT_IO_ERROR;
+            }
+            auto chooser = std::make_unique<AutoIntegrator>(input, function, options.tolerance);
+            chooser->setBudget(options.budgetEvaluations, options.budgetSeconds);
+            chooser->setProfile(options.profileFile.empty() ? nullptr : &profile);
+            automatic = chooser.get();
+            integrator = std::move(chooser);
+        } else {
+            integrator = createIntegrator(options.method, input, function, options.order, options.tolerance);
+        }
+        integrator->setThreadCount(options.threads);
+        integrator->setSummation(options.summation);
+        integrator->setGrid(grid.get());
+        SampleCache replayCache;
+        if (samples.isOpen()) {
+            replayCache.attach(function, options.lowerBound, options.upperBound, options.intervals,
+                               samples.getValues());
+            integrator->setSampleCache(&replayCache);
+        }
+
+        ConsoleObserver console(options.showSteps);
+        IntegrationResult outcome = integrator->integrate(&console);
+        double result = outcome.value;
+        double seconds = outcome.seconds;
+
+        std::cout << std::setprecision(17);
+        if (options.format == "json") {
+            std::cout << "{\"method\": \"" << jsonEscape(integrator->getMethodName()) << "\", "
+                      << "\"function\": \"" << jsonEscape(function.getDescription()) << "\", "
+                      << "\"lower\": " << options.lowerBound << ", "
+                      << "\"upper\": " << options.upperBound << ", "
+                      << "\"intervals\": " << options.intervals << ", "
+                      << "\"result\": " << result << ", "
+                      << "\"evaluations\": " << integrator->getEvaluationCount() << ", "
+                      << "\"seconds\": " << seconds << "}\n";
+        } else if (options.format == "csv") {
+            std::cout << "method,function,lower,upper,intervals,result,evaluations,seconds\n"
+                      << csvField(integrator->getMethodName()) << ","
+                      << csvField(function.getDescription()) << ","
+                      << options.lowerBound << "," << options.upperBound << ","
+                      << options.intervals << "," << result << ","
+                      << integrator->getEvaluationCount() << "," << seconds << "\n";
+        } else {
+            std::cout << "Method: " << integrator->getMethodName() << "\n"
+                      << "Function: " << function.getDescription() << "\n"
+                      << "Bounds: [" << options.lowerBound << ", " << options.upperBound << "]\n"
+                      << "Intervals: " << options.intervals << "\n";
+            if (grid) {
+                std::cout << "Grid: " << grid->getDescription() << "\n";
+            }
+            if (automatic) {
+                std::cout << "Choice: " << automatic->getDecision().reason
+                          << (automatic->usedProfile() ? " (from the profile)" : "") << "\n";
+            }
+            std::cout << "Result: " << result << "\n";
+            if (!std::isnan(outcome.errorEstimate)) {
+                std::cout << "Error estimate: " << std::setprecision(3) << outcome.errorEstimate
+                          << std::setprecision(17) << "\n";
+            }
+            std::cout << "Evaluations: " << integrator->getEvaluationCount() << "\n"
+                      << "Time: " << seconds << " s\n";
+            if (samples.isOpen()) {
+                std::cout << "Samples: " << options.replayFile << " (stored by " << samples.getHeader().method << ")\n";
+            }
+        }
+
+        if (!options.saveFile.empty() && !integrator->saveResultToFile(options.saveFile)) {
+            std::cerr << "Error: could not save result to " << options.saveFile << "\n";
+            return EXIT_IO_ERROR;
+        }
+        if (!options.samplesFile.empty() && !integrator->saveSamplesToFile(options.samplesFile, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return EXIT_IO_ERROR;
+        }
+        if (!options.profileFile.empty() && !profile.save(options.profileFile, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return EXIT_IO_ERROR;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_USAGE;
+    }
+
+    return EXIT_OK;
+}
+
+} // namespace cli
+} // namespace numerical
@@ -0,0 +1,66 @@
+#include "../include/input.h"
+#include "../include/function.h"
+#include <iostream>
+#include <limits>
+
+namespace numerical {
+
+Input::Input() {
+    // Display available functions and get user choice
+    std::vector<std::string> functions = Function::getAvailableFunctions();
+    std::cout << "Available functions:" << std::endl;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        std::cout << (i + 1) << ". " << functions[i] << std::endl;
+    }
+    
+    std::cout << "Select function number: ";
+    std::cin >> funcChoice;
+    
+    // Validate function choice
+    while (std::cin.fail() || funcChoice < 1 || funcChoice > static_cast<int>(functions.size())) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid choice. Please enter a number between 1 and " 
+                  << functions.size() << ": ";
+        std::cin >> funcChoice;
+    }
+    
+    // Get integration bounds
+    std::cout << "Enter lower bound a: ";
+    std::cin >> a;
+    while (std::cin.fail()) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid input. Please enter a number: ";
+        std::cin >> a;
+    }
+    
+    std::cout << "Enter upper bound b: ";
+    std::cin >> b;
+    while (std::cin.fail() || b <= a) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid input. Please enter a number greater than " << a << ": ";
+        std::cin >> b;
+    }
+    
+    // Get number of intervals
+    std::cout << "Enter number of intervals n: ";
+    std::cin >> n;
+    while (std::cin.fail() || n < 1) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid input. Please enter a positive integer: ";
+        std::cin >> n;
+    }
+}
+
+void Input::display() const {
+    std::cout << "Integration parameters:" << std::endl;
+    std::cout << "Function: " << Function(funcChoice).getDescription() << std::endl;
+    std::cout << "Lower bound (a): " << a << std::endl;
+    std::cout << "Upper bound (b): " << b << std::endl;
+    std::cout << "Number of intervals (n): " << n << std::endl;
+}
+
+} // namespace numerical
@@ -0,0 +1,55 @@
+#include "../include/console_observer.h"
+#include "../include/console_utils.h"
+#include "../include/utils.h"
+#include <iostream>
+#include <iomanip>
+
+namespace numerical {
+
+ConsoleObserver::ConsoleObserver(bool showSteps) : showSteps(showSteps) {
+}
+
+bool ConsoleObserver::wantsSteps() const {
+    return showSteps;
+}
+
+void ConsoleObserver::onStep(const std::string& text) {
+    std::cout << text << std::endl;
+}
+
+void ConsoleObserver::onSamples(const std::vector<double>& x, const std::vector<double>& y, double h) {
+    std::cout << "\nStep size h = " << h << std::endl;
+    std::cout << std::setw(5) << "i" << std::setw(15) << "x_i" 
+              << std::setw(15) << "f(x_i)" << std::endl;
+    std::cout << std::string(35, '-') << std::endl;
+    
+    for (size_t i = 0; i < x.size(); ++i) {
+        std::cout << std::setw(5) << i 
+                  << std::setw(15) << utils::formatNumber(x[i], 6)
+                  << std::setw(15) << utils::formatNumber(y[i], 6) 
+                  << std::endl;
+        
+        // Add a small delay for better visualization
+        if (i % 5 == 4) {
+            utils::sleep(100);
+        }
+    }
+    std::cout << std::endl;
+}
+
+void ConsoleObserver::onPause(int milliseconds) {
+    utils::sleep(milliseconds);
+}
+
+void ConsoleObserver::onNotApplicable(const std::string& reason) {
+    if (showSteps) {
+        std::cerr << "\nError: " << reason << std::endl;
+    }
+}
+
+void ConsoleObserver::onUndefinedValue(double x, const std::string& message) {
+    std::cerr << "Error evaluating function at x = " << x 
+              << ": " << message << std::endl;
+}
+
+} // namespace numerical
@@ -0,0 +1,612 @@
+#include "../include/cubature.h"
+#include "../include/evaluation.h"
+#include "../include/methods/gauss_legendre.h"
+#include "../include/methods/inline_rules.h"
+#include "../include/methods/monte_carlo.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+// Composite Newton-Cotes rule with n intervals on [0, 1]. The weights are
+// taken from the rule's own combine(), so they match the one-dimensional class.
+template <typename R>
+Cubature::Rule newtonCotesRule(long long n) {
+    if (n < 1 || n % R::panel != 0) {
+        throw std::invalid_argument("The rule needs a positive number of intervals divisible by "
+                                    + std::to_string(R::panel));
+    }
+    const double h = 1.0 / n;
+    const double none[R::panel] = {};
+    const double endWeight = R::combine(1.0, 0.0, none, h);
+    double classWeights[R::panel];
+    for (int r = 0; r < R::panel; ++r) {
+        double unit[R::panel] = {};
+        unit[r] = 1.0;
+        classWeights[r] = R::combine(0.0, 0.0, unit, h);
+    }
+
+    Cubature::Rule rule;
+    rule.nodes.resize(n + 1);
+    rule.weights.resize(n + 1);
+    for (long long i = 0; i <= n; ++i) {
+        // i / n rather than i * h, so nested grids give identical nodes
+        rule.nodes[i] = static_cast<double>(i) / static_cast<double>(n);
+        rule.weights[i] = (i == 0 || i == n) ? endWeight : classWeights[i % R::panel];
+    }
+    return rule;
+}
+
+// Composite Gauss-Legendre rule with the given panels on [0, 1]
+Cubature::Rule gaussRule(long long panels, int points) {
+    if (panels < 1) {
+        throw std::invalid_argument("Gauss-Legendre needs at least one panel");
+    }
+    const GaussLegendre::Rule& reference = GaussLegendre::getRule(points);
+    const int half = static_cast<int>(reference.nodes.size());
+    const bool hasCentre = points % 2 == 1;
+    const double halfWidth = 0.5 / static_cast<double>(panels);
+
+    Cubature::Rule rule;
+    for (long long panel = 0; panel < panels; ++panel) {
+        const double centre = (panel + 0.5) / static_cast<double>(panels);
+        // Stored nodes are the non-negative half in descending order
+        for (int j = 0; j < half; ++j) {
+            if (hasCentre && j == half - 1) {
+                continue;
+            }
+            rule.nodes.push_back(centre - halfWidth * reference.nodes[j]);
+            rule.weights.push_back(halfWidth * reference.weights[j]);
+        }
+        if (hasCentre) {
+            rule.nodes.push_back(centre);
+            rule.weights.push_back(halfWidth * reference.weights[half - 1]);
+        }
+        for (int j = half - 1; j >= 0; --j) {
+            if (hasCentre && j == half - 1) {
+                continue;
+            }
+            rule.nodes.push_back(centre + halfWidth * reference.nodes[j]);
+            rule.weights.push_back(halfWidth * reference.weights[j]);
+        }
+    }
+    return rule;
+}
+
+// Number of ways to choose k of n
+double binomial(int n, int k) {
+    double value = 1.0;
+    for (int i = 1; i <= k; ++i) {
+        value = value * (n - k + i) / i;
+    }
+    return value;
+}
+
+// Coefficient of the product with total level sum in the Smolyak formula of
+// the given level in d dimensions, or 0 if the product is not part of it
+double smolyakCoefficient(int level, int d, int sum) {
+    int distance = level - sum;
+    if (level < 0 || distance < 0 || distance > d - 1) {
+        return 0.0;
+    }
+    return (distance % 2 == 0 ? 1.0 : -1.0) * binomial(d - 1, distance);
+}
+
+} // namespace
+
+Cubature::Cubature(const Region& region, const Expression& integrand, const std::string& method, int size,
+                   Construction construction)
+    : region(region), integrand(integrand), method(method), size(size), construction(construction),
+      gaussPoints(4), sampling(Sampling::Sobol), seed(0), summation(Summation::Naive), observer(nullptr), evaluations(0),
+      errorEstimate(std::numeric_limits<double>::quiet_NaN()) {
+    if (integrand.getVariables() != region.getVariables()) {
+        std::string names;
+        for (const std::string& name : region.getVariables()) {
+            names += (names.empty() ? "" : ", ") + name;
+        }
+        throw std::invalid_argument("The integrand must be an expression of " + names);
+    }
+    if (construction == Construction::Smolyak) {
+        if (size < 0 || size > MAX_LEVEL) {
+            throw std::invalid_argument("Sparse-grid levels range from 0 to " + std::to_string(MAX_LEVEL));
+        }
+        createLevelRule(method, size);   // Validates the method and level
+    } else if (construction == Construction::MonteCarlo) {
+        if (size < 1) {
+            throw std::invalid_argument("Monte Carlo needs at least one point");
+        }
+    } else {
+        createRule(method, size, 1);     // Validates the method and intervals
+    }
+}
+
+void Cubature::setGaussPoints(int points) {
+    if (points < 1 || points > GaussLegendre::MAX_POINTS) {
+        throw std::invalid_argument("Gauss-Legendre points must be between 1 and "
+                                    + std::to_string(GaussLegendre::MAX_POINTS));
+    }
+    gaussPoints = points;
+}
+
+void Cubature::setSampling(Sampling method, std::uint64_t seed) {
+    sampling = method;
+    this->seed = seed;
+}
+
+void Cubature::setThreadCount(unsigned threads) {
+    blocks.setThreadCount(threads);
+}
+
+void Cubature::setSummation(Summation method) {
+    summation = method;
+}
+
+Cubature::Rule Cubature::createRule(const std::string& method, long long intervals, int gaussPoints) {
+    if (method == "trapezoidal") {
+        return newtonCotesRule<rules::Trapezoidal>(intervals);
+    }
+    if (method == "simpson13") {
+        return newtonCotesRule<rules::SimpsonOneThird>(intervals);
+    }
+    if (method == "simpson38") {
+        return newtonCotesRule<rules::SimpsonThreeEighth>(intervals);
+    }
+    if (method == "boole") {
+        return newtonCotesRule<rules::Boole>(intervals);
+    }
+    if (method == "gauss") {
+        return gaussRule(intervals, gaussPoints);
+    }
+    throw std::invalid_argument("Cubature supports trapezoidal, simpson13, simpson38, boole and gauss, not '"
+                                + method + "'");
+}
+
+Cubature::Rule Cubature::createLevelRule(const std::string& method, int level) {
+    if (level < 0 || level > MAX_LEVEL) {
+        throw std::invalid_argument("Sparse-grid levels range from 0 to " + std::to_string(MAX_LEVEL));
+    }
+    if (method == "gauss") {
+        const int points = (2 << level) - 1;
+        if (points > GaussLegendre::MAX_POINTS) {
+            throw std::invalid_argument("Gauss-Legendre sparse grids go up to level 7");
+        }
+        return gaussRule(1, points);
+    }
+    int panel = method == "simpson13" ? 2 : method == "simpson38" ? 3 : method == "boole" ? 4 : 1;
+    return createRule(method, static_cast<long long>(panel) << level, 1);
+}
+
+IntegrationResult Cubature::integrate(IntegrationObserver* observer) {
+    this->observer = observer;
+    bool showSteps = observer != nullptr && observer->wantsSteps();
+
+    IntegrationResult outcome;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        outcome.value = construction == Construction::Smolyak      ? computeSmolyak(showSteps)
+                      : construction == Construction::MonteCarlo ? computeMonteCarlo(showSteps)
+                                                                 : computeTensorProduct(showSteps);
+    } catch (...) {
+        this->observer = nullptr;
+        throw;
+    }
+    outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    this->observer = nullptr;
+
+    outcome.errorEstimate = errorEstimate;
+    outcome.evaluations = evaluations;
+    return outcome;
+}
+
+double Cubature::computeTensorProduct(bool showSteps) {
+    const int d = region.getDimension();
+    const Rule rule = createRule(method, size, gaussPoints);
+    const long long m = static_cast<long long>(rule.nodes.size());
+
+    // Each block takes whole rows of the innermost dimension, i.e. consecutive
+    // points of the outer dimensions, so the inner sweeps are batched together
+    long long rows = 1;
+    for (int k = 0; k + 1 < d; ++k) {
+        rows *= m;
+    }
+    const long long rowsPerBlock = std::max(1LL, BLOCK_POINTS / m);
+    const long long blockCount = (rows + rowsPerBlock - 1) / rowsPerBlock;
+
+    if (showSteps) {
+        step() << "\nPerforming " << getMethodName();
+        step() << "Region: " << region.getDescription();
+        step() << "Points per dimension: " << m;
+        step() << "Total points: " << rows * m << " in " << blockCount << " blocks";
+    }
+
+    // With constant inner bounds every row has the same inner coordinates
+    const int inner = d - 1;
+    const bool innerConstant = region.hasConstantBounds(inner);
+    std::vector<double> innerPoints;
+    double innerWidth = 0.0;
+    if (innerConstant) {
+        double lower;
+        double upper;
+        region.getBounds(inner, nullptr, &lower, &upper, 1);
+        innerWidth = upper - lower;
+        innerPoints.resize(m);
+        for (long long j = 0; j < m; ++j) {
+            innerPoints[j] = lower + rule.nodes[j] * innerWidth;
+        }
+    }
+
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    blocks.run(blockCount, [&](std::size_t block) {
+        double coordinates[Region::MAX_DIMENSION][BATCH_SIZE];
+        const double* variables[Region::MAX_DIMENSION];
+        for (int k = 0; k < d; ++k) {
+            variables[k] = coordinates[k];
+        }
+        double weights[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        Accumulator sum(summation);
+        int filled = 0;
+        auto flush = [&]() {
+            evaluateOrZero(integrand, variables, y, filled, observer);
+            for (int i = 0; i < filled; ++i) {
+                y[i] *= weights[i];
+            }
+            sum.add(y, filled);
+            filled = 0;
+        };
+
+        const long long firstRow = static_cast<long long>(block) * rowsPerBlock;
+        const long long lastRow = std::min(firstRow + rowsPerBlock, rows);
+        for (long long row = firstRow; row < lastRow; ++row) {
+            // Map the outer indices of the row onto the region, outermost first
+            double point[Region::MAX_DIMENSION];
+            const double* pointVariables[Region::MAX_DIMENSION] = {&point[0], &point[1], &point[2]};
+            double rowWeight = 1.0;
+            long long divisor = rows;
+            for (int k = 0; k < inner; ++k) {
+                divisor /= m;
+                long long index = row / divisor % m;
+                double lower;
+                double upper;
+                region.getBounds(k, pointVariables, &lower, &upper, 1);
+                point[k] = lower + rule.nodes[index] * (upper - lower);
+                rowWeight *= rule.weights[index] * (upper - lower);
+            }
+            double lower = 0.0;
+            double width = innerWidth;
+            if (!innerConstant) {
+                double upper;
+                region.getBounds(inner, pointVariables, &lower, &upper, 1);
+                width = upper - lower;
+            }
+            rowWeight *= width;
+
+            // Sweep the innermost dimension
+            for (long long j = 0; j < m; ++j) {
+                for (int k = 0; k < inner; ++k) {
+                    coordinates[k][filled] = point[k];
+                }
+                coordinates[inner][filled] = innerConstant ? innerPoints[j] : lower + rule.nodes[j] * width;
+                weights[filled] = rowWeight * rule.weights[j];
+                if (++filled == BATCH_SIZE) {
+                    flush();
+                }
+            }
+        }
+        if (filled > 0) {
+            flush();
+        }
+        blockSums[block] = sum;
+    });
+
+    // Combine the block sums in a fixed order, independent of the thread count
+    Accumulator total(summation);
+    for (const Accumulator& blockSum : blockSums) {
+        total.add(blockSum);
+    }
+    double result = total.total();
+    evaluations = rows * m;
+    errorEstimate = std::numeric_limits<double>::quiet_NaN();
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations;
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+std::vector<Cubature::SparsePoint> Cubature::buildSparseGrid(int level) const {
+    const int d = region.getDimension();
+    std::vector<Rule> rules;
+    for (int l = 0; l <= level; ++l) {
+        rules.push_back(createLevelRule(method, l));
+    }
+
+    // Visit every level combination with sum at most level and add the
+    // points of its tensor product with both Smolyak coefficients
+    std::vector<SparsePoint> points;
+    int levels[Region::MAX_DIMENSION] = {0, 0, 0};
+    while (true) {
+        int sum = 0;
+        for (int k = 0; k < d; ++k) {
+            sum += levels[k];
+        }
+        const double coefficient = smolyakCoefficient(level, d, sum);
+        const double coarseCoefficient = smolyakCoefficient(level - 1, d, sum);
+        if (coefficient != 0.0 || coarseCoefficient != 0.0) {
+            std::size_t index[Region::MAX_DIMENSION] = {0, 0, 0};
+            while (true) {
+                SparsePoint p = {{0.0, 0.0, 0.0}, coefficient, coarseCoefficient};
+                for (int k = 0; k < d; ++k) {
+                    const Rule& rule = rules[levels[k]];
+                    p.t[k] = rule.nodes[index[k]];
+                    p.weight *= rule.weights[index[k]];
+                    p.coarseWeight *= rule.weights[index[k]];
+                }
+                points.push_back(p);
+
+                int k = d - 1;
+                while (k >= 0 && ++index[k] == rules[levels[k]].nodes.size()) {
+                    index[k--] = 0;
+                }
+                if (k < 0) {
+                    break;
+                }
+            }
+        }
+
+        // Next combination with sum at most level
+        int k = d - 1;
+        while (k >= 0) {
+            if (sum < level) {
+                ++levels[k];
+                break;
+            }
+            sum -= levels[k];
+            levels[k--] = 0;
+        }
+        if (k < 0) {
+            break;
+        }
+    }
+
+    // Merge the points shared by several products
+    std::sort(points.begin(), points.end(), [](const SparsePoint& p, const SparsePoint& q) {
+        return p.t < q.t;
+    });
+    std::vector<SparsePoint> merged;
+    for (const SparsePoint& p : points) {
+        if (!merged.empty() && merged.back().t == p.t) {
+            merged.back().weight += p.weight;
+            merged.back().coarseWeight += p.coarseWeight;
+        } else {
+            merged.push_back(p);
+        }
+    }
+    merged.erase(std::remove_if(merged.begin(), merged.end(), [](const SparsePoint& p) {
+        return p.weight == 0.0 && p.coarseWeight == 0.0;
+    }), merged.end());
+    return merged;
+}
+
+double Cubature::computeSmolyak(bool showSteps) {
+    const int d = region.getDimension();
+    const std::vector<SparsePoint> points = buildSparseGrid(size);
+    const long long count = static_cast<long long>(points.size());
+    const long long blockCount = (count + BLOCK_POINTS - 1) / BLOCK_POINTS;
+
+    if (showSteps) {
+        const long long finest = static_cast<long long>(createLevelRule(method, size).nodes.size());
+        step() << "\nPerforming " << getMethodName();
+        step() << "Region: " << region.getDescription();
+        step() << "Finest rule: " << finest << " points per dimension";
+        step() << "Sparse grid: " << count << " points (tensor product of the finest rule: "
+               << std::pow(static_cast<double>(finest), d) << ")";
+    }
+
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    std::vector<Accumulator> coarseBlockSums(blockCount, Accumulator(summation));
+    blocks.run(blockCount, [&](std::size_t block) {
+        double coordinates[Region::MAX_DIMENSION][BATCH_SIZE];
+        const double* variables[Region::MAX_DIMENSION];
+        for (int k = 0; k < d; ++k) {
+            variables[k] = coordinates[k];
+        }
+        double jacobian[BATCH_SIZE];
+        double lower[BATCH_SIZE];
+        double upper[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        double weighted[BATCH_SIZE];
+        Accumulator sum(summation);
+        Accumulator coarseSum(summation);
+
+        const long long first = static_cast<long long>(block) * BLOCK_POINTS;
+        const long long last = std::min(first + BLOCK_POINTS, count);
+        for (long long start = first; start < last; start += BATCH_SIZE) {
+            const int n = static_cast<int>(std::min<long long>(BATCH_SIZE, last - start));
+            const SparsePoint* batch = points.data() + start;
+
+            // Map the unit cube onto the region one dimension at a time
+            std::fill(jacobian, jacobian + n, 1.0);
+            for (int k = 0; k < d; ++k) {
+                region.getBounds(k, variables, lower, upper, n);
+                for (int i = 0; i < n; ++i) {
+                    const double width = upper[i] - lower[i];
+                    coordinates[k][i] = lower[i] + batch[i].t[k] * width;
+                    jacobian[i] *= width;
+                }
+            }
+            evaluateOrZero(integrand, variables, y, n, observer);
+
+            for (int i = 0; i < n; ++i) {
+                weighted[i] = batch[i].weight * jacobian[i] * y[i];
+            }
+            sum.add(weighted, n);
+            for (int i = 0; i < n; ++i) {
+                weighted[i] = batch[i].coarseWeight * jacobian[i] * y[i];
+            }
+            coarseSum.add(weighted, n);
+        }
+        blockSums[block] = sum;
+        coarseBlockSums[block] = coarseSum;
+    });
+
+    // Combine the block sums in a fixed order, independent of the thread count
+    Accumulator total(summation);
+    Accumulator coarseTotal(summation);
+    for (long long block = 0; block < blockCount; ++block) {
+        total.add(blockSums[block]);
+        coarseTotal.add(coarseBlockSums[block]);
+    }
+    double result = total.total();
+    evaluations = count;
+    errorEstimate = size > 0 ? std::abs(result - coarseTotal.total()) : std::numeric_limits<double>::quiet_NaN();
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations;
+        if (size > 0) {
+            step() << "Level " << size - 1 << " result = " << coarseTotal.total();
+        }
+        step() << "Level " << size << " result = " << result;
+    }
+    return result;
+}
+
+double Cubature::computeMonteCarlo(bool showSteps) {
+    const int d = region.getDimension();
+    const SamplingSequence sequence(sampling, d, seed);
+
+    // Pseudo-random points form one stream; quasi-random ones are split into
+    // replicates, at most one per point, whose sizes add up to the points
+    const long long points = size;
+    const int replicates =
+        sampling == Sampling::Pseudo ? 1 : static_cast<int>(std::min<long long>(MonteCarlo::REPLICATES, points));
+    const long long blocksPerReplicate = (replicateSize(points, replicates, 0) + BLOCK_POINTS - 1) / BLOCK_POINTS;
+    const long long blockCount = replicates * blocksPerReplicate;
+
+    if (showSteps) {
+        step() << "\nPerforming " << getMethodName();
+        step() << "Region: " << region.getDescription();
+        step() << "Seed: " << seed;
+        if (replicates > 1) {
+            step() << "Replicates: " << describeReplicates(points, replicates);
+        } else {
+            step() << "Points: " << points;
+        }
+    }
+
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    std::vector<SampleMoments> blockMoments(blockCount);
+    blocks.run(blockCount, [&](std::size_t block) {
+        double coordinates[Region::MAX_DIMENSION][BATCH_SIZE];
+        double* unit[Region::MAX_DIMENSION];
+        const double* variables[Region::MAX_DIMENSION];
+        double t[Region::MAX_DIMENSION][BATCH_SIZE];
+        for (int k = 0; k < d; ++k) {
+            variables[k] = coordinates[k];
+            unit[k] = t[k];
+        }
+        double jacobian[BATCH_SIZE];
+        double lower[BATCH_SIZE];
+        double upper[BATCH_SIZE];
+        double y[BATCH_SIZE];
+
+        const std::uint32_t replicate = static_cast<std::uint32_t>(block / blocksPerReplicate);
+        const long long first = static_cast<long long>(block % blocksPerReplicate) * BLOCK_POINTS;
+        const long long last = std::min(first + BLOCK_POINTS, replicateSize(points, replicates, replicate));
+        for (long long start = first; start < last; start += BATCH_SIZE) {
+            const int n = static_cast<int>(std::min<long long>(BATCH_SIZE, last - start));
+            sequence.generate(replicate, static_cast<std::uint64_t>(start), n, unit);
+
+            // Map the unit cube onto the region one dimension at a time
+            std::fill(jacobian, jacobian + n, 1.0);
+            for (int k = 0; k < d; ++k) {
+                region.getBounds(k, variables, lower, upper, n);
+                for (int i = 0; i < n; ++i) {
+                    const double width = upper[i] - lower[i];
+                    coordinates[k][i] = lower[i] + t[k][i] * width;
+                    jacobian[i] *= width;
+                }
+            }
+            evaluateOrZero(integrand, variables, y, n, observer);
+            for (int i = 0; i < n; ++i) {
+                y[i] *= jacobian[i];
+            }
+            blockSums[block].add(y, n);
+            blockMoments[block].add(y, n);
+        }
+    });
+
+    // Combine the blocks of each replicate in order, independent of the thread count
+    Accumulator meanSum(summation);
+    SampleMoments replicateMeans;
+    SampleMoments values;
+    for (int r = 0; r < replicates; ++r) {
+        Accumulator sum(summation);
+        for (long long k = 0; k < blocksPerReplicate; ++k) {
+            sum.add(blockSums[r * blocksPerReplicate + k]);
+            values.merge(blockMoments[r * blocksPerReplicate + k]);
+        }
+        const double mean = sum.total() / static_cast<double>(replicateSize(points, replicates, r));
+        meanSum.add(&mean, 1);
+        replicateMeans.add(&mean, 1);
+        if (showSteps && replicates > 1) {
+            step() << "Replicate " << r + 1 << " result = " << mean;
+        }
+    }
+
+    double result = meanSum.total() / replicates;
+    evaluations = points;
+    if (points < 2) {
+        errorEstimate = std::numeric_limits<double>::quiet_NaN(); // No spread to measure
+    } else {
+        errorEstimate = replicates > 1 ? std::sqrt(replicateMeans.variance() / replicates)
+                                       : std::sqrt(values.variance() / static_cast<double>(evaluations));
+    }
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations;
+        step() << "Standard error: " << errorEstimate;
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+StepWriter Cubature::step() const {
+    return StepWriter(observer);
+}
+
+std::string Cubature::getRuleName(const std::string& method) {
+    return method == "trapezoidal" ? "Trapezoidal Rule"
+         : method == "simpson13" ? "Simpson's 1/3 Rule"
+         : method == "simpson38" ? "Simpson's 3/8 Rule"
+         : method == "boole" ? "Boole's Rule" : "Gauss-Legendre";
+}
+
+std::string Cubature::getMethodName() const {
+    if (construction == Construction::MonteCarlo) {
+        return std::string(sampling == Sampling::Pseudo ? "Monte Carlo (Philox, " : "Quasi-Monte Carlo (")
+               + (sampling == Sampling::Halton ? "Halton, " : sampling == Sampling::Sobol ? "Sobol, " : "")
+               + std::to_string(size) + " points)";
+    }
+    const std::string rule = getRuleName(method);
+    if (construction == Construction::Smolyak) {
+        return "Sparse-grid " + rule + " (level " + std::to_string(size) + ")";
+    }
+
+    std::string shape = std::to_string(size);
+    for (int k = 1; k < region.getDimension(); ++k) {
+        shape += " x " + std::to_string(size);
+    }
+    if (method == "gauss") {
+        return "Tensor-product " + rule + " (" + shape + " panels, " + std::to_string(gaussPoints) + " points each)";
+    }
+    return "Tensor-product " + rule + " (" + shape + " intervals)";
+}
+
+} // namespace numerical
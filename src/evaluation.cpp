@@ -0,0 +1,62 @@
+#include "../include/evaluation.h"
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace numerical {
+
+namespace {
+
+void reportUndefinedValue(IntegrationObserver* observer, double x, const std::exception& error) {
+    if (observer) {
+        // Points may be evaluated concurrently; report one at a time
+        static std::mutex errorMutex;
+        std::lock_guard<std::mutex> lock(errorMutex);
+        observer->onUndefinedValue(x, error.what());
+    }
+}
+
+} // namespace
+
+double evaluateOrZero(const Function& function, double x, IntegrationObserver* observer) {
+    try {
+        return function.evaluate(x);
+    } catch (const std::exception& e) {
+        reportUndefinedValue(observer, x, e);
+        return 0.0;
+    }
+}
+
+void evaluateOrZero(const Function& function, const double* x, double* y, int count,
+                    IntegrationObserver* observer) {
+    try {
+        function.evaluate(x, y, count);
+    } catch (const std::exception&) {
+        for (int i = 0; i < count; ++i) {
+            y[i] = evaluateOrZero(function, x[i], observer);
+        }
+    }
+}
+
+void evaluateOrZero(const Expression& expression, const double* const* variables, double* y, int count,
+                    IntegrationObserver* observer) {
+    try {
+        expression.evaluate(variables, y, count);
+    } catch (const std::exception&) {
+        // Find the undefined points one at a time
+        std::vector<const double*> point(expression.getVariables().size());
+        for (int i = 0; i < count; ++i) {
+            for (std::size_t k = 0; k < point.size(); ++k) {
+                point[k] = variables[k] + i;
+            }
+            try {
+                expression.evaluate(point.data(), &y[i], 1);
+            } catch (const std::exception& e) {
+                y[i] = 0.0;
+                reportUndefinedValue(observer, variables[0][i], e);
+            }
+        }
+    }
+}
+
+} // namespace numerical
@@ -0,0 +1,542 @@
+#include "../include/expression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double E = 2.71828182845904523536;
+
+// Compare constants by representation, so that 0.0 and -0.0 stay distinct
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// t[i] = f(a[i]) for a block of points
+template<typename F>
+void applyToBlock(double* t, const double* a, std::size_t n, F f) {
+    for (std::size_t i = 0; i < n; ++i) {
+        t[i] = f(a[i]);
+    }
+}
+
+} // namespace
+
+/**
+ * @class Expression::Parser
+ * @brief Recursive-descent parser adding the nodes of an expression to the graph
+ *
+ * Grammar:
+ *   sum     = product { ("+" | "-") product }
+ *   product = unary { ("*" | "/") unary }
+ *   unary   = ("-" | "+") unary | power
+ *   power   = primary [ "^" unary ]
+ *   primary = number | variable | "pi" | "e" | name "(" sum ")" | "(" sum ")"
+ */
+class Expression::Parser {
+public:
+    Parser(Expression& expression, const std::string& text)
+        : expression(expression), text(text), position(0) {
+    }
+
+    int parse() {
+        int root = parseSum();
+        skipSpaces();
+        if (position < text.size()) {
+            fail("unexpected '" + std::string(1, text[position]) + "'");
+        }
+        return root;
+    }
+
+private:
+    Expression& expression;
+    const std::string& text;
+    std::size_t position;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("Invalid expression at position " + std::to_string(position + 1)
+                                    + ": " + message);
+    }
+
+    void skipSpaces() {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+            ++position;
+        }
+    }
+
+    bool accept(char c) {
+        skipSpaces();
+        if (position < text.size() && text[position] == c) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    int parseSum() {
+        int left = parseProduct();
+        while (true) {
+            if (accept('+')) {
+                left = expression.addNode(Op::Add, left, parseProduct());
+            } else if (accept('-')) {
+                left = expression.addNode(Op::Subtract, left, parseProduct());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    int parseProduct() {
+        int left = parseUnary();
+        while (true) {
+            if (accept('*')) {
+                left = expression.addNode(Op::Multiply, left, parseUnary());
+            } else if (accept('/')) {
+                left = expression.addNode(Op::Divide, left, parseUnary());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    int parseUnary() {
+        if (accept('-')) {
+            return expression.addNode(Op::Negate, parseUnary());
+        }
+        if (accept('+')) {
+            return parseUnary();
+        }
+        return parsePower();
+    }
+
+    int parsePower() {
+        int base = parsePrimary();
+        if (accept('^')) {
+            // Right-associative, and -x^2 means -(x^2)
+            return expression.addNode(Op::Power, base, parseUnary());
+        }
+        return base;
+    }
+
+    int parsePrimary() {
+        skipSpaces();
+        if (position >= text.size()) {
+            fail("unexpected end of expression");
+        }
+
+        char c = text[position];
+        if (accept('(')) {
+            int inner = parseSum();
+            if (!accept(')')) {
+                fail("expected ')'");
+            }
+            return inner;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* begin = text.c_str() + position;
+            char* end = nullptr;
+            double value = std::strtod(begin, &end);
+            if (end == begin) {
+                fail("invalid number");
+            }
+            position += static_cast<std::size_t>(end - begin);
+            return expression.addNode(Op::Constant, -1, -1, value);
+        }
+
+        if (std::isalpha(static_cast<unsigned char>(c))) {
+            std::size_t start = position;
+            while (position < text.size() && std::isalnum(static_cast<unsigned char>(text[position]))) {
+                ++position;
+            }
+            std::string name = text.substr(start, position - start);
+
+            const std::vector<std::string>& variables = expression.variables;
+            auto variable = std::find(variables.begin(), variables.end(), name);
+            if (variable != variables.end()) {
+                return expression.addNode(Op::Variable, -1, -1,
+                                          static_cast<double>(variable - variables.begin()));
+            }
+            if (name == "pi") {
+                return expression.addNode(Op::Constant, -1, -1, PI);
+            }
+            if (name == "e") {
+                return expression.addNode(Op::Constant, -1, -1, E);
+            }
+
+            Op op = functionOp(name);
+            if (!accept('(')) {
+                fail("expected '(' after " + name);
+            }
+            int argument = parseSum();
+            if (!accept(')')) {
+                fail("expected ')'");
+            }
+            return expression.addNode(op, argument);
+        }
+
+        fail("unexpected '" + std::string(1, c) + "'");
+    }
+
+    Op functionOp(const std::string& name) {
+        static const std::pair<const char*, Op> functions[] = {
+            {"sin", Op::Sin}, {"cos", Op::Cos}, {"tan", Op::Tan},
+            {"asin", Op::Asin}, {"acos", Op::Acos}, {"atan", Op::Atan},
+            {"sinh", Op::Sinh}, {"cosh", Op::Cosh}, {"tanh", Op::Tanh},
+            {"exp", Op::Exp}, {"ln", Op::Log}, {"log", Op::Log}, {"log10", Op::Log10},
+            {"sqrt", Op::Sqrt}, {"abs", Op::Abs}
+        };
+        for (const auto& function : functions) {
+            if (name == function.first) {
+                return function.second;
+            }
+        }
+        position -= name.size();
+        fail("unknown name '" + name + "'");
+    }
+};
+
+Expression::Expression(const std::string& text, std::vector<std::string> variables)
+    : text(text), variables(std::move(variables)), registerCount(1), resultRegister(0) {
+    if (this->variables.size() > UINT16_MAX) {
+        throw std::invalid_argument("Expression has too many variables");
+    }
+    Parser parser(*this, text);
+    compile(parser.parse());
+}
+
+int Expression::addNode(Op op, int left, int right, double value) {
+    const bool unary = left >= 0 && right < 0;
+    const bool binary = right >= 0;
+    auto isConstant = [this](int node, double constant) {
+        return nodes[node].op == Op::Constant && sameBits(nodes[node].value, constant);
+    };
+
+    // Fold operations on constants, with the same arithmetic as evaluation
+    if (unary && nodes[left].op == Op::Constant) {
+        return addNode(Op::Constant, -1, -1, applyUnary(op, nodes[left].value));
+    }
+    if (binary && nodes[left].op == Op::Constant && nodes[right].op == Op::Constant) {
+        return addNode(Op::Constant, -1, -1, applyBinary(op, nodes[left].value, nodes[right].value));
+    }
+
+    // Identities that hold exactly in floating point
+    if (op == Op::Negate && nodes[left].op == Op::Negate) {
+        return nodes[left].left;
+    }
+    if ((op == Op::Multiply && isConstant(right, 1.0)) || (op == Op::Divide && isConstant(right, 1.0))
+        || (op == Op::Subtract && isConstant(right, 0.0)) || (op == Op::Power && isConstant(right, 1.0))) {
+        return left;
+    }
+    if (op == Op::Multiply && isConstant(left, 1.0)) {
+        return right;
+    }
+    if (op == Op::Power && isConstant(right, 2.0)) {
+        return addNode(Op::Multiply, left, left);
+    }
+
+    // Both operand orders of + and * give the same result; store one of them
+    if ((op == Op::Add || op == Op::Multiply) && left > right) {
+        std::swap(left, right);
+    }
+
+    // Reuse an identical node; expressions are short, so a linear scan is enough
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        if (node.op == op && node.left == left && node.right == right
+            && ((op != Op::Constant && op != Op::Variable) || sameBits(node.value, value))) {
+            return static_cast<int>(i);
+        }
+    }
+
+    nodes.push_back({op, left, right, value});
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void Expression::compile(int root) {
+    code.clear();
+    // Registers 0 .. variables.size()-1 hold the variables
+    const std::size_t variableCount = variables.size();
+    registerCount = std::max<std::size_t>(variableCount, 1);
+    const Node& top = nodes[root];
+    if (top.op == Op::Variable) {
+        resultRegister = static_cast<std::uint16_t>(top.value);
+        return;
+    }
+    if (top.op == Op::Constant) {
+        // Written to a register of its own, so the variables are left alone
+        code.push_back({Op::Constant, static_cast<std::uint16_t>(variableCount), 0, 0, top.value});
+        resultRegister = static_cast<std::uint16_t>(variableCount);
+        registerCount = variableCount + 1;
+        return;
+    }
+
+    // Find the nodes the result depends on and the last node using each one.
+    // Operands always come before their users, so one backward pass suffices.
+    std::vector<bool> needed(nodes.size(), false);
+    std::vector<int> lastUse(nodes.size(), -1);
+    needed[root] = true;
+    for (int i = root; i >= 0; --i) {
+        if (!needed[i]) {
+            continue;
+        }
+        for (int operand : {nodes[i].left, nodes[i].right}) {
+            if (operand >= 0) {
+                needed[operand] = true;
+                lastUse[operand] = std::max(lastUse[operand], i);
+            }
+        }
+    }
+
+    // Register k holds variable k; every register is reused as soon as its value is dead
+    std::vector<int> registerOf(nodes.size(), -1);
+    std::vector<std::uint16_t> freeRegisters;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].op == Op::Variable) {
+            registerOf[i] = static_cast<int>(nodes[i].value);
+        }
+    }
+
+    for (int i = 0; i <= root; ++i) {
+        const Node& node = nodes[i];
+        if (!needed[i] || node.op == Op::Constant || node.op == Op::Variable) {
+            continue;
+        }
+
+        Instruction instruction = {node.op, 0, 0, 0, 0.0};
+        const bool leftConstant = nodes[node.left].op == Op::Constant;
+        const bool rightConstant = node.right >= 0 && nodes[node.right].op == Op::Constant;
+        int leftNode = leftConstant ? node.right : node.left;
+        int rightNode = node.right;
+        if (leftConstant || rightConstant) {
+            // One operand is a constant (folding removed the case of two)
+            instruction.constant = nodes[leftConstant ? node.left : node.right].value;
+            rightNode = -1;
+            switch (node.op) {
+                case Op::Add:
+                    instruction.op = Op::AddConstant;
+                    break;
+                case Op::Subtract:
+                    // a - c is a + (-c) in IEEE arithmetic
+                    instruction.op = leftConstant ? Op::SubtractFromConstant : Op::AddConstant;
+                    if (!leftConstant) {
+                        instruction.constant = -instruction.constant;
+                    }
+                    break;
+                case Op::Multiply:
+                    instruction.op = Op::MultiplyConstant;
+                    break;
+                case Op::Divide:
+                    instruction.op = leftConstant ? Op::DivideConstant : Op::DivideByConstant;
+                    break;
+                default: // Power
+                    instruction.op = leftConstant ? Op::ConstantPower : Op::PowerConstant;
+                    break;
+            }
+        } else if (node.op == Op::Multiply && node.left == node.right) {
+            instruction.op = Op::Square;
+            rightNode = -1;
+        }
+
+        instruction.left = static_cast<std::uint16_t>(registerOf[leftNode]);
+        if (rightNode >= 0) {
+            instruction.right = static_cast<std::uint16_t>(registerOf[rightNode]);
+        }
+
+        // Release operands used for the last time; the target may reuse them
+        for (int operand : {leftNode, rightNode}) {
+            if (operand >= 0 && lastUse[operand] == i && registerOf[operand] >= 0
+                && std::find(freeRegisters.begin(), freeRegisters.end(), registerOf[operand]) == freeRegisters.end()) {
+                freeRegisters.push_back(static_cast<std::uint16_t>(registerOf[operand]));
+            }
+        }
+
+        if (!freeRegisters.empty()) {
+            registerOf[i] = freeRegisters.back();
+            freeRegisters.pop_back();
+        } else {
+            if (registerCount > UINT16_MAX) {
+                throw std::invalid_argument("Expression is too large");
+            }
+            registerOf[i] = static_cast<int>(registerCount++);
+        }
+        instruction.target = static_cast<std::uint16_t>(registerOf[i]);
+        code.push_back(instruction);
+    }
+
+    resultRegister = static_cast<std::uint16_t>(registerOf[root]);
+}
+
+double Expression::evaluate(double x) const {
+    double y;
+    evaluate(&x, &y, 1);
+    return y;
+}
+
+void Expression::evaluate(const double* x, double* y, std::size_t count) const {
+    if (variables.size() > 1) {
+        throw std::invalid_argument("Expression '" + text + "' has more than one variable");
+    }
+    evaluate(&x, y, count);
+}
+
+void Expression::evaluate(const double* const* values, double* y, std::size_t count) const {
+    // Register file of the calling thread, BLOCK_SIZE values per register
+    thread_local std::vector<double> registers;
+    if (registers.size() < registerCount * BLOCK_SIZE) {
+        registers.resize(registerCount * BLOCK_SIZE);
+    }
+
+    for (std::size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const std::size_t n = std::min(BLOCK_SIZE, count - start);
+        for (std::size_t v = 0; v < variables.size(); ++v) {
+            std::copy(values[v] + start, values[v] + start + n, registers.data() + v * BLOCK_SIZE);
+        }
+
+        for (const Instruction& instruction : code) {
+            double* t = registers.data() + instruction.target * BLOCK_SIZE;
+            const double* a = registers.data() + instruction.left * BLOCK_SIZE;
+            const double* b = registers.data() + instruction.right * BLOCK_SIZE;
+            const double c = instruction.constant;
+
+            switch (instruction.op) {
+                case Op::Constant:
+                    std::fill(t, t + n, c);
+                    break;
+                case Op::Add:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] + b[i];
+                    break;
+                case Op::Subtract:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] - b[i];
+                    break;
+                case Op::Multiply:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] * b[i];
+                    break;
+                case Op::Divide:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] / b[i];
+                    break;
+                case Op::Power:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = std::pow(a[i], b[i]);
+                    break;
+                case Op::Negate:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = -a[i];
+                    break;
+                case Op::Square:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] * a[i];
+                    break;
+                case Op::AddConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] + c;
+                    break;
+                case Op::SubtractFromConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = c - a[i];
+                    break;
+                case Op::MultiplyConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] * c;
+                    break;
+                case Op::DivideByConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = a[i] / c;
+                    break;
+                case Op::DivideConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = c / a[i];
+                    break;
+                case Op::PowerConstant:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = std::pow(a[i], c);
+                    break;
+                case Op::ConstantPower:
+                    for (std::size_t i = 0; i < n; ++i) t[i] = std::pow(c, a[i]);
+                    break;
+                case Op::Sin:   applyToBlock(t, a, n, [](double v) { return std::sin(v); }); break;
+                case Op::Cos:   applyToBlock(t, a, n, [](double v) { return std::cos(v); }); break;
+                case Op::Tan:   applyToBlock(t, a, n, [](double v) { return std::tan(v); }); break;
+                case Op::Asin:  applyToBlock(t, a, n, [](double v) { return std::asin(v); }); break;
+                case Op::Acos:  applyToBlock(t, a, n, [](double v) { return std::acos(v); }); break;
+                case Op::Atan:  applyToBlock(t, a, n, [](double v) { return std::atan(v); }); break;
+                case Op::Sinh:  applyToBlock(t, a, n, [](double v) { return std::sinh(v); }); break;
+                case Op::Cosh:  applyToBlock(t, a, n, [](double v) { return std::cosh(v); }); break;
+                case Op::Tanh:  applyToBlock(t, a, n, [](double v) { return std::tanh(v); }); break;
+                case Op::Exp:   applyToBlock(t, a, n, [](double v) { return std::exp(v); }); break;
+                case Op::Log:   applyToBlock(t, a, n, [](double v) { return std::log(v); }); break;
+                case Op::Log10: applyToBlock(t, a, n, [](double v) { return std::log10(v); }); break;
+                case Op::Sqrt:  applyToBlock(t, a, n, [](double v) { return std::sqrt(v); }); break;
+                case Op::Abs:   applyToBlock(t, a, n, [](double v) { return std::fabs(v); }); break;
+                case Op::Variable:
+                    break;
+            }
+        }
+
+        // Values outside the domain (log of a negative number, division by
+        // zero, ...) come out as NaN or infinity
+        const double* result = registers.data() + resultRegister * BLOCK_SIZE;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(result[i])) {
+                std::string point;
+                for (std::size_t v = 0; v < variables.size(); ++v) {
+                    point += (v == 0 ? " at " : ", ") + variables[v] + " = "
+                             + std::to_string(values[v][start + i]);
+                }
+                throw std::domain_error("Function undefined" + point);
+            }
+        }
+        std::copy(result, result + n, y + start);
+    }
+}
+
+const std::string& Expression::getText() const {
+    return text;
+}
+
+const std::vector<std::string>& Expression::getVariables() const {
+    return variables;
+}
+
+bool Expression::isConstant() const {
+    return code.size() == 1 && code[0].op == Op::Constant;
+}
+
+std::size_t Expression::getInstructionCount() const {
+    return code.size();
+}
+
+std::size_t Expression::getRegisterCount() const {
+    return registerCount;
+}
+
+double Expression::applyUnary(Op op, double a) {
+    switch (op) {
+        case Op::Negate: return -a;
+        case Op::Sin:    return std::sin(a);
+        case Op::Cos:    return std::cos(a);
+        case Op::Tan:    return std::tan(a);
+        case Op::Asin:   return std::asin(a);
+        case Op::Acos:   return std::acos(a);
+        case Op::Atan:   return std::atan(a);
+        case Op::Sinh:   return std::sinh(a);
+        case Op::Cosh:   return std::cosh(a);
+        case Op::Tanh:   return std::tanh(a);
+        case Op::Exp:    return std::exp(a);
+        case Op::Log:    return std::log(a);
+        case Op::Log10:  return std::log10(a);
+        case Op::Sqrt:   return std::sqrt(a);
+        case Op::Abs:    return std::fabs(a);
+        default:         return a;
+    }
+}
+
+double Expression::applyBinary(Op op, double a, double b) {
+    switch (op) {
+        case Op::Add:      return a + b;
+        case Op::Subtract: return a - b;
+        case Op::Multiply: return a * b;
+        case Op::Divide:   return a / b;
+        case Op::Power:    return std::pow(a, b);
+        default:           return a;
+    }
+}
+
+} // namespace numerical
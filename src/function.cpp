@@ -8,7 +8,7 @@ namespace numerical {
 constexpr double PI = 3.14159265358979323846;
 constexpr double E = 2.71828182845904523536;
 
-Function::Function(int choice) {
+Function::Function(int choice) : batchKernel(kernels::selectKernel(choice)), choice(choice) {
     // Define available functions
     switch (choice) {
         case 1: // 1/(1+x)
@@ -65,14 +65,38 @@ Function::Function(int choice) {
     }
 }
 
+Function::Function(const std::string& expression)
+    : batchKernel(nullptr), expression(std::make_shared<const Expression>(expression)), choice(0),
+      source(expression) {
+    std::shared_ptr<const Expression> compiled = this->expression;
+    func = [compiled](double x) { return compiled->evaluate(x); };
+    description = "f(x) = " + expression;
+}
+
 double Function::evaluate(double x) const {
     return func(x);
 }
 
+void Function::evaluate(const double* x, double* y, std::size_t count) const {
+    if (expression) {
+        expression->evaluate(x, y, count);
+        return;
+    }
+    batchKernel(x, y, count);
+}
+
 std::string Function::getDescription() const {
     return description;
 }
 
+int Function::getChoice() const {
+    return choice;
+}
+
+std::string Function::getExpression() const {
+    return source;
+}
+
 std::vector<std::string> Function::getAvailableFunctions() {
     return {
         "1/(1+x)",
@@ -0,0 +1,292 @@
+#include "../include/function_kernels.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NUMERICAL_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace numerical {
+namespace kernels {
+
+namespace {
+
+[[noreturn]] void throwUndefined(double x) {
+    throw std::domain_error("Function undefined at x = " + std::to_string(x));
+}
+
+// Scalar kernels, one per predefined function. The algebraic ones double as
+// the tail loops of the SIMD kernels below.
+
+void reciprocalScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = 1.0 / (1.0 + x[i]);
+    }
+}
+
+void squareScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = x[i] * x[i];
+    }
+}
+
+void sinScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = std::sin(x[i]);
+    }
+}
+
+void expScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = std::exp(x[i]);
+    }
+}
+
+void inverseSqrtScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (x[i] <= -1.0 || x[i] >= 1.0) {
+            throwUndefined(x[i]);
+        }
+        y[i] = 1.0 / std::sqrt(1.0 - x[i] * x[i]);
+    }
+}
+
+void logScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (x[i] <= 0.0) {
+            throwUndefined(x[i]);
+        }
+        y[i] = std::log(x[i]);
+    }
+}
+
+void xSinScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] = x[i] * std::sin(x[i]);
+    }
+}
+
+void sqrtScalar(const double* x, double* y, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (x[i] < 0.0) {
+            throwUndefined(x[i]);
+        }
+        y[i] = std::sqrt(x[i]);
+    }
+}
+
+#ifdef NUMERICAL_X86_KERNELS
+
+// Finds the first out-of-domain lane of a vector and reports it
+[[noreturn]] void throwFirstUndefined(const double* x, unsigned mask) {
+    int lane = 0;
+    while (!(mask & (1u << lane))) {
+        ++lane;
+    }
+    throwUndefined(x[lane]);
+}
+
+// AVX2 kernels (4 doubles per vector)
+
+__attribute__((target("avx2")))
+void reciprocalAvx2(const double* x, double* y, std::size_t count) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        _mm256_storeu_pd(y + i, _mm256_div_pd(one, _mm256_add_pd(one, v)));
+    }
+    reciprocalScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void squareAvx2(const double* x, double* y, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        _mm256_storeu_pd(y + i, _mm256_mul_pd(v, v));
+    }
+    squareScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void inverseSqrtAvx2(const double* x, double* y, std::size_t count) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d minusOne = _mm256_set1_pd(-1.0);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        __m256d undefined = _mm256_or_pd(_mm256_cmp_pd(v, minusOne, _CMP_LE_OQ),
+                                         _mm256_cmp_pd(v, one, _CMP_GE_OQ));
+        int mask = _mm256_movemask_pd(undefined);
+        if (mask) {
+            throwFirstUndefined(x + i, static_cast<unsigned>(mask));
+        }
+        __m256d root = _mm256_sqrt_pd(_mm256_sub_pd(one, _mm256_mul_pd(v, v)));
+        _mm256_storeu_pd(y + i, _mm256_div_pd(one, root));
+    }
+    inverseSqrtScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void sqrtAvx2(const double* x, double* y, std::size_t count) {
+    const __m256d zero = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_loadu_pd(x + i);
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(v, zero, _CMP_LT_OQ));
+        if (mask) {
+            throwFirstUndefined(x + i, static_cast<unsigned>(mask));
+        }
+        _mm256_storeu_pd(y + i, _mm256_sqrt_pd(v));
+    }
+    sqrtScalar(x + i, y + i, count - i);
+}
+
+// AVX-512 kernels (8 doubles per vector)
+
+// Same as _mm512_sqrt_pd, whose GCC 12 expansion triggers a spurious
+// -Wmaybe-uninitialized warning
+__attribute__((target("avx512f")))
+inline __m512d sqrtAvx512Vector(__m512d v) {
+    return _mm512_mask_sqrt_pd(v, static_cast<__mmask8>(0xFF), v);
+}
+
+__attribute__((target("avx512f")))
+void reciprocalAvx512(const double* x, double* y, std::size_t count) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        _mm512_storeu_pd(y + i, _mm512_div_pd(one, _mm512_add_pd(one, v)));
+    }
+    reciprocalScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void squareAvx512(const double* x, double* y, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        _mm512_storeu_pd(y + i, _mm512_mul_pd(v, v));
+    }
+    squareScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void inverseSqrtAvx512(const double* x, double* y, std::size_t count) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d minusOne = _mm512_set1_pd(-1.0);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        __mmask8 mask = _mm512_cmp_pd_mask(v, minusOne, _CMP_LE_OQ) |
+                        _mm512_cmp_pd_mask(v, one, _CMP_GE_OQ);
+        if (mask) {
+            throwFirstUndefined(x + i, mask);
+        }
+        __m512d root = sqrtAvx512Vector(_mm512_sub_pd(one, _mm512_mul_pd(v, v)));
+        _mm512_storeu_pd(y + i, _mm512_div_pd(one, root));
+    }
+    inverseSqrtScalar(x + i, y + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void sqrtAvx512(const double* x, double* y, std::size_t count) {
+    const __m512d zero = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d v = _mm512_loadu_pd(x + i);
+        __mmask8 mask = _mm512_cmp_pd_mask(v, zero, _CMP_LT_OQ);
+        if (mask) {
+            throwFirstUndefined(x + i, mask);
+        }
+        _mm512_storeu_pd(y + i, sqrtAvx512Vector(v));
+    }
+    sqrtScalar(x + i, y + i, count - i);
+}
+
+#endif // NUMERICAL_X86_KERNELS
+
+enum class Isa { Scalar, Avx2, Avx512 };
+
+Isa detectIsa() {
+#ifdef NUMERICAL_X86_KERNELS
+    static const Isa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return Isa::Avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return Isa::Avx2;
+        }
+        return Isa::Scalar;
+    }();
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+} // namespace
+
+BatchKernel selectKernel(int choice) {
+    Isa isa = detectIsa();
+#ifndef NUMERICAL_X86_KERNELS
+    (void)isa; // Only the scalar kernels exist on this platform
+#endif
+
+    // sin, e^x, ln and x*sin(x) keep the libm implementations so that batch
+    // and scalar evaluation agree bit for bit; they still avoid the per-sample
+    // indirect call of Function::evaluate(double).
+    switch (choice) {
+        case 2:
+#ifdef NUMERICAL_X86_KERNELS
+            if (isa == Isa::Avx512) return squareAvx512;
+            if (isa == Isa::Avx2) return squareAvx2;
+#endif
+            return squareScalar;
+        case 3:
+            return sinScalar;
+        case 4:
+            return expScalar;
+        case 5:
+#ifdef NUMERICAL_X86_KERNELS
+            if (isa == Isa::Avx512) return inverseSqrtAvx512;
+            if (isa == Isa::Avx2) return inverseSqrtAvx2;
+#endif
+            return inverseSqrtScalar;
+        case 6:
+            return logScalar;
+        case 7:
+            return xSinScalar;
+        case 8:
+#ifdef NUMERICAL_X86_KERNELS
+            if (isa == Isa::Avx512) return sqrtAvx512;
+            if (isa == Isa::Avx2) return sqrtAvx2;
+#endif
+            return sqrtScalar;
+        default: // 1/(1+x), also used for invalid choices
+#ifdef NUMERICAL_X86_KERNELS
+            if (isa == Isa::Avx512) return reciprocalAvx512;
+            if (isa == Isa::Avx2) return reciprocalAvx2;
+#endif
+            return reciprocalScalar;
+    }
+}
+
+const char* instructionSet() {
+    switch (detectIsa()) {
+        case Isa::Avx512:
+            return "AVX-512";
+        case Isa::Avx2:
+            return "AVX2";
+        default:
+            return "scalar";
+    }
+}
+
+} // namespace kernels
+} // namespace numerical
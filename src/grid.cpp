@@ -0,0 +1,158 @@
+#include "../include/grid.h"
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+void checkBounds(double a, double b, long long n) {
+    if (!(b > a)) {
+        throw std::invalid_argument("Upper bound must be greater than lower bound");
+    }
+    if (n < 1) {
+        throw std::invalid_argument("Number of intervals must be positive");
+    }
+}
+
+// Maps the fractions t_i (0 = a, 1 = b, increasing) onto [a, b], mirrored when grading toward b
+std::vector<double> mapFractions(double a, double b, const std::vector<double>& t, Grid::Endpoint toward) {
+    const std::size_t n = t.size() - 1;
+    std::vector<double> points(t.size());
+    for (std::size_t i = 0; i <= n; ++i) {
+        points[i] = toward == Grid::Endpoint::Lower ? a + (b - a) * t[i] : b - (b - a) * t[n - i];
+    }
+    // Keep the bounds exact
+    points.front() = a;
+    points.back() = b;
+    return points;
+}
+
+std::string endpointName(Grid::Endpoint toward) {
+    return toward == Grid::Endpoint::Lower ? "a" : "b";
+}
+
+} // namespace
+
+Grid Grid::uniform(double a, double b, long long n) {
+    checkBounds(a, b, n);
+    std::vector<double> points(static_cast<std::size_t>(n) + 1);
+    double h = (b - a) / n;
+    for (long long i = 0; i <= n; ++i) {
+        points[i] = a + i * h;
+    }
+    points.back() = b;
+    return Grid(std::move(points), "uniform");
+}
+
+Grid Grid::chebyshev(double a, double b, long long n) {
+    checkBounds(a, b, n);
+    std::vector<double> t(static_cast<std::size_t>(n) + 1);
+    for (long long i = 0; i <= n; ++i) {
+        // (1 - cos(pi*i/n)) / 2, without the cancellation near a
+        const double s = std::sin(PI * i / (2.0 * n));
+        t[i] = s * s;
+    }
+    return Grid(mapFractions(a, b, t, Endpoint::Lower), "Chebyshev");
+}
+
+Grid Grid::graded(double a, double b, long long n, double exponent, Endpoint toward) {
+    checkBounds(a, b, n);
+    if (!(exponent > 0.0)) {
+        throw std::invalid_argument("The grading exponent must be positive");
+    }
+    std::vector<double> t(static_cast<std::size_t>(n) + 1);
+    for (long long i = 0; i <= n; ++i) {
+        t[i] = std::pow(static_cast<double>(i) / n, exponent);
+    }
+    std::ostringstream description;
+    description << "graded toward " << endpointName(toward) << ", exponent " << exponent;
+    return Grid(mapFractions(a, b, t, toward), description.str());
+}
+
+Grid Grid::geometric(double a, double b, long long n, double ratio, Endpoint toward) {
+    checkBounds(a, b, n);
+    if (!(ratio >= 1.0)) {
+        throw std::invalid_argument("The geometric ratio must be at least 1");
+    }
+    std::vector<double> t(static_cast<std::size_t>(n) + 1);
+    const double logRatio = std::log(ratio);
+    for (long long i = 0; i <= n; ++i) {
+        // (ratio^i - 1) / (ratio^n - 1), written so that large n does not overflow
+        t[i] = logRatio == 0.0 ? static_cast<double>(i) / n
+                               : std::exp((i - n) * logRatio) * std::expm1(-i * logRatio) / std::expm1(-n * logRatio);
+    }
+    std::ostringstream description;
+    description << "geometric toward " << endpointName(toward) << ", ratio " << ratio;
+    return Grid(mapFractions(a, b, t, toward), description.str());
+}
+
+Grid::Grid(std::vector<double> points, std::string description)
+    : points(std::move(points)), description(std::move(description)) {
+    const std::size_t count = this->points.size();
+    if (count < 2) {
+        throw std::invalid_argument("A grid needs at least two points");
+    }
+    for (std::size_t i = 1; i < count; ++i) {
+        if (!(this->points[i] > this->points[i - 1])) {
+            throw std::invalid_argument("Grid points must increase strictly");
+        }
+    }
+
+    // Trapezoidal weights: each interval gives half its width to both ends
+    trapezoidWeights.assign(count, 0.0);
+    for (std::size_t i = 1; i < count; ++i) {
+        double width = this->points[i] - this->points[i - 1];
+        trapezoidWeights[i - 1] += width / 2;
+        trapezoidWeights[i] += width / 2;
+    }
+
+    // Simpson weights: the quadratic through each pair of intervals of widths h0 and h1
+    if ((count - 1) % 2 == 0) {
+        simpsonWeights.assign(count, 0.0);
+        for (std::size_t i = 2; i < count; i += 2) {
+            double h0 = this->points[i - 1] - this->points[i - 2];
+            double h1 = this->points[i] - this->points[i - 1];
+            double sum = h0 + h1;
+            simpsonWeights[i - 2] += sum / 6 * (2 - h1 / h0);
+            simpsonWeights[i - 1] += sum * sum * sum / (6 * h0 * h1);
+            simpsonWeights[i] += sum / 6 * (2 - h0 / h1);
+        }
+    }
+}
+
+long long Grid::getIntervals() const {
+    return static_cast<long long>(points.size()) - 1;
+}
+
+double Grid::getLowerBound() const {
+    return points.front();
+}
+
+double Grid::getUpperBound() const {
+    return points.back();
+}
+
+const std::vector<double>& Grid::getPoints() const {
+    return points;
+}
+
+const std::vector<double>& Grid::getWeights(int panel) const {
+    if (panel == 1) {
+        return trapezoidWeights;
+    }
+    if (panel == 2 && !simpsonWeights.empty()) {
+        return simpsonWeights;
+    }
+    throw std::invalid_argument(panel == 2 ? "Simpson's 1/3 rule requires an even number of intervals"
+                                           : "Grids support the trapezoidal and Simpson 1/3 rules only");
+}
+
+std::string Grid::getDescription() const {
+    return description;
+}
+
+} // namespace numerical
@@ -1,13 +1,66 @@
 #include "../include/integrator.h"
+#include "../include/evaluation.h"
+#include "../include/methods/inline_rules.h"
+#include "../include/sample_file.h"
+#include "../include/thread_pool.h"
 #include "../include/utils.h"
-#include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace numerical {
 
 Integrator::Integrator(const Input& input, const Function& function)
-    : input(input), function(function), result(0.0) {
+    : input(input), function(function), result(0.0), evaluations(0), gridSampled(false),
+      summation(Summation::Naive), observer(nullptr), sampleCache(nullptr), cachedSamples(nullptr),
+      cachedStride(1), grid(nullptr) {
+}
+
+IntegrationResult Integrator::integrate(IntegrationObserver* observer) {
+    this->observer = observer;
+    bool showSteps = observer != nullptr && observer->wantsSteps();
+    
+    IntegrationResult outcome;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        outcome.value = compute(showSteps);
+    } catch (...) {
+        this->observer = nullptr;
+        throw;
+    }
+    outcome.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    this->observer = nullptr;
+    
+    outcome.applicable = isApplicable();
+    outcome.errorEstimate = getErrorEstimate();
+    outcome.evaluations = evaluations;
+    return outcome;
+}
+
+bool Integrator::isApplicable() const {
+    return true;
+}
+
+double Integrator::getErrorEstimate() const {
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+StepWriter Integrator::step() const {
+    return StepWriter(observer);
+}
+
+void Integrator::pause(int milliseconds) const {
+    if (observer) {
+        observer->onPause(milliseconds);
+    }
+}
+
+void Integrator::reportNotApplicable(const std::string& reason) const {
+    if (observer) {
+        observer->onNotApplicable(reason);
+    }
 }
 
 double Integrator::calculateStepSize() const {
@@ -15,49 +68,310 @@ double Integrator::calculateStepSize() const {
 }
 
 void Integrator::generatePoints() {
-    double h = calculateStepSize();
     int n = input.getIntervals();
-    double a = input.getLowerBound();
     
     xValues.resize(n + 1);
     yValues.resize(n + 1);
     
+    double h = calculateStepSize();
+    double a = input.getLowerBound();
     for (int i = 0; i <= n; ++i) {
         xValues[i] = a + i * h;
-        try {
-            yValues[i] = function.evaluate(xValues[i]);
-        } catch (const std::exception& e) {
-            std::cerr << "Error evaluating function at x = " << xValues[i] 
-                      << ": " << e.what() << std::endl;
-            yValues[i] = 0.0; // Set to 0 on error
+    }
+    long long stride = 1;
+    const double* grid = lookupCachedGrid(n, stride, false);
+    if (grid) {
+        for (int i = 0; i <= n; ++i) {
+            yValues[i] = grid[i * stride];
         }
+        return;
+    }
+    for (int i = 0; i <= n; i += BATCH_SIZE) {
+        evaluateBatch(&xValues[i], &yValues[i], std::min(BATCH_SIZE, n + 1 - i));
+    }
+}
+
+void Integrator::preparePoints(bool storePoints) {
+    gridSampled = true;
+    cachedSamples = nullptr;
+    if (storePoints) {
+        generatePoints();
+    } else {
+        // Release any previous grid so that sampleAt() streams in O(1) memory
+        std::vector<double>().swap(xValues);
+        std::vector<double>().swap(yValues);
+        cachedSamples = lookupCachedGrid(input.getIntervals(), cachedStride, true);
     }
 }
 
-void Integrator::displayIntermediateValues() const {
-    std::cout << "\nStep size h = " << calculateStepSize() << std::endl;
-    std::cout << std::setw(5) << "i" << std::setw(15) << "x_i" 
-              << std::setw(15) << "f(x_i)" << std::endl;
-    std::cout << std::string(35, '-') << std::endl;
+const double* Integrator::lookupCachedGrid(int n, long long& stride, bool fill) {
+    if (!sampleCache) {
+        return nullptr;
+    }
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+    const double* values = sampleCache->find(function, a, b, n, stride);
+    if (values || !fill || !sampleCache->canStore(n)) {
+        return values;
+    }
     
-    for (size_t i = 0; i < xValues.size(); ++i) {
-        std::cout << std::setw(5) << i 
-                  << std::setw(15) << utils::formatNumber(xValues[i], 6)
-                  << std::setw(15) << utils::formatNumber(yValues[i], 6) 
-                  << std::endl;
-        
-        // Add a small delay for better visualization
-        if (i % 5 == 4) {
-            utils::sleep(100);
+    // Evaluate the whole grid once, at the same points as sampleRange()
+    std::vector<double> grid(static_cast<std::size_t>(n) + 1);
+    const double h = (b - a) / n;
+    forEachBlock(n / BLOCK_INTERVALS + 1, [&](std::size_t block) {
+        int begin = static_cast<int>(block) * BLOCK_INTERVALS;
+        int end = std::min(begin + BLOCK_INTERVALS, n + 1);
+        double x[BATCH_SIZE];
+        for (int start = begin; start < end; start += BATCH_SIZE) {
+            int count = std::min(BATCH_SIZE, end - start);
+            for (int i = 0; i < count; ++i) {
+                x[i] = a + (start + i) * h;
+            }
+            evaluateBatch(x, &grid[start], count);
+        }
+    });
+    stride = 1;
+    return sampleCache->store(function, a, b, n, std::move(grid));
+}
+
+double Integrator::sampleAt(int i) const {
+    if (!yValues.empty()) {
+        return yValues[i];
+    }
+    if (cachedSamples) {
+        return cachedSamples[i * cachedStride];
+    }
+    
+    return evaluatePoint(input.getLowerBound() + i * calculateStepSize());
+}
+
+double Integrator::evaluatePoint(double x) const {
+    return evaluateOrZero(function, x, observer);
+}
+
+void Integrator::evaluateBatch(const double* x, double* y, int count) const {
+    evaluateOrZero(function, x, y, count, observer);
+}
+
+void Integrator::sampleRange(int begin, int count, double* y) const {
+    if (!yValues.empty()) {
+        std::copy(yValues.begin() + begin, yValues.begin() + begin + count, y);
+        return;
+    }
+    if (cachedSamples) {
+        for (int i = 0; i < count; ++i) {
+            y[i] = cachedSamples[(begin + i) * cachedStride];
         }
+        return;
+    }
+    
+    double x[BATCH_SIZE];
+    double a = input.getLowerBound();
+    double h = calculateStepSize();
+    for (int i = 0; i < count; ++i) {
+        x[i] = a + (begin + i) * h;
+    }
+    evaluateBatch(x, y, count);
+}
+
+std::array<double, 4> Integrator::sumInteriorByResidue(int period) const {
+    static_assert(rules::BLOCK_INTERVALS == BLOCK_INTERVALS,
+                  "numerical::integrate() must block the grid like Integrator");
+    static_assert(BLOCK_INTERVALS % MAX_INTERLEAVED_LANES == 0 && BLOCK_INTERVALS % 8 == 0,
+                  "Blocks must start on lane 0");
+    
+    const int n = input.getIntervals();
+    const int blockCount = n / BLOCK_INTERVALS + 1;
+    std::vector<std::array<Accumulator, 4>> blockSums(blockCount);
+    
+    auto sumBlock = [&](std::size_t block) {
+        std::array<Accumulator, 4> sums;
+        sums.fill(Accumulator(summation));
+        long long first = static_cast<long long>(block) * BLOCK_INTERVALS;
+        int begin = static_cast<int>(std::max(first, 1LL));
+        int end = static_cast<int>(std::min(first + BLOCK_INTERVALS, static_cast<long long>(n)));
+        double y[BATCH_SIZE];
+        if (summation == Summation::Naive) {
+            // Sample i goes to lane (i - first) % laneCount, and the lane
+            // count is a multiple of the period, so every lane holds a single
+            // residue class and the whole block is one branch-free SIMD walk
+            const int laneCount = rules::laneCount(period);
+            double lanes[MAX_INTERLEAVED_LANES] = {};
+            for (int start = begin; start < end; start += BATCH_SIZE) {
+                int count = std::min(BATCH_SIZE, end - start);
+                sampleRange(start, count, y);
+                addInterleaved(y, count, static_cast<int>((start - first) % laneCount), lanes, laneCount);
+            }
+            for (int r = 0; r < period; ++r) {
+                for (int lane = r; lane < laneCount; lane += period) {
+                    sums[r].add(lanes[lane]);
+                }
+            }
+        } else {
+            for (int start = begin; start < end; start += BATCH_SIZE) {
+                int count = std::min(BATCH_SIZE, end - start);
+                sampleRange(start, count, y);
+                // y[k] belongs to class (start + k) % period; add each class as a strided run
+                for (int k = 0; k < period && k < count; ++k) {
+                    sums[(start + k) % period].add(y + k, (count - k + period - 1) / period, period);
+                }
+            }
+        }
+        blockSums[block] = sums;
+    };
+    
+    forEachBlock(blockCount, sumBlock);
+    
+    // Combine the block sums in a fixed order, independent of the thread count
+    std::array<Accumulator, 4> totals;
+    totals.fill(Accumulator(summation));
+    for (const auto& blockSum : blockSums) {
+        for (int r = 0; r < period; ++r) {
+            totals[r].add(blockSum[r]);
+        }
+    }
+    std::array<double, 4> sums = {0.0, 0.0, 0.0, 0.0};
+    for (int r = 0; r < period; ++r) {
+        sums[r] = totals[r].total();
+    }
+    return sums;
+}
+
+double Integrator::sumStrided(double origin, double step, long long first, long long stride,
+                              long long count, const double* samples, long long sampleStride) const {
+    const long long blockCount = (count + BLOCK_INTERVALS - 1) / BLOCK_INTERVALS;
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    
+    auto sumBlock = [&](std::size_t block) {
+        long long begin = static_cast<long long>(block) * BLOCK_INTERVALS;
+        long long end = std::min(begin + BLOCK_INTERVALS, count);
+        double x[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        Accumulator sum(summation);
+        for (long long start = begin; start < end; start += BATCH_SIZE) {
+            int batch = static_cast<int>(std::min(static_cast<long long>(BATCH_SIZE), end - start));
+            if (samples) {
+                for (int k = 0; k < batch; ++k) {
+                    y[k] = samples[(first + stride * (start + k)) * sampleStride];
+                }
+            } else {
+                for (int k = 0; k < batch; ++k) {
+                    x[k] = origin + (first + stride * (start + k)) * step;
+                }
+                evaluateBatch(x, y, batch);
+            }
+            sum.add(y, batch);
+        }
+        blockSums[block] = sum;
+    };
+    
+    forEachBlock(blockCount, sumBlock);
+    
+    Accumulator sum(summation);
+    for (const Accumulator& blockSum : blockSums) {
+        sum.add(blockSum);
+    }
+    return sum.total();
+}
+
+double Integrator::sumWeighted(const double* x, const double* weights, long long count) const {
+    const long long blockCount = (count + BLOCK_INTERVALS - 1) / BLOCK_INTERVALS;
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    
+    auto sumBlock = [&](std::size_t block) {
+        long long begin = static_cast<long long>(block) * BLOCK_INTERVALS;
+        long long end = std::min(begin + BLOCK_INTERVALS, count);
+        double y[BATCH_SIZE];
+        Accumulator sum(summation);
+        for (long long start = begin; start < end; start += BATCH_SIZE) {
+            int batch = static_cast<int>(std::min(static_cast<long long>(BATCH_SIZE), end - start));
+            evaluateBatch(x + start, y, batch);
+            for (int k = 0; k < batch; ++k) {
+                y[k] *= weights[start + k];
+            }
+            sum.add(y, batch);
+        }
+        blockSums[block] = sum;
+    };
+    
+    forEachBlock(blockCount, sumBlock);
+    
+    Accumulator sum(summation);
+    for (const Accumulator& blockSum : blockSums) {
+        sum.add(blockSum);
+    }
+    return sum.total();
+}
+
+double Integrator::computeOnGrid(int panel, bool showSteps) {
+    const std::vector<double>& points = grid->getPoints();
+    const std::vector<double>& weights = grid->getWeights(panel);
+    
+    if (showSteps) {
+        step() << "\nPerforming integration using the " << getMethodName() << " on a " << grid->getDescription()
+               << " grid";
+        step() << "Points: " << points.size() << " from " << grid->getLowerBound() << " to " << grid->getUpperBound();
+        double smallest = points[1] - points[0];
+        double largest = smallest;
+        for (std::size_t i = 2; i < points.size(); ++i) {
+            smallest = std::min(smallest, points[i] - points[i - 1]);
+            largest = std::max(largest, points[i] - points[i - 1]);
+        }
+        step() << "Smallest interval: " << smallest << ", largest: " << largest;
+        step() << "\nApplying the precomputed weights: sum(w_i * f(x_i))";
+    }
+    
+    result = sumWeighted(points.data(), weights.data(), static_cast<long long>(points.size()));
+    evaluations = static_cast<long long>(points.size());
+    
+    if (showSteps) {
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+void Integrator::forEachBlock(long long blockCount, const std::function<void(std::size_t)>& sumBlock) const {
+    blocks.run(blockCount, sumBlock);
+}
+
+void Integrator::reportSamples() const {
+    if (observer) {
+        observer->onSamples(xValues, yValues, calculateStepSize());
     }
-    std::cout << std::endl;
 }
 
 double Integrator::getResult() const {
     return result;
 }
 
+long long Integrator::getEvaluationCount() const {
+    return evaluations;
+}
+
+void Integrator::setThreadCount(unsigned threads) {
+    blocks.setThreadCount(threads);
+}
+
+unsigned Integrator::getThreadCount() const {
+    return blocks.getThreadCount();
+}
+
+void Integrator::setSummation(Summation method) {
+    summation = method;
+}
+
+Summation Integrator::getSummation() const {
+    return summation;
+}
+
+void Integrator::setSampleCache(SampleCache* cache) {
+    sampleCache = cache;
+}
+
+void Integrator::setGrid(const Grid* grid) {
+    this->grid = grid;
+}
+
 bool Integrator::saveResultToFile(const std::string& filename) const {
     try {
         std::ofstream file(filename);
@@ -77,8 +391,16 @@ bool Integrator::saveResultToFile(const std::string& filename) const {
         // Save intermediate values
         file << "# Intermediate Values\n";
         file << "i,x_i,f(x_i)\n";
-        for (size_t i = 0; i < xValues.size(); ++i) {
-            file << i << "," << xValues[i] << "," << yValues[i] << "\n";
+        if (!xValues.empty()) {
+            for (size_t i = 0; i < xValues.size(); ++i) {
+                file << i << "," << xValues[i] << "," << yValues[i] << "\n";
+            }
+        } else if (gridSampled) {
+            // Points were streamed during integrate(); re-evaluate them while writing
+            double h = calculateStepSize();
+            for (int i = 0; i <= input.getIntervals(); ++i) {
+                file << i << "," << (input.getLowerBound() + i * h) << "," << sampleAt(i) << "\n";
+            }
         }
         
         file.close();
@@ -88,4 +410,28 @@ bool Integrator::saveResultToFile(const std::string& filename) const {
     }
 }
 
+bool Integrator::saveSamplesToFile(const std::string& filename, std::string& error) const {
+    SampleFile::Header header;
+    header.method = getMethodName();
+    header.description = function.getDescription();
+    header.functionChoice = function.getChoice();
+    header.expression = function.getExpression();
+    header.lowerBound = input.getLowerBound();
+    header.upperBound = input.getUpperBound();
+    header.intervals = input.getIntervals();
+    
+    auto produce = [this](long long begin, std::size_t count, double* values) {
+        const long long blockCount = (static_cast<long long>(count) + BLOCK_INTERVALS - 1) / BLOCK_INTERVALS;
+        forEachBlock(blockCount, [&](std::size_t block) {
+            long long first = static_cast<long long>(block) * BLOCK_INTERVALS;
+            long long last = std::min(first + BLOCK_INTERVALS, static_cast<long long>(count));
+            for (long long start = first; start < last; start += BATCH_SIZE) {
+                int batch = static_cast<int>(std::min(static_cast<long long>(BATCH_SIZE), last - start));
+                sampleRange(static_cast<int>(begin + start), batch, values + start);
+            }
+        });
+    };
+    return SampleFile::write(filename, header, produce, error);
+}
+
 } // namespace numerical
\ No newline at end of file
@@ -5,13 +5,24 @@
 #include "../include/methods/simpson38.h"
 #include "../include/methods/boole.h"
 #include "../include/methods/romberg.h"
+#include "../include/methods/adaptive.h"
+#include "../include/methods/gauss_legendre.h"
+#include "../include/methods/tanh_sinh.h"
+#include "../include/methods/monte_carlo.h"
+#include "../include/methods/auto_integrator.h"
+#include "../include/console_utils.h"
 #include "../include/utils.h"
+#include "../include/cli.h"
+#include "../include/console_observer.h"
+#include "../include/sample_cache.h"
+#include "../include/sample_file.h"
 #include <iostream>
 #include <memory>
 #include <vector>
 #include <iomanip>
 #include <algorithm>
 #include <fstream>
+#include <limits>
 
 using namespace numerical;
 
@@ -19,10 +30,16 @@ using namespace numerical;
 void runIntegration();
 void compareAllMethods();
 void loadPreviousResult();
+void replaySamples(const std::string& filename);
 void showHelp();
 void showAbout();
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Any command-line flag selects the non-interactive mode
+    if (argc > 1) {
+        return cli::run(argc, argv);
+    }
+    
     // Display welcome message
     std::cout << "=====================================================\n";
     std::cout << "          NUMERICAL INTEGRATION CALCULATOR          \n";
@@ -91,12 +108,17 @@ void runIntegration() {
         "Simpson's 3/8 Rule",
         "Boole's Rule",
         "Romberg Integration",
+        "Adaptive Gauss-Kronrod",
+        "Gauss-Legendre",
+        "Tanh-Sinh (double exponential)",
+        "Monte Carlo / Quasi-Monte Carlo",
+        "Automatic selection",
         "Back to Main Menu"
     };
     
     int methodChoice = utils::getMenuChoice("Select Integration Method", methodOptions);
     
-    if (methodChoice == 6) {
+    if (methodChoice == 11) {
         return; // Return to main menu
     }
     
@@ -118,15 +140,76 @@ void runIntegration() {
             break;
         case 5: {
             int order = 4; // Default order
-            std::cout << "Enter the order for Romberg integration (1-10): ";
+            std::cout << "Enter the order for Romberg integration (1-" << RombergIntegration::MAX_ORDER << "): ";
             std::cin >> order;
-            if (order < 1 || order > 10) {
+            if (order < 1 || order > RombergIntegration::MAX_ORDER) {
                 order = 4;
                 std::cout << "Invalid order. Using default order of 4." << std::endl;
             }
             integrator = std::make_unique<RombergIntegration>(input, function, order);
             break;
         }
+        case 6: {
+            double tolerance = 1e-10; // Default tolerance
+            std::cout << "Enter the error tolerance for adaptive integration (e.g. 1e-10): ";
+            std::cin >> tolerance;
+            if (std::cin.fail() || tolerance <= 0.0) {
+                std::cin.clear();
+                tolerance = 1e-10;
+                std::cout << "Invalid tolerance. Using default tolerance of 1e-10." << std::endl;
+            }
+            integrator = std::make_unique<AdaptiveQuadrature>(input, function, tolerance, tolerance);
+            break;
+        }
+        case 7: {
+            int points = 8; // Default points per panel
+            std::cout << "Enter the number of points per panel (1-" << GaussLegendre::MAX_POINTS << "): ";
+            std::cin >> points;
+            if (std::cin.fail() || points < 1 || points > GaussLegendre::MAX_POINTS) {
+                std::cin.clear();
+                points = 8;
+                std::cout << "Invalid number of points. Using default of 8." << std::endl;
+            }
+            integrator = std::make_unique<GaussLegendre>(input, function, points);
+            break;
+        }
+        case 8: {
+            double tolerance = 1e-10; // Default tolerance
+            std::cout << "Enter the error tolerance for tanh-sinh integration (e.g. 1e-10): ";
+            std::cin >> tolerance;
+            if (std::cin.fail() || tolerance <= 0.0) {
+                std::cin.clear();
+                tolerance = 1e-10;
+                std::cout << "Invalid tolerance. Using default tolerance of 1e-10." << std::endl;
+            }
+            integrator = std::make_unique<TanhSinh>(input, function, tolerance);
+            break;
+        }
+        case 9: {
+            int sampling = 2; // Default: Sobol
+            std::cout << "Enter the sample points (1=pseudo-random, 2=Sobol, 3=Halton): ";
+            std::cin >> sampling;
+            if (std::cin.fail() || sampling < 1 || sampling > 3) {
+                std::cin.clear();
+                sampling = 2;
+                std::cout << "Invalid choice. Using Sobol points." << std::endl;
+            }
+            const Sampling methods[] = {Sampling::Pseudo, Sampling::Sobol, Sampling::Halton};
+            integrator = std::make_unique<MonteCarlo>(input, function, methods[sampling - 1]);
+            break;
+        }
+        case 10: {
+            double tolerance = 1e-10; // Default tolerance
+            std::cout << "Enter the error tolerance for automatic selection (e.g. 1e-10): ";
+            std::cin >> tolerance;
+            if (std::cin.fail() || tolerance <= 0.0) {
+                std::cin.clear();
+                tolerance = 1e-10;
+                std::cout << "Invalid tolerance. Using default tolerance of 1e-10." << std::endl;
+            }
+            integrator = std::make_unique<AutoIntegrator>(input, function, tolerance);
+            break;
+        }
     }
     
     // Perform integration
@@ -137,7 +220,8 @@ void runIntegration() {
     std::cout << "Show calculation steps? (1=Yes, 0=No): ";
     std::cin >> showSteps;
     
-    double result = integrator->calculate(showSteps);
+    ConsoleObserver console(showSteps);
+    double result = integrator->integrate(&console).value;
     
     // Display the result
     std::cout << "\n===========================================\n";
@@ -145,20 +229,24 @@ void runIntegration() {
     std::cout << "from " << input.getLowerBound() << " to " << input.getUpperBound() << "\n";
     std::cout << "using " << integrator->getMethodName() << ":\n\n";
     std::cout << "Result = " << result << "\n";
+    std::cout << "Function evaluations = " << integrator->getEvaluationCount() << "\n";
     std::cout << "===========================================\n";
     
     // Save result to file
-    std::cout << "\nDo you want to save the result to a file? (1=Yes, 0=No): ";
-    bool saveToFile;
+    std::cout << "\nDo you want to save the result to a file? (1=Text, 2=Binary samples, 0=No): ";
+    int saveToFile;
     std::cin >> saveToFile;
     
-    if (saveToFile) {
-        std::string filename = "integration_result_" + utils::getTimestamp() + ".txt";
+    if (saveToFile == 1 || saveToFile == 2) {
+        std::string filename = "integration_result_" + utils::getTimestamp() + (saveToFile == 1 ? ".txt" : ".samples");
         // Replace spaces and colons in filename
         std::replace(filename.begin(), filename.end(), ' ', '_');
         std::replace(filename.begin(), filename.end(), ':', '-');
         
-        if (integrator->saveResultToFile(filename)) {
+        std::string error;
+        bool saved = saveToFile == 1 ? integrator->saveResultToFile(filename)
+                                     : integrator->saveSamplesToFile(filename, error);
+        if (saved) {
             std::cout << "Result saved to " << filename << std::endl;
         } else {
             std::cout << "Failed to save result to file." << std::endl;
@@ -194,14 +282,30 @@ void compareAllMethods() {
     
     std::vector<double> results;
     std::vector<std::string> methodNames;
+    ConsoleObserver console(false); // Only report undefined values
+    
+    // The methods sample the same grid, so each point is evaluated only once
+    SampleCache cache;
+    long long requested = 0;
     
     for (const auto& integrator : integrators) {
         std::cout << "- " << integrator->getMethodName() << "... ";
-        double result = integrator->calculate(false);
+        integrator->setSampleCache(&cache);
+        double result = integrator->integrate(&console).value;
         results.push_back(result);
         methodNames.push_back(integrator->getMethodName());
+        requested += integrator->getEvaluationCount();
         std::cout << "Done\n";
     }
+    std::cout << "\nFunction values used: " << requested << ", grid points evaluated through the shared cache: "
+              << cache.getEvaluationCount() << "\n";
+    
+    // The reference is the automatically chosen method at a tight tolerance,
+    // which suits the integrand better than any fixed rule
+    AutoIntegrator reference(input, function, 1e-12);
+    std::cout << "- Reference (automatic selection)... ";
+    double referenceResult = reference.integrate(&console).value;
+    std::cout << "Done\n";
     
     // Display comparison table
     std::cout << "\nComparison of Integration Methods:\n";
@@ -214,13 +318,12 @@ void compareAllMethods() {
                   << std::right << std::setw(20) << std::fixed << std::setprecision(10) << results[i] << std::endl;
     }
     
-    // Find the method with the most accurate result (assuming higher-order methods are more accurate)
-    double referenceResult = results.back(); // Romberg Integration result
-    std::cout << "\nAssuming Romberg Integration as reference:\n";
+    std::cout << "\nReference: " << reference.getMethodName() << " = " << std::setprecision(15) << referenceResult
+              << " (" << reference.getEvaluationCount() << " evaluations)\n";
     std::cout << std::left << std::setw(25) << "Method" << std::right << std::setw(20) << "Absolute Error" << std::endl;
     std::cout << std::string(45, '-') << std::endl;
     
-    for (size_t i = 0; i < results.size() - 1; ++i) {
+    for (size_t i = 0; i < results.size(); ++i) {
         double error = std::abs(results[i] - referenceResult);
         std::cout << std::left << std::setw(25) << methodNames[i] 
                   << std::right << std::setw(20) << std::scientific << std::setprecision(6) << error << std::endl;
@@ -229,6 +332,59 @@ void compareAllMethods() {
     utils::waitForKeyPress();
 }
 
+void replaySamples(const std::string& filename) {
+    SampleFile samples;
+    std::string error;
+    if (!samples.open(filename, error)) {
+        std::cout << "Error: " << error << std::endl;
+        return;
+    }
+    const SampleFile::Header& header = samples.getHeader();
+    if (header.intervals > std::numeric_limits<int>::max()) {
+        std::cout << "Error: too many intervals to integrate." << std::endl;
+        return;
+    }
+    
+    std::cout << "\nStored samples\n";
+    std::cout << "Method: " << header.method << "\n";
+    std::cout << "Function: " << header.description << "\n";
+    std::cout << "Bounds: [" << header.lowerBound << ", " << header.upperBound << "]\n";
+    std::cout << "Intervals: " << header.intervals << "\n";
+    
+    try {
+        int intervals = static_cast<int>(header.intervals);
+        int choice = header.expression.empty() ? header.functionChoice : 1;
+        Input input(header.lowerBound, header.upperBound, intervals, choice);
+        Function function = header.expression.empty() ? Function(choice) : Function(header.expression);
+        
+        // Every rule reads the stored values instead of evaluating the function
+        SampleCache cache;
+        cache.attach(function, header.lowerBound, header.upperBound, intervals, samples.getValues());
+        
+        std::vector<std::unique_ptr<Integrator>> integrators;
+        integrators.push_back(std::make_unique<TrapezoidalRule>(input, function));
+        integrators.push_back(std::make_unique<SimpsonOneThird>(input, function));
+        integrators.push_back(std::make_unique<SimpsonThreeEighth>(input, function));
+        integrators.push_back(std::make_unique<BooleRule>(input, function));
+        
+        std::cout << "\nRe-integrating the stored samples:\n";
+        std::cout << std::left << std::setw(25) << "Method" << std::right << std::setw(20) << "Result" << std::endl;
+        std::cout << std::string(45, '-') << std::endl;
+        for (const auto& integrator : integrators) {
+            if (!integrator->isApplicable()) {
+                continue;
+            }
+            integrator->setSampleCache(&cache);
+            double result = integrator->integrate().value;
+            std::cout << std::left << std::setw(25) << integrator->getMethodName()
+                      << std::right << std::setw(20) << std::fixed << std::setprecision(10) << result << std::endl;
+        }
+        std::cout << std::defaultfloat;
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
+
 void loadPreviousResult() {
     utils::clearScreen();
     std::cout << "Load Previous Results\n";
@@ -247,6 +403,12 @@ void loadPreviousResult() {
         return;
     }
     
+    if (SampleFile::isSampleFile(filename)) {
+        replaySamples(filename);
+        utils::waitForKeyPress();
+        return;
+    }
+    
     // Simple file reader
     std::ifstream file(filename);
     if (file.is_open()) {
@@ -291,6 +453,21 @@ void showHelp() {
     std::cout << "5. Romberg Integration: Uses extrapolation to improve accuracy\n";
     std::cout << "   Note: Higher order generally gives more accurate results\n\n";
     
+    std::cout << "6. Adaptive Gauss-Kronrod: Subdivides where the error estimate is largest\n";
+    std::cout << "   Note: Uses an error tolerance instead of the number of intervals\n\n";
+    
+    std::cout << "7. Gauss-Legendre: Applies a p-point Gauss rule to each interval\n";
+    std::cout << "   Note: Exact for polynomials of degree 2p-1; uses p evaluations per interval\n\n";
+    
+    std::cout << "8. Tanh-Sinh: Trapezoidal rule after a double exponential substitution\n";
+    std::cout << "   Note: Handles endpoint singularities; uses an error tolerance instead of intervals\n\n";
+    
+    std::cout << "9. Monte Carlo: Averages f at random or quasi-random (Sobol, Halton) points\n";
+    std::cout << "   Note: The number of intervals is the number of points; reports a standard error\n\n";
+    
+    std::cout << "10. Automatic selection: Probes the integrand and picks the cheapest method for a tolerance\n";
+    std::cout << "    Note: Chooses among Newton-Cotes, Romberg, Gauss-Legendre, adaptive and tanh-sinh\n\n";
+    
     std::cout << "How to use the program:\n";
     std::cout << "1. Select 'Perform integration' from the main menu\n";
     std::cout << "2. Choose a function from the available options\n";
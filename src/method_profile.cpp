@@ -0,0 +1,107 @@
+#include "../include/method_profile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace numerical {
+
+namespace {
+
+// Fields are separated by tabs, so tabs and line breaks inside them become spaces
+std::string clean(std::string text) {
+    std::replace(text.begin(), text.end(), '\t', ' ');
+    std::replace(text.begin(), text.end(), '\n', ' ');
+    std::replace(text.begin(), text.end(), '\r', ' ');
+    return text;
+}
+
+} // namespace
+
+bool MethodProfile::load(const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        if (errno == ENOENT) {
+            return true; // No profile yet
+        }
+        error = "could not open " + filename + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // key, method, intervals, order, predicted evaluations, reason
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 5) {
+            continue;
+        }
+        try {
+            MethodDecision decision;
+            decision.method = fields[1];
+            decision.intervals = std::stoi(fields[2]);
+            decision.order = std::stoi(fields[3]);
+            decision.predictedEvaluations = std::stoll(fields[4]);
+            decision.reason = fields.size() > 5 ? fields[5] : std::string();
+            decisions[fields[0]] = decision;
+        } catch (const std::exception&) {
+            // Skip damaged lines
+        }
+    }
+    if (file.bad()) {
+        error = "could not read " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool MethodProfile::save(const std::string& filename, std::string& error) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        error = "could not write " + filename;
+        return false;
+    }
+    file << "# problem\tmethod\tintervals\torder\tpredicted evaluations\treason\n";
+    for (const auto& entry : decisions) {
+        const MethodDecision& decision = entry.second;
+        file << clean(entry.first) << '\t' << clean(decision.method) << '\t' << decision.intervals << '\t'
+             << decision.order << '\t' << decision.predictedEvaluations << '\t' << clean(decision.reason) << '\n';
+    }
+    if (!file) {
+        error = "could not write " + filename;
+        return false;
+    }
+    return true;
+}
+
+const MethodDecision* MethodProfile::find(const std::string& key) const {
+    auto it = decisions.find(clean(key));
+    return it == decisions.end() ? nullptr : &it->second;
+}
+
+void MethodProfile::record(const std::string& key, const MethodDecision& decision) {
+    decisions[clean(key)] = decision;
+}
+
+std::size_t MethodProfile::size() const {
+    return decisions.size();
+}
+
+std::string MethodProfile::makeKey(const Function& function, double lowerBound, double upperBound,
+                                   double tolerance) {
+    std::ostringstream key;
+    key.precision(17);
+    key << function.getDescription() << " on [" << lowerBound << ", " << upperBound << "] tol " << tolerance;
+    return key.str();
+}
+
+} // namespace numerical
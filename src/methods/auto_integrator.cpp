@@ -0,0 +1,445 @@
+#include "../../include/methods/auto_integrator.h"
+#include "../../include/cubature.h"
+#include "../../include/utils.h"
+#include "../../include/methods/adaptive.h"
+#include "../../include/methods/boole.h"
+#include "../../include/methods/gauss_legendre.h"
+#include "../../include/methods/romberg.h"
+#include "../../include/methods/simpson13.h"
+#include "../../include/methods/tanh_sinh.h"
+#include "../../include/methods/trapezoidal.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <vector>
+
+namespace numerical {
+
+namespace {
+
+constexpr double UNAFFORDABLE = std::numeric_limits<double>::infinity();
+
+// Lowest Romberg order whose agreement with the order below is trusted
+constexpr int MIN_ROMBERG_ORDER = 3;
+
+// A method the cost model considered
+struct Candidate {
+    const char* method;
+    double evaluations;   // Predicted evaluations (infinity if it would not converge)
+    int intervals;
+    int order;
+    std::string reason;
+};
+
+// Evaluate f at the points, counting undefined and infinite values as 0
+void evaluateQuietly(const Function& function, const double* x, double* y, bool* undefined, int count) {
+    try {
+        function.evaluate(x, y, count);
+        for (int i = 0; i < count; ++i) {
+            undefined[i] = !std::isfinite(y[i]);
+        }
+    } catch (const std::exception&) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                y[i] = function.evaluate(x[i]);
+                undefined[i] = !std::isfinite(y[i]);
+            } catch (const std::exception&) {
+                undefined[i] = true;
+            }
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        if (undefined[i]) {
+            y[i] = 0.0;
+        }
+    }
+}
+
+// Intervals a rule of the given formal order needs, from its results on 16,
+// 32 and 64 intervals; also returns the observed order
+double plannedIntervals(double x16, double x32, double x64, int formalOrder, int panel, double tolerance,
+                        double noise, double& observedOrder) {
+    const double d1 = std::abs(x32 - x16);
+    const double d2 = std::abs(x64 - x32);
+    if (d2 <= noise) {
+        // Converged to rounding already
+        observedOrder = formalOrder;
+        return d1 <= tolerance ? 16 : 32;
+    }
+    observedOrder = d1 > noise ? std::log2(d1 / d2) : formalOrder;
+    observedOrder = std::min(std::max(observedOrder, 0.5), 2.0 * formalOrder);
+    const double error64 = d2 / (std::pow(2.0, observedOrder) - 1.0);
+    double n = 64.0 * std::pow(error64 / tolerance, 1.0 / observedOrder);
+    n = std::max(std::ceil(n / panel) * panel, 16.0);
+    return n > INT_MAX / 2 ? UNAFFORDABLE : n;
+}
+
+} // namespace
+
+AutoIntegrator::AutoIntegrator(const Input& input, const Function& function, double tolerance)
+    : Integrator(input, function), tolerance(tolerance > 0.0 ? tolerance : 1e-10), maxEvaluations(0),
+      maxSeconds(0.0), profile(nullptr), fromProfile(false) {
+}
+
+void AutoIntegrator::setBudget(long long maxEvaluations, double maxSeconds) {
+    this->maxEvaluations = std::max(maxEvaluations, 0LL);
+    this->maxSeconds = std::max(maxSeconds, 0.0);
+}
+
+void AutoIntegrator::setProfile(MethodProfile* profile) {
+    this->profile = profile;
+}
+
+const MethodDecision& AutoIntegrator::getDecision() const {
+    return decision;
+}
+
+bool AutoIntegrator::usedProfile() const {
+    return fromProfile;
+}
+
+bool AutoIntegrator::withinBudget(double evaluations, double secondsPerEvaluation) const {
+    if (maxEvaluations > 0 && evaluations > static_cast<double>(maxEvaluations)) {
+        return false;
+    }
+    return maxSeconds <= 0.0 || evaluations * secondsPerEvaluation <= maxSeconds;
+}
+
+MethodDecision AutoIntegrator::probe(bool showSteps, long long& probeEvaluations) {
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+    const double width = b - a;
+    const int n = PROBE_INTERVALS;
+    const double h = width / n;
+
+    // The uniform probe grid and two Gauss-Legendre rules, timed together
+    double x[PROBE_INTERVALS + 1];
+    double y[PROBE_INTERVALS + 1];
+    bool undefined[PROBE_INTERVALS + 1];
+    for (int i = 0; i <= n; ++i) {
+        x[i] = a + i * h;
+    }
+    const Cubature::Rule gauss1 = Cubature::createRule("gauss", 1, GAUSS_POINTS);
+    const Cubature::Rule gauss2 = Cubature::createRule("gauss", 2, GAUSS_POINTS);
+    const int gaussCount = static_cast<int>(gauss1.nodes.size() + gauss2.nodes.size());
+    std::vector<double> gx(gaussCount);
+    std::vector<double> gy(gaussCount);
+    for (std::size_t i = 0; i < gauss1.nodes.size(); ++i) {
+        gx[i] = a + gauss1.nodes[i] * width;
+    }
+    for (std::size_t i = 0; i < gauss2.nodes.size(); ++i) {
+        gx[gauss1.nodes.size() + i] = a + gauss2.nodes[i] * width;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    evaluateQuietly(function, x, y, undefined, n + 1);
+    std::unique_ptr<bool[]> gaussUndefined(new bool[gaussCount]);
+    evaluateQuietly(function, gx.data(), gy.data(), gaussUndefined.get(), gaussCount);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    probeEvaluations = n + 1 + gaussCount;
+    const double secondsPerEvaluation = seconds / probeEvaluations;
+
+    const bool lowerSingular = undefined[0];
+    const bool upperSingular = undefined[n];
+    bool interiorUndefined = false;
+    for (int i = 1; i < n; ++i) {
+        interiorUndefined = interiorUndefined || undefined[i];
+    }
+    for (int i = 0; i < gaussCount; ++i) {
+        interiorUndefined = interiorUndefined || gaussUndefined[i];
+    }
+
+    // Trapezoidal sums on 1, 2, 4, ..., 64 intervals, and Simpson and Boole from them
+    double trapezoidal[7];
+    for (int level = 0; level <= 6; ++level) {
+        const int intervals = 1 << level;
+        const int stride = n / intervals;
+        double sum = 0.5 * (y[0] + y[n]);
+        for (int i = stride; i < n; i += stride) {
+            sum += y[i];
+        }
+        trapezoidal[level] = sum * (width / intervals);
+    }
+    auto simpson = [&](int level) { return (4.0 * trapezoidal[level] - trapezoidal[level - 1]) / 3.0; };
+    auto boole = [&](int level) { return (16.0 * simpson(level) - simpson(level - 1)) / 15.0; };
+
+    // Romberg diagonal R[j][j] for j = 0 .. 6
+    double romberg[7];
+    double row[7] = {};
+    for (int j = 0; j <= 6; ++j) {
+        double previous = row[0];
+        row[0] = trapezoidal[j];
+        double factor = 1.0;
+        for (int k = 1; k <= j; ++k) {
+            factor *= 4.0;
+            const double next = row[k - 1] + (row[k - 1] - previous) / (factor - 1.0);
+            previous = row[k];
+            row[k] = next;
+        }
+        romberg[j] = row[j];
+    }
+
+    double g1 = 0.0;
+    for (std::size_t i = 0; i < gauss1.nodes.size(); ++i) {
+        g1 += gauss1.weights[i] * gy[i];
+    }
+    double g2 = 0.0;
+    for (std::size_t i = 0; i < gauss2.nodes.size(); ++i) {
+        g2 += gauss2.weights[i] * gy[gauss1.nodes.size() + i];
+    }
+    g1 *= width;
+    g2 *= width;
+
+    // Target error and the rounding level of the differences
+    const double estimate = g2;
+    const double target = std::max(tolerance, tolerance * std::abs(estimate));
+    double largest = 0.0;
+    for (int i = 0; i <= n; ++i) {
+        largest = std::max(largest, std::abs(y[i]));
+    }
+    const double noise = 64.0 * std::numeric_limits<double>::epsilon() * std::abs(width) * std::max(largest, 1e-300);
+
+    // Smoothness from Simpson's rule, which has order 4 on smooth integrands
+    double trapezoidalOrder;
+    double simpsonOrder;
+    double booleOrder;
+    const double trapezoidalIntervals =
+        plannedIntervals(trapezoidal[4], trapezoidal[5], trapezoidal[6], 2, 1, target, noise, trapezoidalOrder);
+    const double simpsonIntervals =
+        plannedIntervals(simpson(4), simpson(5), simpson(6), 4, 2, target, noise, simpsonOrder);
+    const double booleIntervals = plannedIntervals(boole(4), boole(5), boole(6), 6, 4, target, noise, booleOrder);
+    const bool endpointsDefined = !lowerSingular && !upperSingular;
+    const bool smooth = endpointsDefined && !interiorUndefined && simpsonOrder >= 3.5;
+
+    // Where a rough integrand is rough: next to an endpoint or inside
+    bool roughAtEndpoint = !endpointsDefined;
+    if (!smooth && endpointsDefined) {
+        int peak = 1;
+        double peakValue = -1.0;
+        for (int i = 1; i < n; ++i) {
+            const double curvature = std::abs(y[i - 1] - 2.0 * y[i] + y[i + 1]);
+            if (curvature > peakValue) {
+                peakValue = curvature;
+                peak = i;
+            }
+        }
+        roughAtEndpoint = peak <= 2 || peak >= n - 2;
+    }
+
+    std::vector<Candidate> candidates;
+
+    // Gauss-Legendre: order 16 per panel when smooth, otherwise the observed order
+    {
+        const double d = std::abs(g2 - g1);
+        double panels = 1.0;
+        if (d > noise) {
+            if (smooth) {
+                panels = std::ceil(std::pow(d / target, 1.0 / (2 * GAUSS_POINTS)));
+            } else {
+                const double k = std::max(simpsonOrder, 0.5);
+                const double error2 = d / (std::pow(2.0, k) - 1.0);
+                panels = std::ceil(2.0 * std::pow(error2 / target, 1.0 / k));
+            }
+        }
+        // One panel of margin when the probe rules have not converged, as
+        // they may not yet show the asymptotic rate
+        panels = panels > 1.0 ? panels + 1.0 : 1.0;
+        candidates.push_back({"gauss", panels > INT_MAX / GAUSS_POINTS ? UNAFFORDABLE : panels * GAUSS_POINTS,
+                              static_cast<int>(std::min(panels, static_cast<double>(INT_MAX / GAUSS_POINTS))),
+                              GAUSS_POINTS, smooth ? "smooth integrand, Gauss-Legendre converges fastest"
+                                                   : "observed order " + utils::formatNumber(simpsonOrder, 2)});
+    }
+
+    // A rule that claims to be within the target on the probe grid must
+    // agree with the Gauss-Legendre estimate; coarse grids can agree by
+    // accident (x sin x on [0, 2 pi] is 0 on 1 and 2 intervals)
+    auto agrees = [&](double value) { return std::abs(value - g2) <= target; };
+
+    // Newton-Cotes rules and Romberg evaluate the endpoints
+    if (endpointsDefined) {
+        const bool simpsonPlausible = simpsonIntervals > n || agrees(simpson(6));
+        const bool boolePlausible = booleIntervals > n || agrees(boole(6));
+        candidates.push_back({"simpson13", simpsonPlausible ? simpsonIntervals + 1 : UNAFFORDABLE,
+                              static_cast<int>(std::min(simpsonIntervals, 1e9)), 0,
+                              "observed order " + utils::formatNumber(simpsonOrder, 2)});
+        candidates.push_back({"boole", boolePlausible ? booleIntervals + 1 : UNAFFORDABLE,
+                              static_cast<int>(std::min(booleIntervals, 1e9)), 0,
+                              "observed order " + utils::formatNumber(booleOrder, 2)});
+        candidates.push_back({"trapezoidal", trapezoidalIntervals + 1,
+                              static_cast<int>(std::min(trapezoidalIntervals, 1e9)), 0,
+                              "observed order " + utils::formatNumber(trapezoidalOrder, 2)});
+
+        // Romberg stops once two diagonal entries agree, from MIN_ROMBERG_ORDER
+        // on; beyond the probe grid the differences are assumed to keep
+        // shrinking at the last rate
+        int order = -1;
+        for (int j = MIN_ROMBERG_ORDER; j <= 6 && order < 0; ++j) {
+            if (std::abs(romberg[j] - romberg[j - 1]) <= target) {
+                order = agrees(romberg[j]) ? j : 0;
+            }
+        }
+        if (order < 0) {
+            const double last = std::abs(romberg[6] - romberg[5]);
+            const double rate = last / std::abs(romberg[5] - romberg[4]);
+            if (rate > 0.0 && rate < 1.0) {
+                order = 6 + static_cast<int>(std::ceil(std::log(target / last) / std::log(rate)));
+            }
+        }
+        const bool converges = order > 0 && order <= 24;
+        candidates.push_back({"romberg", converges ? std::ldexp(1.0, order) + 1 : UNAFFORDABLE,
+                              0, converges ? order : 0, "diagonal differences of the probe grid"});
+    }
+
+    // Adaptive Gauss-Kronrod (15 points per segment): bisections near the
+    // trouble spot gain about the observed order in bits each
+    {
+        double segments;
+        if (smooth) {
+            segments = 2.0 * candidates[0].evaluations / GAUSS_POINTS - 1.0;
+        } else {
+            const double error64 = std::abs(simpson(6) - simpson(5));
+            const double bits = std::log2(std::max(error64 / target, 2.0));
+            segments = 1.0 + 2.0 * (std::ceil(bits / std::max(simpsonOrder, 0.5)) + 2.0);
+        }
+        candidates.push_back({"adaptive", 15.0 * segments, 0, 0,
+                              smooth ? "smooth integrand" : "bisects toward the rough spot"});
+    }
+
+    // Tanh-sinh needs an integrand that is smooth inside the interval
+    if (!interiorUndefined && (smooth || roughAtEndpoint)) {
+        const double digits = std::min(std::max(std::log10(std::max(std::abs(estimate), target) / target), 1.0), 16.0);
+        const double nodes = 37.0 * std::ldexp(1.0, static_cast<int>(std::ceil(std::log2(std::max(1.0, digits / 6.0)))));
+        candidates.push_back({"tanhsinh", nodes, 0, 0,
+                              smooth ? "smooth integrand" : "endpoint singularity or non-smooth endpoint"});
+    }
+
+    // The cheapest candidate within the budget, else the cheapest overall
+    const Candidate* best = nullptr;
+    const Candidate* cheapest = nullptr;
+    for (const Candidate& candidate : candidates) {
+        if (!cheapest || candidate.evaluations < cheapest->evaluations) {
+            cheapest = &candidate;
+        }
+        if (withinBudget(candidate.evaluations, secondsPerEvaluation)
+            && (!best || candidate.evaluations < best->evaluations)) {
+            best = &candidate;
+        }
+    }
+    const bool overBudget = best == nullptr;
+    if (overBudget) {
+        best = cheapest;
+    }
+
+    if (showSteps) {
+        step() << "\nProbing the integrand with " << probeEvaluations << " evaluations";
+        step() << "Time per evaluation: " << secondsPerEvaluation << " s";
+        step() << "Endpoints: " << (lowerSingular ? "f(a) undefined" : "f(a) defined") << ", "
+               << (upperSingular ? "f(b) undefined" : "f(b) defined");
+        step() << "Observed orders: trapezoidal " << utils::formatNumber(trapezoidalOrder, 2) << ", Simpson "
+               << utils::formatNumber(simpsonOrder, 2) << ", Boole " << utils::formatNumber(booleOrder, 2);
+        step() << "Integrand: " << (smooth ? "smooth" : roughAtEndpoint ? "rough at an endpoint" : "rough inside");
+        step() << "Estimate: " << estimate << ", target error: " << target;
+        step() << "\n" << std::left << std::setw(14) << "Method" << std::right << std::setw(20)
+               << "Predicted evals" << std::setw(12) << "In budget";
+        step() << std::string(46, '-');
+        for (const Candidate& candidate : candidates) {
+            step() << std::left << std::setw(14) << candidate.method << std::right << std::setw(20)
+                   << (std::isinf(candidate.evaluations) ? std::string("-")
+                                                         : utils::formatNumber(candidate.evaluations, 0))
+                   << std::setw(12) << (withinBudget(candidate.evaluations, secondsPerEvaluation) ? "yes" : "no");
+        }
+        if (overBudget) {
+            step() << "\nNo method fits the budget; using the cheapest";
+        }
+    }
+
+    MethodDecision result;
+    result.method = best->method;
+    result.intervals = best->intervals;
+    result.order = best->order;
+    result.predictedEvaluations = std::isinf(best->evaluations) ? LLONG_MAX
+                                                                : static_cast<long long>(best->evaluations);
+    result.reason = best->reason;
+    return result;
+}
+
+double AutoIntegrator::compute(bool showSteps) {
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+
+    if (showSteps) {
+        step() << "\nPerforming automatic method selection";
+        step() << "Tolerance: " << tolerance;
+    }
+
+    // A decision from the profile is reused if it fits the evaluation budget
+    long long probeEvaluations = 0;
+    const std::string key = MethodProfile::makeKey(function, a, b, tolerance);
+    const MethodDecision* stored = profile ? profile->find(key) : nullptr;
+    fromProfile = stored && withinBudget(static_cast<double>(stored->predictedEvaluations), 0.0);
+    if (fromProfile) {
+        decision = *stored;
+        if (showSteps) {
+            step() << "Using the stored decision for this problem";
+        }
+    } else {
+        decision = probe(showSteps, probeEvaluations);
+        if (profile) {
+            profile->record(key, decision);
+        }
+    }
+
+    if (showSteps) {
+        step() << "\nChosen: " << decision.method << " (" << decision.reason << "), about "
+               << decision.predictedEvaluations << " evaluations";
+    }
+
+    // Apply the chosen method
+    const int choice = input.getFunctionChoice();
+    const std::string& method = decision.method;
+    if (method == "trapezoidal" || method == "simpson13" || method == "boole" || method == "gauss") {
+        chosenInput = std::make_unique<Input>(a, b, std::max(decision.intervals, 1), choice);
+    } else {
+        chosenInput = std::make_unique<Input>(a, b, 1, choice);
+    }
+    if (method == "trapezoidal") {
+        chosen = std::make_unique<TrapezoidalRule>(*chosenInput, function);
+    } else if (method == "simpson13") {
+        chosen = std::make_unique<SimpsonOneThird>(*chosenInput, function);
+    } else if (method == "boole") {
+        chosen = std::make_unique<BooleRule>(*chosenInput, function);
+    } else if (method == "romberg") {
+        chosen = std::make_unique<RombergIntegration>(*chosenInput, function, decision.order, tolerance);
+    } else if (method == "gauss") {
+        chosen = std::make_unique<GaussLegendre>(*chosenInput, function, GAUSS_POINTS);
+    } else if (method == "tanhsinh") {
+        chosen = std::make_unique<TanhSinh>(*chosenInput, function, tolerance);
+    } else {
+        chosen = std::make_unique<AdaptiveQuadrature>(*chosenInput, function, tolerance, tolerance);
+    }
+    chosen->setThreadCount(getThreadCount());
+    chosen->setSummation(summation);
+
+    IntegrationResult outcome = chosen->integrate(observer);
+    result = outcome.value;
+    evaluations = probeEvaluations + outcome.evaluations;
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations << " (probe " << probeEvaluations << ")";
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+std::string AutoIntegrator::getMethodName() const {
+    return chosen ? "Automatic: " + chosen->getMethodName() : std::string("Automatic");
+}
+
+double AutoIntegrator::getErrorEstimate() const {
+    return chosen ? chosen->getErrorEstimate() : std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace numerical
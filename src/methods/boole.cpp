@@ -1,7 +1,5 @@
 #include "../../include/methods/boole.h"
-#include "../../include/utils.h"
-#include <iostream>
-#include <iomanip>
+#include "../../include/methods/inline_rules.h"
 
 namespace numerical {
 
@@ -9,73 +7,64 @@ BooleRule::BooleRule(const Input& input, const Function& function)
     : Integrator(input, function) {
 }
 
-double BooleRule::calculate(bool showSteps) {
+double BooleRule::compute(bool showSteps) {
     // Check if the method is applicable
     if (!isApplicable()) {
-        if (showSteps) {
-            std::cerr << "\nError: Boole's rule requires a number of intervals divisible by 4." << std::endl;
-        }
-        return 0.0;
+        reportNotApplicable("Boole's rule requires a number of intervals divisible by 4.");
+        result = 0.0;
+        evaluations = 0;
+        return result;
     }
     
-    // Generate x and y values
-    generatePoints();
+    // Store x and y values only when they are displayed; otherwise stream them
+    preparePoints(showSteps);
     
     // Display intermediate values if requested
     if (showSteps) {
-        std::cout << "\nPerforming integration using Boole's Rule" << std::endl;
-        displayIntermediateValues();
+        step() << "\nPerforming integration using Boole's Rule";
+        reportSamples();
     }
     
     // Boole's Rule Formula: 4h/90 * [7(f(a) + f(b)) + 32(f(x1) + f(x3) + ...) + 12(f(x2) + f(x6) + ...) + 14(f(x4) + f(x8) + ...)]
     double h = calculateStepSize();
-    double endPoints = 7 * (yValues[0] + yValues[input.getIntervals()]);
-    double sum1 = 0.0; // Sum of function values at x1, x5, x9, ...
-    double sum2 = 0.0; // Sum of function values at x2, x6, x10, ...
-    double sum3 = 0.0; // Sum of function values at x3, x7, x11, ...
-    double sum4 = 0.0; // Sum of function values at x4, x8, x12, ...
-    
-    for (int i = 1; i < input.getIntervals(); ++i) {
-        int mod4 = i % 4;
-        if (mod4 == 1) {
-            sum1 += yValues[i];
-        } else if (mod4 == 2) {
-            sum2 += yValues[i];
-        } else if (mod4 == 3) {
-            sum3 += yValues[i];
-        } else if (mod4 == 0) {
-            sum4 += yValues[i];
-        }
-    }
+    double fa = sampleAt(0);
+    double fb = sampleAt(input.getIntervals());
+    double endPoints = 7 * (fa + fb);
+    std::array<double, 4> sums = sumInteriorByResidue(4);
+    double sum1 = sums[1]; // Sum of function values at x1, x5, x9, ...
+    double sum2 = sums[2]; // Sum of function values at x2, x6, x10, ...
+    double sum3 = sums[3]; // Sum of function values at x3, x7, x11, ...
+    double sum4 = sums[0]; // Sum of function values at x4, x8, x12, ...
     
     if (showSteps) {
-        std::cout << "\nApplying Boole's Rule formula: 4h/90 * [7(f(a) + f(b)) + 32(sum1 + sum3) + 12(sum2) + 14(sum4)]" << std::endl;
-        std::cout << "h = " << h << std::endl;
-        std::cout << "7(f(a) + f(b)) = 7 * (" << yValues[0] << " + " << yValues[input.getIntervals()] 
-                  << ") = " << endPoints << std::endl;
-        std::cout << "sum1 (indices of form 4k+1) = " << sum1 << std::endl;
-        std::cout << "sum2 (indices of form 4k+2) = " << sum2 << std::endl;
-        std::cout << "sum3 (indices of form 4k+3) = " << sum3 << std::endl;
-        std::cout << "sum4 (indices of form 4k) = " << sum4 << std::endl;
+        step() << "\nApplying Boole's Rule formula: 4h/90 * [7(f(a) + f(b)) + 32(sum1 + sum3) + 12(sum2) + 14(sum4)]";
+        step() << "h = " << h;
+        step() << "7(f(a) + f(b)) = 7 * (" << fa << " + " << fb 
+               << ") = " << endPoints;
+        step() << "sum1 (indices of form 4k+1) = " << sum1;
+        step() << "sum2 (indices of form 4k+2) = " << sum2;
+        step() << "sum3 (indices of form 4k+3) = " << sum3;
+        step() << "sum4 (indices of form 4k) = " << sum4;
         
-        utils::sleep(500);
+        pause(500);
     }
     
     double sum = endPoints + 32 * (sum1 + sum3) + 12 * sum2 + 14 * sum4;
-    result = (4 * h / 90) * sum;
+    result = rules::Boole::combine(fa, fb, sums.data(), h);
+    evaluations = input.getIntervals() + 1;
     
     if (showSteps) {
-        std::cout << "\nFinal calculation:" << std::endl;
-        std::cout << "(4 * " << h << "/90) * (" << endPoints 
-                  << " + 32 * (" << sum1 << " + " << sum3 << ")"
-                  << " + 12 * " << sum2
-                  << " + 14 * " << sum4 << ")" << std::endl;
-        std::cout << "(4 * " << h << "/90) * (" << endPoints 
-                  << " + " << (32 * (sum1 + sum3))
-                  << " + " << (12 * sum2)
-                  << " + " << (14 * sum4) << ")" << std::endl;
-        std::cout << "(4 * " << h << "/90) * " << sum << std::endl;
-        std::cout << "Result = " << result << std::endl;
+        step() << "\nFinal calculation:";
+        step() << "(4 * " << h << "/90) * (" << endPoints 
+               << " + 32 * (" << sum1 << " + " << sum3 << ")"
+               << " + 12 * " << sum2
+               << " + 14 * " << sum4 << ")";
+        step() << "(4 * " << h << "/90) * (" << endPoints 
+               << " + " << (32 * (sum1 + sum3))
+               << " + " << (12 * sum2)
+               << " + " << (14 * sum4) << ")";
+        step() << "(4 * " << h << "/90) * " << sum;
+        step() << "Result = " << result;
     }
     
     return result;
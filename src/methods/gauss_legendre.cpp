@@ -0,0 +1,345 @@
+#include "../../include/methods/gauss_legendre.h"
+#include "../../include/utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+// Built-in Gauss-Legendre rules on [-1, 1] for common orders (non-negative
+// nodes in descending order, as in GaussLegendre::Rule)
+constexpr double NODES_2[1] = {
+    0.577350269189625764509148780501957
+};
+constexpr double WEIGHTS_2[1] = {
+    1.000000000000000000000000000000000
+};
+
+constexpr double NODES_3[2] = {
+    0.774596669241483377035853079956480, 0.000000000000000000000000000000000
+};
+constexpr double WEIGHTS_3[2] = {
+    0.555555555555555555555555555555556, 0.888888888888888888888888888888889
+};
+
+constexpr double NODES_4[2] = {
+    0.861136311594052575223946488892810, 0.339981043584856264802665759103245
+};
+constexpr double WEIGHTS_4[2] = {
+    0.347854845137453857373063949221999, 0.652145154862546142626936050778001
+};
+
+constexpr double NODES_5[3] = {
+    0.906179845938663992797626878299393, 0.538469310105683091036314420700209,
+    0.000000000000000000000000000000000
+};
+constexpr double WEIGHTS_5[3] = {
+    0.236926885056189087514264040719917, 0.478628670499366468041291514835638,
+    0.568888888888888888888888888888889
+};
+
+constexpr double NODES_6[3] = {
+    0.932469514203152027812301554493995, 0.661209386466264513661399595019905,
+    0.238619186083196908630501721680712
+};
+constexpr double WEIGHTS_6[3] = {
+    0.171324492379170345040296142172733, 0.360761573048138607569833513837716,
+    0.467913934572691047389870343989551
+};
+
+constexpr double NODES_7[4] = {
+    0.949107912342758524526189684047851, 0.741531185599394439863864773280788,
+    0.405845151377397166906606412076961, 0.000000000000000000000000000000000
+};
+constexpr double WEIGHTS_7[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+constexpr double NODES_8[4] = {
+    0.960289856497536231683560868569473, 0.796666477413626739591553936475830,
+    0.525532409916328985817739049189246, 0.183434642495649804939476142360184
+};
+constexpr double WEIGHTS_8[4] = {
+    0.101228536290376259152531354309962, 0.222381034453374470544355994426241,
+    0.313706645877887287337962201986601, 0.362683783378361982965150449277196
+};
+
+constexpr double NODES_10[5] = {
+    0.973906528517171720077964012084452, 0.865063366688984510732096688423493,
+    0.679409568299024406234327365114874, 0.433395394129247190799265943165784,
+    0.148874338981631210884826001129720
+};
+constexpr double WEIGHTS_10[5] = {
+    0.066671344308688137593568809893332, 0.149451349150580593145776339657697,
+    0.219086362515982043995534934228163, 0.269266719309996355091226921569469,
+    0.295524224714752870173892994651338
+};
+
+constexpr double NODES_12[6] = {
+    0.981560634246719250690549090149281, 0.904117256370474856678465866119096,
+    0.769902674194304687036893833212818, 0.587317954286617447296702418940534,
+    0.367831498998180193752691536643718, 0.125233408511468915472441369463853
+};
+constexpr double WEIGHTS_12[6] = {
+    0.047175336386511827194615961485017, 0.106939325995318430960254718193996,
+    0.160078328543346226334652529543359, 0.203167426723065921749064455809798,
+    0.233492536538354808760849898924878, 0.249147045813402785000562436042951
+};
+
+constexpr double NODES_16[8] = {
+    0.989400934991649932596154173450333, 0.944575023073232576077988415534608,
+    0.865631202387831743880467897712393, 0.755404408355003033895101194847442,
+    0.617876244402643748446671764048791, 0.458016777657227386342419442983578,
+    0.281603550779258913230460501460496, 0.095012509837637440185319335424958
+};
+constexpr double WEIGHTS_16[8] = {
+    0.027152459411754094851780572456018, 0.062253523938647892862843836994378,
+    0.095158511682492784809925107602246, 0.124628971255533872052476282192016,
+    0.149595988816576732081501730547479, 0.169156519395002538189312079030360,
+    0.182603415044923588866763667969220, 0.189450610455068496285396723208283
+};
+
+constexpr double NODES_20[10] = {
+    0.993128599185094924786122388471320, 0.963971927277913791267666131197277,
+    0.912234428251325905867752441203298, 0.839116971822218823394529061701521,
+    0.746331906460150792614305070355642, 0.636053680726515025452836696226286,
+    0.510867001950827098004364050955251, 0.373706088715419560672548177024927,
+    0.227785851141645078080496195368575, 0.076526521133497333754640409398838
+};
+constexpr double WEIGHTS_20[10] = {
+    0.017614007139152118311861962351853, 0.040601429800386941331039952274932,
+    0.062672048334109063569506535187042, 0.083276741576704748724758143222046,
+    0.101930119817240435036750135480350, 0.118194531961518417312377377711382,
+    0.131688638449176626898494499748163, 0.142096109318382051329298325067165,
+    0.149172986472603746787828737001969, 0.152753387130725850698084331955098
+};
+
+/**
+ * @struct BuiltInRule
+ * @brief A rule from the tables above
+ */
+struct BuiltInRule {
+    int points;
+    const double* nodes;
+    const double* weights;
+};
+
+constexpr BuiltInRule BUILT_IN_RULES[] = {
+    {2, NODES_2, WEIGHTS_2}, {3, NODES_3, WEIGHTS_3}, {4, NODES_4, WEIGHTS_4},
+    {5, NODES_5, WEIGHTS_5}, {6, NODES_6, WEIGHTS_6}, {7, NODES_7, WEIGHTS_7},
+    {8, NODES_8, WEIGHTS_8}, {10, NODES_10, WEIGHTS_10}, {12, NODES_12, WEIGHTS_12},
+    {16, NODES_16, WEIGHTS_16}, {20, NODES_20, WEIGHTS_20}
+};
+
+constexpr double PI = 3.14159265358979323846;
+
+} // namespace
+
+GaussLegendre::GaussLegendre(const Input& input, const Function& function, int points)
+    : Integrator(input, function), points(points) {
+    // Ensure the point count is within the supported range
+    if (this->points < 1) {
+        this->points = 1;
+    }
+    if (this->points > MAX_POINTS) {
+        this->points = MAX_POINTS;
+    }
+}
+
+const GaussLegendre::Rule& GaussLegendre::getRule(int points) {
+    if (points < 1 || points > MAX_POINTS) {
+        throw std::invalid_argument("Gauss-Legendre rules need 1 to " + std::to_string(MAX_POINTS) + " points");
+    }
+
+    // Rules are created on first use and never removed, so references stay valid
+    static std::mutex cacheMutex;
+    static std::map<int, std::unique_ptr<const Rule>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = cache.find(points);
+    if (found != cache.end()) {
+        return *found->second;
+    }
+
+    std::unique_ptr<Rule> rule;
+    for (const auto& builtIn : BUILT_IN_RULES) {
+        if (builtIn.points == points) {
+            int count = (points + 1) / 2;
+            rule = std::make_unique<Rule>();
+            rule->points = points;
+            rule->nodes.assign(builtIn.nodes, builtIn.nodes + count);
+            rule->weights.assign(builtIn.weights, builtIn.weights + count);
+            break;
+        }
+    }
+    if (!rule) {
+        rule = std::make_unique<Rule>(computeRule(points));
+    }
+    return *cache.emplace(points, std::move(rule)).first->second;
+}
+
+GaussLegendre::Rule GaussLegendre::computeRule(int points) {
+    // P_n(x) and P_n'(x) from the three-term recurrence, in extended precision
+    auto legendre = [points](long double x, long double& derivative) {
+        long double previous = 1.0L;
+        long double current = x;
+        for (int k = 2; k <= points; ++k) {
+            long double next = ((2 * k - 1) * x * current - (k - 1) * previous) / k;
+            previous = current;
+            current = next;
+        }
+        derivative = points * (x * current - previous) / (x * x - 1.0L);
+        return current;
+    };
+
+    Rule rule;
+    rule.points = points;
+    for (int i = 1; i <= points / 2; ++i) {
+        // Start close to the i-th largest root and polish it with Newton's method
+        long double x = std::cos(PI * (i - 0.25) / (points + 0.5));
+        long double derivative = 0.0L;
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            long double dx = legendre(x, derivative) / derivative;
+            x -= dx;
+            if (std::abs(dx) <= 1e-19L) {
+                break;
+            }
+        }
+        legendre(x, derivative);
+        rule.nodes.push_back(static_cast<double>(x));
+        rule.weights.push_back(static_cast<double>(2.0L / ((1.0L - x * x) * derivative * derivative)));
+    }
+    if (points % 2 == 1) {
+        long double derivative = 0.0L;
+        legendre(0.0L, derivative);
+        rule.nodes.push_back(0.0);
+        rule.weights.push_back(static_cast<double>(2.0L / (derivative * derivative)));
+    }
+    return rule;
+}
+
+double GaussLegendre::compute(bool showSteps) {
+    const Rule& rule = getRule(points);
+    const int panels = input.getIntervals();
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+    const double width = (b - a) / panels;
+    const double halfWidth = 0.5 * width;
+    const int pairs = points / 2;
+    const bool hasCentre = points % 2 == 1;
+
+    if (showSteps) {
+        step() << "\nPerforming integration using " << points << "-point Gauss-Legendre quadrature";
+        step() << "\nNodes and weights on [-1, 1]:";
+        step() << std::setw(24) << "node" << std::setw(24) << "weight";
+        step() << std::string(48, '-');
+        for (std::size_t j = 0; j < rule.nodes.size(); ++j) {
+            std::string sign = rule.nodes[j] == 0.0 ? "" : "+/- ";
+            step() << std::setw(24) << (sign + utils::formatNumber(rule.nodes[j], 16))
+                   << std::setw(24) << utils::formatNumber(rule.weights[j], 16);
+        }
+        step() << "\nPanels: " << panels << ", panel width H = " << width;
+        step() << "Each panel contributes H/2 * sum(w_j * f(x_j))";
+        pause(500);
+    }
+
+    // Panels are grouped into fixed blocks (for a thread-count-independent
+    // sum) and into batches of whole panels (for the batch kernels)
+    const int panelsPerBatch = std::max(1, BATCH_SIZE / points);
+    const long long panelsPerBlock = std::max(1, BLOCK_INTERVALS / points);
+    const long long blockCount = (panels + panelsPerBlock - 1) / panelsPerBlock;
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    std::vector<double> panelSums(showSteps ? panels : 0);
+
+    auto sumBlock = [&](std::size_t block) {
+        long long begin = static_cast<long long>(block) * panelsPerBlock;
+        long long end = std::min(begin + panelsPerBlock, static_cast<long long>(panels));
+        double x[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        double weighted[BATCH_SIZE];
+        Accumulator sum(summation);
+        for (long long first = begin; first < end; first += panelsPerBatch) {
+            int batchPanels = static_cast<int>(std::min(static_cast<long long>(panelsPerBatch), end - first));
+
+            // Nodes are measured from the nearer panel endpoint so they never
+            // round onto a (possibly singular) endpoint
+            int count = 0;
+            for (int p = 0; p < batchPanels; ++p) {
+                long long panel = first + p;
+                double left = a + panel * width;
+                double right = panel + 1 == panels ? b : a + (panel + 1) * width;
+                for (int j = 0; j < pairs; ++j) {
+                    double offset = halfWidth * (1.0 - rule.nodes[j]);
+                    x[count++] = left + offset;
+                    x[count++] = right - offset;
+                }
+                if (hasCentre) {
+                    x[count++] = 0.5 * (left + right);
+                }
+            }
+            evaluateBatch(x, y, count);
+
+            const double* values = y;
+            for (int p = 0; p < batchPanels; ++p) {
+                double panelSum = hasCentre ? rule.weights[pairs] * values[2 * pairs] : 0.0;
+                for (int j = 0; j < pairs; ++j) {
+                    panelSum += rule.weights[j] * (values[2 * j] + values[2 * j + 1]);
+                }
+                if (showSteps) {
+                    panelSums[first + p] = halfWidth * panelSum;
+                }
+                weighted[p] = panelSum;
+                values += points;
+            }
+            sum.add(weighted, batchPanels);
+        }
+        blockSums[block] = sum;
+    };
+
+    forEachBlock(blockCount, sumBlock);
+
+    // Combine the block sums in a fixed order, independent of the thread count
+    Accumulator sum(summation);
+    for (const Accumulator& blockSum : blockSums) {
+        sum.add(blockSum);
+    }
+    result = halfWidth * sum.total();
+    evaluations = static_cast<long long>(panels) * points;
+
+    if (showSteps) {
+        const int shown = std::min(panels, 10);
+        step() << "\nPanel contributions:";
+        step() << std::setw(15) << "left" << std::setw(15) << "right" << std::setw(22) << "integral";
+        step() << std::string(52, '-');
+        for (int panel = 0; panel < shown; ++panel) {
+            step() << std::setw(15) << utils::formatNumber(a + panel * width, 8)
+                   << std::setw(15) << utils::formatNumber(panel + 1 == panels ? b : a + (panel + 1) * width, 8)
+                   << std::setw(22) << utils::formatNumber(panelSums[panel], 14);
+        }
+        if (shown < panels) {
+            step() << "... (" << (panels - shown) << " more panels)";
+        }
+
+        step() << "\nFunction evaluations: " << evaluations;
+        step() << "Result = " << result;
+    }
+
+    return result;
+}
+
+std::string GaussLegendre::getMethodName() const {
+    return "Gauss-Legendre";
+}
+
+int GaussLegendre::getPoints() const {
+    return points;
+}
+
+} // namespace numerical
@@ -0,0 +1,191 @@
+#include "../../include/methods/incremental.h"
+#include "../../include/methods/inline_rules.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace numerical {
+
+IncrementalIntegrator::IncrementalIntegrator(const Input& input, const Function& function, int panel)
+    : Integrator(input, function), panel(std::min(std::max(panel, 1), 4)), intervals(0), baseIntervals(0),
+      lowerBound(0.0), upperBound(0.0), fa(0.0), fb(0.0), pendingEvaluations(0) {
+}
+
+void IncrementalIntegrator::start() {
+    intervals = input.getIntervals();
+    baseIntervals = input.getIntervals();
+    lowerBound = input.getLowerBound();
+    upperBound = input.getUpperBound();
+    classSums.fill(Accumulator(summation));
+
+    fa = evaluatePoint(lowerBound);
+    fb = evaluatePoint(upperBound);
+    addPoints((upperBound - lowerBound) / intervals, 1, 0, 1, intervals);
+    pendingEvaluations = intervals + 1;
+}
+
+void IncrementalIntegrator::reset() {
+    intervals = 0;
+    pendingEvaluations = 0;
+}
+
+void IncrementalIntegrator::refine(int factor) {
+    if (factor < 2) {
+        throw std::invalid_argument("The refinement factor must be at least 2");
+    }
+    if (intervals == 0) {
+        start();
+    }
+
+    // Old point i becomes point factor*i, so its class moves accordingly
+    std::array<Accumulator, CLASSES> moved;
+    moved.fill(Accumulator(summation));
+    for (int r = 0; r < CLASSES; ++r) {
+        moved[(factor * r) % CLASSES].add(classSums[r]);
+    }
+    classSums = moved;
+
+    // The new points are factor*j + m for every old interval j and 0 < m < factor
+    double h = (upperBound - lowerBound) / (intervals * factor);
+    for (int m = 1; m < factor; ++m) {
+        addPoints(h, factor, m, 0, intervals);
+    }
+    pendingEvaluations += (factor - 1) * intervals;
+    intervals *= factor;
+}
+
+void IncrementalIntegrator::addPoints(double h, long long factor, long long offset, long long first,
+                                      long long last) {
+    if (first >= last) {
+        return;
+    }
+
+    // Blocks of j start on a multiple of LANES, so lane l collects the points
+    // with j % LANES == l, whose grid index factor*j + offset has the fixed
+    // class (factor*l + offset) % CLASSES
+    static_assert(BLOCK_INTERVALS % LANES == 0 && LANES % CLASSES == 0, "Lanes must not straddle classes");
+    const long long firstBlock = first / BLOCK_INTERVALS;
+    const long long blockCount = (last - 1) / BLOCK_INTERVALS + 1 - firstBlock;
+    std::vector<std::array<Accumulator, CLASSES>> blockSums(blockCount);
+
+    auto sumBlock = [&](std::size_t block) {
+        long long blockStart = (firstBlock + static_cast<long long>(block)) * BLOCK_INTERVALS;
+        long long begin = std::max(first, blockStart);
+        long long end = std::min(last, blockStart + BLOCK_INTERVALS);
+        double x[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        double lanes[LANES] = {};
+        std::array<Accumulator, LANES> laneSums;
+        laneSums.fill(Accumulator(summation));
+
+        for (long long start = begin; start < end; start += BATCH_SIZE) {
+            int count = static_cast<int>(std::min(static_cast<long long>(BATCH_SIZE), end - start));
+            for (int k = 0; k < count; ++k) {
+                x[k] = lowerBound + (factor * (start + k) + offset) * h;
+            }
+            evaluateBatch(x, y, count);
+
+            int lane = static_cast<int>(start % LANES);
+            if (summation == Summation::Naive) {
+                addInterleaved(y, count, lane, lanes, LANES);
+            } else {
+                for (int k = 0; k < LANES && k < count; ++k) {
+                    laneSums[(lane + k) % LANES].add(y + k, (count - k + LANES - 1) / LANES, LANES);
+                }
+            }
+        }
+
+        std::array<Accumulator, CLASSES> sums;
+        sums.fill(Accumulator(summation));
+        for (int l = 0; l < LANES; ++l) {
+            int r = static_cast<int>((factor * l + offset) % CLASSES);
+            if (summation == Summation::Naive) {
+                sums[r].add(lanes[l]);
+            } else {
+                sums[r].add(laneSums[l]);
+            }
+        }
+        blockSums[block] = sums;
+    };
+
+    forEachBlock(blockCount, sumBlock);
+
+    // Combine the block sums in a fixed order, independent of the thread count
+    for (const auto& blockSum : blockSums) {
+        for (int r = 0; r < CLASSES; ++r) {
+            classSums[r].add(blockSum[r]);
+        }
+    }
+}
+
+double IncrementalIntegrator::compute(bool showSteps) {
+    bool stale = intervals == 0 || baseIntervals != input.getIntervals()
+                 || lowerBound != input.getLowerBound() || upperBound != input.getUpperBound();
+    if (stale && input.getIntervals() % panel != 0) {
+        reportNotApplicable("The rule requires a number of intervals divisible by " + std::to_string(panel) + ".");
+        result = 0.0;
+        evaluations = 0;
+        return result;
+    }
+    if (stale) {
+        start();
+    }
+
+    // Sums by index modulo the panel width, gathered from the finer classes
+    std::array<double, 4> sums = {0.0, 0.0, 0.0, 0.0};
+    for (int p = 0; p < panel; ++p) {
+        Accumulator sum(summation);
+        for (int r = p; r < CLASSES; r += panel) {
+            sum.add(classSums[r]);
+        }
+        sums[p] = sum.total();
+    }
+
+    double h = (upperBound - lowerBound) / intervals;
+    switch (panel) {
+        case 1:
+            result = rules::Trapezoidal::combine(fa, fb, sums.data(), h);
+            break;
+        case 2:
+            result = rules::SimpsonOneThird::combine(fa, fb, sums.data(), h);
+            break;
+        case 3:
+            result = rules::SimpsonThreeEighth::combine(fa, fb, sums.data(), h);
+            break;
+        default:
+            result = rules::Boole::combine(fa, fb, sums.data(), h);
+    }
+    evaluations = pendingEvaluations;
+    pendingEvaluations = 0;
+
+    if (showSteps) {
+        step() << "\nPerforming " << getMethodName() << " on " << intervals << " intervals";
+        step() << "h = " << h;
+        step() << "New function evaluations: " << evaluations;
+        step() << "Result = " << result;
+    }
+
+    return result;
+}
+
+std::string IncrementalIntegrator::getMethodName() const {
+    switch (panel) {
+        case 1:
+            return "Trapezoidal Rule (incremental)";
+        case 2:
+            return "Simpson's 1/3 Rule (incremental)";
+        case 3:
+            return "Simpson's 3/8 Rule (incremental)";
+        default:
+            return "Boole's Rule (incremental)";
+    }
+}
+
+bool IncrementalIntegrator::isApplicable() const {
+    return (intervals > 0 ? intervals : input.getIntervals()) % panel == 0;
+}
+
+long long IncrementalIntegrator::getIntervals() const {
+    return intervals > 0 ? intervals : input.getIntervals();
+}
+
+} // namespace numerical
@@ -0,0 +1,116 @@
+#include "../../include/methods/monte_carlo.h"
+#include "../../include/utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace numerical {
+
+MonteCarlo::MonteCarlo(const Input& input, const Function& function, Sampling sampling, std::uint64_t seed)
+    : Integrator(input, function), sampling(sampling), seed(seed),
+      standardError(std::numeric_limits<double>::quiet_NaN()) {}
+
+double MonteCarlo::compute(bool showSteps) {
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+    const double width = b - a;
+    const SamplingSequence sequence(sampling, 1, seed);
+
+    // Pseudo-random points form one stream; quasi-random ones are split into
+    // replicates, at most one per point, whose sizes add up to the samples
+    const long long samples = std::max(input.getIntervals(), 1);
+    const int replicates =
+        sampling == Sampling::Pseudo ? 1 : static_cast<int>(std::min<long long>(REPLICATES, samples));
+    const long long blocksPerReplicate = (replicateSize(samples, replicates, 0) + BLOCK_POINTS - 1) / BLOCK_POINTS;
+    const long long blockCount = replicates * blocksPerReplicate;
+
+    if (showSteps) {
+        step() << "\nPerforming integration using " << getMethodName();
+        step() << "Seed: " << seed;
+        if (replicates > 1) {
+            step() << "Replicates: " << describeReplicates(samples, replicates);
+        } else {
+            step() << "Points: " << samples;
+        }
+    }
+
+    std::vector<Accumulator> blockSums(blockCount, Accumulator(summation));
+    std::vector<SampleMoments> blockMoments(blockCount);
+    forEachBlock(blockCount, [&](std::size_t block) {
+        const std::uint32_t replicate = static_cast<std::uint32_t>(block / blocksPerReplicate);
+        const long long begin = static_cast<long long>(block % blocksPerReplicate) * BLOCK_POINTS;
+        const long long end = std::min(begin + BLOCK_POINTS, replicateSize(samples, replicates, replicate));
+        double u[BATCH_SIZE];
+        double x[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        double* coordinates[1] = {u};
+        for (long long start = begin; start < end; start += BATCH_SIZE) {
+            const int count = static_cast<int>(std::min<long long>(BATCH_SIZE, end - start));
+            sequence.generate(replicate, static_cast<std::uint64_t>(start), count, coordinates);
+            for (int i = 0; i < count; ++i) {
+                x[i] = a + width * u[i];
+            }
+            evaluateBatch(x, y, count);
+            blockSums[block].add(y, count);
+            blockMoments[block].add(y, count);
+        }
+    });
+
+    // Combine the blocks of each replicate in order, independent of the thread count
+    Accumulator meanSum(summation);
+    SampleMoments replicateMeans;
+    SampleMoments values;
+    if (showSteps && replicates > 1) {
+        step() << "\n" << std::setw(10) << "Replicate" << std::setw(24) << "Estimate";
+        step() << std::string(34, '-');
+    }
+    for (int r = 0; r < replicates; ++r) {
+        Accumulator sum(summation);
+        for (long long k = 0; k < blocksPerReplicate; ++k) {
+            sum.add(blockSums[r * blocksPerReplicate + k]);
+            values.merge(blockMoments[r * blocksPerReplicate + k]);
+        }
+        const double mean = sum.total() / static_cast<double>(replicateSize(samples, replicates, r));
+        meanSum.add(&mean, 1);
+        replicateMeans.add(&mean, 1);
+        if (showSteps && replicates > 1) {
+            step() << std::setw(10) << r + 1 << std::setw(24) << utils::formatNumber(width * mean, 16);
+        }
+    }
+
+    evaluations = samples;
+    result = width * meanSum.total() / replicates;
+    if (samples < 2) {
+        standardError = std::numeric_limits<double>::quiet_NaN(); // No spread to measure
+    } else if (replicates > 1) {
+        standardError = std::abs(width) * std::sqrt(replicateMeans.variance() / replicates);
+    } else {
+        standardError = std::abs(width) * std::sqrt(values.variance() / static_cast<double>(evaluations));
+    }
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations;
+        step() << "Sample variance: " << values.variance();
+        step() << "Standard error: " << standardError;
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+std::string MonteCarlo::getMethodName() const {
+    switch (sampling) {
+        case Sampling::Pseudo:
+            return "Monte Carlo (Philox)";
+        case Sampling::Halton:
+            return "Quasi-Monte Carlo (Halton)";
+        default:
+            return "Quasi-Monte Carlo (Sobol)";
+    }
+}
+
+double MonteCarlo::getErrorEstimate() const {
+    return standardError;
+}
+
+} // namespace numerical
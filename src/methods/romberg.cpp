@@ -1,85 +1,139 @@
 #include "../../include/methods/romberg.h"
-#include "../../include/utils.h"
-#include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <cmath>
 
 namespace numerical {
 
-RombergIntegration::RombergIntegration(const Input& input, const Function& function, int order)
-    : Integrator(input, function), order(order) {
+RombergIntegration::RombergIntegration(const Input& input, const Function& function, int order,
+                                       double tolerance)
+    : Integrator(input, function), order(order), tolerance(tolerance), reachedOrder(0),
+      errorEstimate(0.0) {
     // Ensure order is valid
     if (order < 1) {
         this->order = 1;
-    } else if (order > 10) {
-        this->order = 10; // Limit maximum order for performance
+    } else if (order > MAX_ORDER) {
+        this->order = MAX_ORDER; // The finest level already needs 2^MAX_ORDER evaluations
+    }
+    if (tolerance < 0.0) {
+        this->tolerance = 0.0;
     }
 }
 
-double RombergIntegration::calculate(bool showSteps) {
-    // Initialize Romberg table
-    R.resize(order + 1, std::vector<double>(order + 1, 0.0));
+double RombergIntegration::compute(bool showSteps) {
+    // Only rows R[i-1][*] and R[i][*] are needed to extend the table
+    const int width = order + 1;
+    rows.assign(2 * width, 0.0);
+    double* previous = rows.data();
+    double* current = rows.data() + width;
+    
+    // The full table is only kept when it is displayed
+    if (showSteps) {
+        table.assign(static_cast<std::size_t>(width) * width, 0.0);
+    } else {
+        std::vector<double>().swap(table);
+    }
     
     double h = input.getUpperBound() - input.getLowerBound();
     double a = input.getLowerBound();
     double b = input.getUpperBound();
     
+    // A cached grid refining the finest level 2^order by a power of two holds
+    // every point of every level; b is only on it if a + (b - a) rounds to b.
+    // Without a tolerance every level is computed anyway, so on a miss the
+    // finest grid is evaluated into the cache for later integrators.
+    // Only points evaluated here count, including those evaluated to fill
+    // the cache, not those read from it
+    long long stride = 1;
+    const long long cachedBefore = sampleCache ? sampleCache->getEvaluationCount() : 0;
+    const double* grid = showSteps ? nullptr : lookupCachedGrid(1 << order, stride, tolerance == 0.0);
+    evaluations = sampleCache ? sampleCache->getEvaluationCount() - cachedBefore : 0;
+    const bool bOnGrid = grid && a + (b - a) == b;
+    double fa = grid ? grid[0] : evaluatePoint(a);
+    double fb = bOnGrid ? grid[(1LL << order) * stride] : evaluatePoint(b);
+    evaluations += (grid ? 0 : 1) + (bOnGrid ? 0 : 1);
+    
     // Initial trapezoidal approximation with h = b-a
-    R[0][0] = (h / 2) * (function.evaluate(a) + function.evaluate(b));
+    previous[0] = (h / 2) * (fa + fb);
+    reachedOrder = 0;
+    errorEstimate = 0.0;
+    result = previous[0];
     
     if (showSteps) {
-        std::cout << "\nPerforming Romberg Integration" << std::endl;
-        std::cout << "Order: " << order << std::endl;
-        std::cout << "Initial step size h = " << h << std::endl;
-        std::cout << "R[0][0] = " << R[0][0] << " (Trapezoidal rule with 1 interval)" << std::endl;
-        utils::sleep(300);
+        table[0] = previous[0];
+        step() << "\nPerforming Romberg Integration";
+        step() << "Order: " << order;
+        if (tolerance > 0.0) {
+            step() << "Tolerance: " << tolerance;
+        }
+        step() << "Initial step size h = " << h;
+        step() << "R[0][0] = " << previous[0] << " (Trapezoidal rule with 1 interval)";
+        pause(300);
     }
     
-    // Fill the Romberg table
+    // Fill the Romberg table row by row
     for (int i = 1; i <= order; ++i) {
-        // Calculate R[i][0] using trapezoidal rule with 2^i intervals
+        // Calculate R[i][0] using trapezoidal rule with 2^i intervals;
+        // only the 2^(i-1) new midpoints are evaluated
         h /= 2;
-        double sum = 0;
-        int steps = std::pow(2, i - 1);
-        for (int j = 0; j < steps; ++j) {
-            double x = a + (2 * j + 1) * h;
-            sum += function.evaluate(x);
+        long long steps = 1LL << (i - 1);
+        double sum = sumStrided(a, h, 1, 2, steps, grid, (1LL << (order - i)) * stride);
+        if (!grid) {
+            evaluations += steps;
         }
-        R[i][0] = R[i-1][0] / 2 + h * sum;
+        current[0] = previous[0] / 2 + h * sum;
         
         if (showSteps) {
-            std::cout << "R[" << i << "][0] = " << R[i][0] 
-                     << " (Trapezoidal rule with " << (1 << i) << " intervals)" << std::endl;
-            utils::sleep(200);
+            step() << "R[" << i << "][0] = " << current[0] 
+                   << " (Trapezoidal rule with " << (1LL << i) << " intervals)";
+            pause(200);
         }
         
         // Calculate R[i][j] using Richardson extrapolation
+        double factor = 1.0;
         for (int j = 1; j <= i; ++j) {
-            double factor = std::pow(4, j);
-            R[i][j] = R[i][j-1] + (R[i][j-1] - R[i-1][j-1]) / (factor - 1);
+            factor *= 4; // 4^j
+            current[j] = current[j-1] + (current[j-1] - previous[j-1]) / (factor - 1);
             
             if (showSteps) {
-                std::cout << "R[" << i << "][" << j << "] = " << R[i][j] 
-                         << " (Extrapolation with factor " << factor << ")" << std::endl;
-                utils::sleep(200);
+                step() << "R[" << i << "][" << j << "] = " << current[j] 
+                       << " (Extrapolation with factor " << factor << ")";
+                pause(200);
             }
         }
+        
+        if (showSteps) {
+            std::copy(current, current + i + 1, table.begin() + static_cast<std::size_t>(i) * width);
+        }
+        
+        reachedOrder = i;
+        errorEstimate = std::abs(current[i] - previous[i-1]);
+        result = current[i];
+        std::swap(previous, current);
+        
+        // Stop as soon as successive diagonal entries agree; coarse levels
+        // can agree by accident (x sin x on [0, 2 pi] is 0 on 1 and 2 intervals)
+        if (tolerance > 0.0 && i >= MIN_CONVERGED_ORDER
+            && errorEstimate <= std::max(tolerance, tolerance * std::abs(result))) {
+            if (showSteps) {
+                step() << "Converged: |R[" << i << "][" << i << "] - R[" << (i - 1) << "][" << (i - 1)
+                       << "]| = " << errorEstimate;
+            }
+            break;
+        }
     }
     
-    // The final result is in the lower-right corner of the Romberg table
-    result = R[order][order];
-    
     if (showSteps) {
         // Display Romberg table
-        std::cout << "\nRomberg Table:" << std::endl;
-        for (int i = 0; i <= order; ++i) {
+        step() << "\nRomberg Table:";
+        for (int i = 0; i <= reachedOrder; ++i) {
+            StepWriter row = step();
             for (int j = 0; j <= i; ++j) {
-                std::cout << std::setw(15) << std::setprecision(8) << R[i][j];
+                row << std::setw(15) << std::setprecision(8) << table[static_cast<std::size_t>(i) * width + j];
             }
-            std::cout << std::endl;
         }
         
-        std::cout << "\nFinal result: R[" << order << "][" << order << "] = " << result << std::endl;
+        step() << "\nFinal result: R[" << reachedOrder << "][" << reachedOrder << "] = " << result;
     }
     
     return result;
@@ -89,4 +143,12 @@ std::string RombergIntegration::getMethodName() const {
     return "Romberg Integration (Order " + std::to_string(order) + ")";
 }
 
+int RombergIntegration::getReachedOrder() const {
+    return reachedOrder;
+}
+
+double RombergIntegration::getErrorEstimate() const {
+    return errorEstimate;
+}
+
 } // namespace numerical
\ No newline at end of file
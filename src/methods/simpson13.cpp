@@ -1,7 +1,5 @@
 #include "../../include/methods/simpson13.h"
-#include "../../include/utils.h"
-#include <iostream>
-#include <iomanip>
+#include "../../include/methods/inline_rules.h"
 
 namespace numerical {
 
@@ -9,60 +7,60 @@ SimpsonOneThird::SimpsonOneThird(const Input& input, const Function& function)
     : Integrator(input, function) {
 }
 
-double SimpsonOneThird::calculate(bool showSteps) {
+double SimpsonOneThird::compute(bool showSteps) {
     // Check if the method is applicable
     if (!isApplicable()) {
-        if (showSteps) {
-            std::cerr << "\nError: Simpson's 1/3 rule requires an even number of intervals." << std::endl;
-        }
-        return 0.0;
+        reportNotApplicable("Simpson's 1/3 rule requires an even number of intervals.");
+        result = 0.0;
+        evaluations = 0;
+        return result;
     }
     
-    // Generate x and y values
-    generatePoints();
+    if (grid) {
+        return computeOnGrid(2, showSteps);
+    }
+    
+    // Store x and y values only when they are displayed; otherwise stream them
+    preparePoints(showSteps);
     
     // Display intermediate values if requested
     if (showSteps) {
-        std::cout << "\nPerforming integration using Simpson's 1/3 Rule" << std::endl;
-        displayIntermediateValues();
+        step() << "\nPerforming integration using Simpson's 1/3 Rule";
+        reportSamples();
     }
     
     // Simpson's 1/3 Rule Formula: h/3 * [f(a) + f(b) + 4 * sum(f(x_odd)) + 2 * sum(f(x_even))]
     double h = calculateStepSize();
-    double sum = yValues[0] + yValues[input.getIntervals()]; // f(a) + f(b)
-    double evenSum = 0.0;
-    double oddSum = 0.0;
-    
-    for (int i = 1; i < input.getIntervals(); ++i) {
-        if (i % 2 == 0) {
-            evenSum += yValues[i];
-        } else {
-            oddSum += yValues[i];
-        }
-    }
+    double fa = sampleAt(0);
+    double fb = sampleAt(input.getIntervals());
+    double sum = fa + fb; // f(a) + f(b)
+    std::array<double, 4> sums = sumInteriorByResidue(2);
+    double evenSum = sums[0];
+    double oddSum = sums[1];
     
     if (showSteps) {
-        std::cout << "\nApplying Simpson's 1/3 Rule formula: h/3 * [f(a) + f(b) + 4 * sum(f(x_odd)) + 2 * sum(f(x_even))]" << std::endl;
-        std::cout << "h = " << h << std::endl;
-        std::cout << "f(a) + f(b) = " << yValues[0] << " + " << yValues[input.getIntervals()] 
-                  << " = " << (yValues[0] + yValues[input.getIntervals()]) << std::endl;
-        std::cout << "sum of f(x) at odd points = " << oddSum << std::endl;
-        std::cout << "sum of f(x) at even points = " << evenSum << std::endl;
+        step() << "\nApplying Simpson's 1/3 Rule formula: h/3 * [f(a) + f(b) + 4 * sum(f(x_odd)) + 2 * sum(f(x_even))]";
+        step() << "h = " << h;
+        step() << "f(a) + f(b) = " << fa << " + " << fb 
+               << " = " << (fa + fb);
+        step() << "sum of f(x) at odd points = " << oddSum;
+        step() << "sum of f(x) at even points = " << evenSum;
         
-        utils::sleep(500);
+        pause(500);
     }
     
     sum += 4 * oddSum + 2 * evenSum;
-    result = (h / 3) * sum;
+    result = rules::SimpsonOneThird::combine(fa, fb, sums.data(), h);
+    evaluations = input.getIntervals() + 1;
     
     if (showSteps) {
-        std::cout << "\nFinal calculation:" << std::endl;
-        std::cout << "(" << h << "/3) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + 4 * " << oddSum << " + 2 * " << evenSum << ")" << std::endl;
-        std::cout << "(" << h << "/3) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + " << (4 * oddSum) << " + " << (2 * evenSum) << ")" << std::endl;
-        std::cout << "(" << h << "/3) * " << sum << std::endl;
-        std::cout << "Result = " << result << std::endl;
+        step() << "\nFinal calculation:";
+        step() << "(" << h << "/3) * (" << (fa + fb) 
+               << " + 4 * " << oddSum << " + 2 * " << evenSum << ")";
+        step() << "(" << h << "/3) * (" << (fa + fb) 
+               << " + " << (4 * oddSum) << " + " << (2 * evenSum) << ")";
+        step() << "(" << h << "/3) * " << sum;
+        step() << "Result = " << result;
     }
     
     return result;
@@ -73,7 +71,7 @@ std::string SimpsonOneThird::getMethodName() const {
 }
 
 bool SimpsonOneThird::isApplicable() const {
-    return input.getIntervals() % 2 == 0;
+    return (grid ? grid->getIntervals() : input.getIntervals()) % 2 == 0;
 }
 
 } // namespace numerical
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "../../include/methods/simpson38.h"
-#include "../../include/utils.h"
-#include <iostream>
-#include <iomanip>
+#include "../../include/methods/inline_rules.h"
 
 namespace numerical {
 
@@ -9,60 +7,56 @@ SimpsonThreeEighth::SimpsonThreeEighth(const Input& input, const Function& funct
     : Integrator(input, function) {
 }
 
-double SimpsonThreeEighth::calculate(bool showSteps) {
+double SimpsonThreeEighth::compute(bool showSteps) {
     // Check if the method is applicable
     if (!isApplicable()) {
-        if (showSteps) {
-            std::cerr << "\nError: Simpson's 3/8 rule requires a number of intervals divisible by 3." << std::endl;
-        }
-        return 0.0;
+        reportNotApplicable("Simpson's 3/8 rule requires a number of intervals divisible by 3.");
+        result = 0.0;
+        evaluations = 0;
+        return result;
     }
     
-    // Generate x and y values
-    generatePoints();
+    // Store x and y values only when they are displayed; otherwise stream them
+    preparePoints(showSteps);
     
     // Display intermediate values if requested
     if (showSteps) {
-        std::cout << "\nPerforming integration using Simpson's 3/8 Rule" << std::endl;
-        displayIntermediateValues();
+        step() << "\nPerforming integration using Simpson's 3/8 Rule";
+        reportSamples();
     }
     
     // Simpson's 3/8 Rule Formula: 3h/8 * [f(a) + f(b) + 3 * sum(f(not divisible by 3)) + 2 * sum(f(divisible by 3))]
     double h = calculateStepSize();
-    double sum = yValues[0] + yValues[input.getIntervals()]; // f(a) + f(b)
-    double sumMultiple3 = 0.0;
-    double sumNotMultiple3 = 0.0;
-    
-    for (int i = 1; i < input.getIntervals(); ++i) {
-        if (i % 3 == 0) {
-            sumMultiple3 += yValues[i];
-        } else {
-            sumNotMultiple3 += yValues[i];
-        }
-    }
+    double fa = sampleAt(0);
+    double fb = sampleAt(input.getIntervals());
+    double sum = fa + fb; // f(a) + f(b)
+    std::array<double, 4> sums = sumInteriorByResidue(3);
+    double sumMultiple3 = sums[0];
+    double sumNotMultiple3 = sums[1] + sums[2];
     
     if (showSteps) {
-        std::cout << "\nApplying Simpson's 3/8 Rule formula: 3h/8 * [f(a) + f(b) + 3 * sum(f(not divisible by 3)) + 2 * sum(f(divisible by 3))]" << std::endl;
-        std::cout << "h = " << h << std::endl;
-        std::cout << "f(a) + f(b) = " << yValues[0] << " + " << yValues[input.getIntervals()] 
-                  << " = " << (yValues[0] + yValues[input.getIntervals()]) << std::endl;
-        std::cout << "sum of f(x) at indices divisible by 3 = " << sumMultiple3 << std::endl;
-        std::cout << "sum of f(x) at indices not divisible by 3 = " << sumNotMultiple3 << std::endl;
+        step() << "\nApplying Simpson's 3/8 Rule formula: 3h/8 * [f(a) + f(b) + 3 * sum(f(not divisible by 3)) + 2 * sum(f(divisible by 3))]";
+        step() << "h = " << h;
+        step() << "f(a) + f(b) = " << fa << " + " << fb 
+               << " = " << (fa + fb);
+        step() << "sum of f(x) at indices divisible by 3 = " << sumMultiple3;
+        step() << "sum of f(x) at indices not divisible by 3 = " << sumNotMultiple3;
         
-        utils::sleep(500);
+        pause(500);
     }
     
     sum += 2 * sumMultiple3 + 3 * sumNotMultiple3;
-    result = (3 * h / 8) * sum;
+    result = rules::SimpsonThreeEighth::combine(fa, fb, sums.data(), h);
+    evaluations = input.getIntervals() + 1;
     
     if (showSteps) {
-        std::cout << "\nFinal calculation:" << std::endl;
-        std::cout << "(3 * " << h << "/8) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + 2 * " << sumMultiple3 << " + 3 * " << sumNotMultiple3 << ")" << std::endl;
-        std::cout << "(3 * " << h << "/8) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + " << (2 * sumMultiple3) << " + " << (3 * sumNotMultiple3) << ")" << std::endl;
-        std::cout << "(3 * " << h << "/8) * " << sum << std::endl;
-        std::cout << "Result = " << result << std::endl;
+        step() << "\nFinal calculation:";
+        step() << "(3 * " << h << "/8) * (" << (fa + fb) 
+               << " + 2 * " << sumMultiple3 << " + 3 * " << sumNotMultiple3 << ")";
+        step() << "(3 * " << h << "/8) * (" << (fa + fb) 
+               << " + " << (2 * sumMultiple3) << " + " << (3 * sumNotMultiple3) << ")";
+        step() << "(3 * " << h << "/8) * " << sum;
+        step() << "Result = " << result;
     }
     
     return result;
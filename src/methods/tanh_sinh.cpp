@@ -0,0 +1,248 @@
+#include "../../include/methods/tanh_sinh.h"
+#include "../../include/utils.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+constexpr long double HALF_PI = 1.570796326794896619231321691639751442L;
+
+// The nodes next to one endpoint: the two nearest that were evaluated and the
+// nearest that was left out because it rounds onto the endpoint
+struct EndpointNodes {
+    double nearest = 1.0;          // Distance of the nearest evaluated node
+    double nearestValue = 0.0;     // |f| there
+    double next = 1.0;             // Distance of the second nearest
+    double nextValue = 0.0;        // |f| there
+    double skipped = 0.0;          // Distance of the nearest skipped node (0 = none)
+    double skippedWeight = 0.0;    // Its weight
+
+    void addEvaluated(double distance, double value) {
+        if (distance < nearest) {
+            next = nearest;
+            nextValue = nearestValue;
+            nearest = distance;
+            nearestValue = value;
+        } else if (distance < next) {
+            next = distance;
+            nextValue = value;
+        }
+    }
+
+    void addSkipped(double distance, double weight) {
+        if (distance > skipped) {
+            skipped = distance;
+            skippedWeight = weight;
+        }
+    }
+
+    // w * |f| at the nearest skipped node, with f extrapolated from the two
+    // nearest evaluated nodes as a power d^-p of the distance (0 <= p <= 1)
+    double skippedTerm() const {
+        if (skipped == 0.0 || nearestValue == 0.0) {
+            return 0.0;
+        }
+        double power = 0.0;
+        if (nextValue > 0.0 && next > nearest) {
+            power = std::log(nearestValue / nextValue) / std::log(next / nearest);
+            power = std::min(std::max(power, 0.0), 1.0);
+        }
+        return skippedWeight * nearestValue * std::pow(nearest / skipped, power);
+    }
+};
+
+} // namespace
+
+TanhSinh::TanhSinh(const Input& input, const Function& function, double tolerance, int maxLevel)
+    : Integrator(input, function), tolerance(tolerance), maxLevel(maxLevel),
+      errorEstimate(std::numeric_limits<double>::quiet_NaN()), reachedLevel(0) {
+    if (this->tolerance < 0.0) {
+        this->tolerance = 0.0;
+    }
+    this->maxLevel = std::min(std::max(maxLevel, 0), MAX_LEVEL);
+}
+
+const TanhSinh::Level& TanhSinh::getLevel(int level) {
+    if (level < 0 || level > MAX_LEVEL) {
+        throw std::invalid_argument("Tanh-sinh levels range from 0 to " + std::to_string(MAX_LEVEL));
+    }
+
+    // Levels are created on first use and never removed, so references stay valid
+    static std::mutex cacheMutex;
+    static std::array<std::unique_ptr<const Level>, MAX_LEVEL + 1> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!cache[level]) {
+        cache[level] = std::make_unique<const Level>(computeLevel(level));
+    }
+    return *cache[level];
+}
+
+TanhSinh::Level TanhSinh::computeLevel(int level) {
+    Level result;
+    result.step = std::ldexp(1.0, -level);
+
+    // Level 0 has the nodes t = 0, 1, 2, ...; level k the odd multiples of 2^-k
+    const long double h = result.step;
+    for (long long j = 0;; ++j) {
+        long double t = level == 0 ? j * h : (2 * j + 1) * h;
+        long double u = HALF_PI * std::sinh(t);
+        // 1 - tanh(u) = 2 / (exp(2u) + 1), without the cancellation
+        long double distance = 2.0L / (std::exp(2.0L * u) + 1.0L);
+        long double coshU = std::cosh(u);
+        long double weight = HALF_PI * std::cosh(t) / (coshU * coshU);
+        if (static_cast<double>(distance) < std::numeric_limits<double>::min()
+            || static_cast<double>(weight) == 0.0) {
+            break;
+        }
+        result.distances.push_back(static_cast<double>(distance));
+        result.weights.push_back(static_cast<double>(weight));
+    }
+    return result;
+}
+
+double TanhSinh::compute(bool showSteps) {
+    const double a = input.getLowerBound();
+    const double b = input.getUpperBound();
+    const double halfWidth = 0.5 * (b - a);
+
+    if (showSteps) {
+        step() << "\nPerforming integration using tanh-sinh quadrature";
+        step() << "x = (a+b)/2 + (b-a)/2 * tanh(pi/2 * sinh(t)), trapezoidal rule in t";
+        if (tolerance > 0.0) {
+            step() << "Tolerance: " << tolerance;
+        }
+        step() << "\n" << std::setw(6) << "Level" << std::setw(12) << "Step" << std::setw(10) << "Nodes"
+               << std::setw(24) << "Estimate" << std::setw(14) << "Change";
+        step() << std::string(66, '-');
+    }
+
+    Accumulator total(summation);   // Sum of w * f over all levels so far
+    double previous = 0.0;
+    evaluations = 0;
+    errorEstimate = std::numeric_limits<double>::quiet_NaN();
+
+    // The sum leaves out the nodes that round onto an endpoint; their terms,
+    // estimated from the first one left out, bound the accuracy
+    EndpointNodes lowEnd;
+    EndpointNodes highEnd;
+    double truncation = 0.0;
+    bool limited = false;
+
+    for (int level = 0; level <= maxLevel; ++level) {
+        const Level& nodes = getLevel(level);
+        const std::size_t count = nodes.distances.size();
+
+        // Evaluate the new nodes in batches, skipping those that round onto an endpoint
+        double x[BATCH_SIZE];
+        double w[BATCH_SIZE];
+        double y[BATCH_SIZE];
+        double d[BATCH_SIZE];
+        bool low[BATCH_SIZE];
+        Accumulator levelSum(summation);
+        long long levelNodes = 0;
+        int filled = 0;
+        auto flush = [&]() {
+            evaluateBatch(x, y, filled);
+            for (int k = 0; k < filled; ++k) {
+                (low[k] ? lowEnd : highEnd).addEvaluated(d[k], std::abs(y[k]));
+                y[k] *= w[k];
+            }
+            levelSum.add(y, filled);
+            levelNodes += filled;
+            filled = 0;
+        };
+        for (std::size_t j = 0; j < count; ++j) {
+            const double offset = halfWidth * nodes.distances[j];
+            const double left = a + offset;
+            const double right = b - offset;
+            const bool centre = level == 0 && j == 0;
+            if (left <= a) {
+                lowEnd.addSkipped(nodes.distances[j], nodes.weights[j]);
+            }
+            if (right >= b) {
+                highEnd.addSkipped(nodes.distances[j], nodes.weights[j]);
+            }
+            if (left <= a && right >= b) {
+                break; // Every later node is even closer to the endpoints
+            }
+            if (filled + 2 > BATCH_SIZE) {
+                flush();
+            }
+            if (left > a) {
+                x[filled] = left;
+                w[filled] = nodes.weights[j];
+                d[filled] = nodes.distances[j];
+                low[filled++] = true;
+            }
+            if (!centre && right < b) {
+                x[filled] = right;
+                w[filled] = nodes.weights[j];
+                d[filled] = nodes.distances[j];
+                low[filled++] = false;
+            }
+        }
+        if (filled > 0) {
+            flush();
+        }
+
+        total.add(levelSum);
+        evaluations += levelNodes;
+        result = halfWidth * nodes.step * total.total();
+        reachedLevel = level;
+
+        const double change = std::abs(result - previous);
+        truncation = halfWidth * nodes.step * (lowEnd.skippedTerm() + highEnd.skippedTerm());
+        if (level > 0) {
+            errorEstimate = change + truncation;
+        }
+        if (showSteps) {
+            step() << std::setw(6) << level << std::setw(12) << nodes.step << std::setw(10) << levelNodes
+                   << std::setw(24) << utils::formatNumber(result, 16) << std::setw(14)
+                   << (level > 0 ? utils::formatNumber(change, 3) : std::string("-"));
+        }
+        if (level > 0 && tolerance > 0.0) {
+            if (errorEstimate <= std::max(tolerance, tolerance * std::abs(result))) {
+                break;
+            }
+            // Once the levels agree to within the truncation, finer levels cannot help
+            if (change <= truncation) {
+                limited = true;
+                break;
+            }
+        }
+        previous = result;
+    }
+
+    if (showSteps) {
+        step() << "\nTruncation at the endpoints: " << truncation;
+        if (limited) {
+            step() << "The tolerance cannot be met: nodes closer to the endpoints round onto them";
+        }
+        step() << "Function evaluations: " << evaluations;
+        step() << "Result = " << result;
+    }
+    return result;
+}
+
+std::string TanhSinh::getMethodName() const {
+    return "Tanh-Sinh";
+}
+
+double TanhSinh::getErrorEstimate() const {
+    return errorEstimate;
+}
+
+int TanhSinh::getReachedLevel() const {
+    return reachedLevel;
+}
+
+} // namespace numerical
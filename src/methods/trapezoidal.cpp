@@ -1,7 +1,5 @@
 #include "../../include/methods/trapezoidal.h"
-#include "../../include/utils.h"
-#include <iostream>
-#include <iomanip>
+#include "../../include/methods/inline_rules.h"
 
 namespace numerical {
 
@@ -9,47 +7,51 @@ TrapezoidalRule::TrapezoidalRule(const Input& input, const Function& function)
     : Integrator(input, function) {
 }
 
-double TrapezoidalRule::calculate(bool showSteps) {
-    // Generate x and y values
-    generatePoints();
+double TrapezoidalRule::compute(bool showSteps) {
+    if (grid) {
+        return computeOnGrid(1, showSteps);
+    }
+    
+    // Store x and y values only when they are displayed; otherwise stream them
+    preparePoints(showSteps);
     
     // Display intermediate values if requested
     if (showSteps) {
-        std::cout << "\nPerforming integration using the Trapezoidal Rule" << std::endl;
-        displayIntermediateValues();
+        step() << "\nPerforming integration using the Trapezoidal Rule";
+        reportSamples();
     }
     
     // Trapezoidal Rule Formula: h/2 * [f(a) + f(b) + 2 * sum(f(x_i))]
     double h = calculateStepSize();
-    double sum = yValues[0] + yValues[input.getIntervals()]; // f(a) + f(b)
-    double intermediateSum = 0.0;
-    
-    for (int i = 1; i < input.getIntervals(); ++i) {
-        intermediateSum += yValues[i];
-    }
+    double fa = sampleAt(0);
+    double fb = sampleAt(input.getIntervals());
+    double sum = fa + fb; // f(a) + f(b)
+    std::array<double, 4> sums = sumInteriorByResidue(1);
+    double intermediateSum = sums[0];
     
     if (showSteps) {
-        std::cout << "\nApplying Trapezoidal Rule formula: h/2 * [f(a) + f(b) + 2 * sum(f(x_i))]" << std::endl;
-        std::cout << "h = " << h << std::endl;
-        std::cout << "f(a) + f(b) = " << yValues[0] << " + " << yValues[input.getIntervals()] 
-                  << " = " << (yValues[0] + yValues[input.getIntervals()]) << std::endl;
-        std::cout << "sum(f(x_i)) for i=1 to " << (input.getIntervals() - 1) 
-                  << " = " << intermediateSum << std::endl;
+        step() << "\nApplying Trapezoidal Rule formula: h/2 * [f(a) + f(b) + 2 * sum(f(x_i))]";
+        step() << "h = " << h;
+        step() << "f(a) + f(b) = " << fa << " + " << fb 
+               << " = " << (fa + fb);
+        step() << "sum(f(x_i)) for i=1 to " << (input.getIntervals() - 1) 
+               << " = " << intermediateSum;
         
-        utils::sleep(500);
+        pause(500);
     }
     
     sum += 2 * intermediateSum;
-    result = (h / 2) * sum;
+    result = rules::Trapezoidal::combine(fa, fb, sums.data(), h);
+    evaluations = input.getIntervals() + 1;
     
     if (showSteps) {
-        std::cout << "\nFinal calculation:" << std::endl;
-        std::cout << "(" << h << "/2) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + 2 * " << intermediateSum << ")" << std::endl;
-        std::cout << "(" << h << "/2) * (" << (yValues[0] + yValues[input.getIntervals()]) 
-                  << " + " << (2 * intermediateSum) << ")" << std::endl;
-        std::cout << "(" << h << "/2) * " << sum << std::endl;
-        std::cout << "Result = " << result << std::endl;
+        step() << "\nFinal calculation:";
+        step() << "(" << h << "/2) * (" << (fa + fb) 
+               << " + 2 * " << intermediateSum << ")";
+        step() << "(" << h << "/2) * (" << (fa + fb) 
+               << " + " << (2 * intermediateSum) << ")";
+        step() << "(" << h << "/2) * " << sum;
+        step() << "Result = " << result;
     }
     
     return result;
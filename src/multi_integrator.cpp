@@ -0,0 +1,203 @@
+#include "../include/multi_integrator.h"
+#include "../include/evaluation.h"
+#include "../include/methods/inline_rules.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+// Combine the endpoint values and residue-class sums with the rule of a panel width
+double combine(int panel, double fa, double fb, const double* sums, double h) {
+    switch (panel) {
+        case 1:
+            return rules::Trapezoidal::combine(fa, fb, sums, h);
+        case 2:
+            return rules::SimpsonOneThird::combine(fa, fb, sums, h);
+        case 3:
+            return rules::SimpsonThreeEighth::combine(fa, fb, sums, h);
+        default:
+            return rules::Boole::combine(fa, fb, sums, h);
+    }
+}
+
+} // namespace
+
+MultiIntegrator::MultiIntegrator(const Input& input, const std::vector<Function>& integrands, int panel)
+    : input(input), integrands(integrands), panel(panel), summation(Summation::Naive),
+      observer(nullptr) {
+    if (integrands.empty()) {
+        throw std::invalid_argument("At least one integrand is needed");
+    }
+    if (panel < 1 || panel > 4) {
+        throw std::invalid_argument("The panel width must be 1, 2, 3 or 4");
+    }
+}
+
+void MultiIntegrator::setThreadCount(unsigned threads) {
+    blocks.setThreadCount(threads);
+}
+
+void MultiIntegrator::setSummation(Summation method) {
+    summation = method;
+}
+
+std::vector<IntegrationResult> MultiIntegrator::integrate(IntegrationObserver* observer) {
+    this->observer = observer;
+    bool showSteps = observer != nullptr && observer->wantsSteps();
+
+    std::vector<IntegrationResult> outcomes(integrands.size());
+    const int n = input.getIntervals();
+    if (n < 1 || n % panel != 0) {
+        if (observer) {
+            observer->onNotApplicable(getMethodName() + " requires a number of intervals divisible by "
+                                      + std::to_string(panel) + ".");
+        }
+        this->observer = nullptr;
+        for (IntegrationResult& outcome : outcomes) {
+            outcome.applicable = false;
+        }
+        return outcomes;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<double> values;
+    try {
+        values = compute(showSteps);
+    } catch (...) {
+        this->observer = nullptr;
+        throw;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    this->observer = nullptr;
+
+    for (std::size_t j = 0; j < outcomes.size(); ++j) {
+        outcomes[j].value = values[j];
+        outcomes[j].errorEstimate = std::numeric_limits<double>::quiet_NaN();
+        outcomes[j].evaluations = static_cast<long long>(n) + 1;
+        outcomes[j].seconds = seconds;
+    }
+    return outcomes;
+}
+
+std::vector<double> MultiIntegrator::compute(bool showSteps) {
+    static_assert(rules::BLOCK_INTERVALS == BLOCK_INTERVALS,
+                  "MultiIntegrator must block the grid like Integrator");
+
+    const std::size_t k = integrands.size();
+    const int n = input.getIntervals();
+    const double a = input.getLowerBound();
+    const double h = (input.getUpperBound() - a) / n;
+    const int blockCount = n / BLOCK_INTERVALS + 1;
+
+    if (showSteps) {
+        step() << "\nPerforming integration of " << k << " functions using " << getMethodName();
+        step() << "Intervals: " << n << ", h = " << h;
+        step() << "Grid points: " << n + 1 << " in " << blockCount << " blocks";
+    }
+
+    // Interior sums per block: integrand j, residue class r at [j * panel + r]
+    std::vector<std::vector<Accumulator>> blockSums(blockCount);
+    blocks.run(blockCount, [&](std::size_t block) {
+        std::vector<Accumulator> sums(k * panel, Accumulator(summation));
+        const long long first = static_cast<long long>(block) * BLOCK_INTERVALS;
+        const int begin = static_cast<int>(std::max(first, 1LL));
+        const int end = static_cast<int>(std::min(first + BLOCK_INTERVALS, static_cast<long long>(n)));
+
+        // One row of batch values and, for naive summation, one row of lanes per integrand
+        const int laneCount = rules::laneCount(panel);
+        std::vector<double> lanes(summation == Summation::Naive ? k * MAX_INTERLEAVED_LANES : 0, 0.0);
+        std::vector<double> y(k * BATCH_SIZE);
+        double x[BATCH_SIZE];
+        for (int start = begin; start < end; start += BATCH_SIZE) {
+            const int count = std::min(BATCH_SIZE, end - start);
+            for (int i = 0; i < count; ++i) {
+                x[i] = a + (start + i) * h;
+            }
+            for (std::size_t j = 0; j < k; ++j) {
+                double* row = &y[j * BATCH_SIZE];
+                evaluateOrZero(integrands[j], x, row, count, observer);
+                if (summation == Summation::Naive) {
+                    addInterleaved(row, count, static_cast<int>((start - first) % laneCount),
+                                   &lanes[j * MAX_INTERLEAVED_LANES], laneCount);
+                } else {
+                    // row[i] belongs to class (start + i) % panel; add each class as a strided run
+                    for (int i = 0; i < panel && i < count; ++i) {
+                        sums[j * panel + (start + i) % panel].add(row + i, (count - i + panel - 1) / panel, panel);
+                    }
+                }
+            }
+        }
+        if (summation == Summation::Naive) {
+            for (std::size_t j = 0; j < k; ++j) {
+                for (int r = 0; r < panel; ++r) {
+                    for (int lane = r; lane < laneCount; lane += panel) {
+                        sums[j * panel + r].add(lanes[j * MAX_INTERLEAVED_LANES + lane]);
+                    }
+                }
+            }
+        }
+        blockSums[block] = std::move(sums);
+    });
+
+    // The endpoints, at the same abscissas as the rule classes use
+    const double ends[2] = {a, a + n * h};
+    std::vector<double> endValues(2 * k);
+    for (std::size_t j = 0; j < k; ++j) {
+        evaluateOrZero(integrands[j], ends, &endValues[2 * j], 2, observer);
+    }
+
+    // Combine the block sums in a fixed order, independent of the thread count
+    std::vector<double> results(k);
+    for (std::size_t j = 0; j < k; ++j) {
+        std::array<Accumulator, 4> totals;
+        totals.fill(Accumulator(summation));
+        for (const std::vector<Accumulator>& sums : blockSums) {
+            for (int r = 0; r < panel; ++r) {
+                totals[r].add(sums[j * panel + r]);
+            }
+        }
+        double sums[4] = {0.0, 0.0, 0.0, 0.0};
+        for (int r = 0; r < panel; ++r) {
+            sums[r] = totals[r].total();
+        }
+        results[j] = combine(panel, endValues[2 * j], endValues[2 * j + 1], sums, h);
+
+        if (showSteps) {
+            step() << "\nf" << j + 1 << "(x) = " << integrands[j].getDescription();
+            step() << "f(a) + f(b) = " << endValues[2 * j] + endValues[2 * j + 1];
+            for (int r = 0; r < panel; ++r) {
+                step() << "sum of f(x_i) with i % " << panel << " = " << r << ": " << sums[r];
+            }
+            step() << "Result = " << results[j];
+        }
+    }
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << k << " x " << n + 1;
+    }
+    return results;
+}
+
+StepWriter MultiIntegrator::step() const {
+    return StepWriter(observer);
+}
+
+std::string MultiIntegrator::getMethodName() const {
+    switch (panel) {
+        case 1:
+            return "Trapezoidal Rule";
+        case 2:
+            return "Simpson's 1/3 Rule";
+        case 3:
+            return "Simpson's 3/8 Rule";
+        default:
+            return "Boole's Rule";
+    }
+}
+
+} // namespace numerical
@@ -0,0 +1,139 @@
+#include "../include/parametric_sweep.h"
+#include "../include/evaluation.h"
+#include "../include/methods/gauss_legendre.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace numerical {
+
+ParametricSweep::ParametricSweep(const Expression& integrand, double lowerBound, double upperBound,
+                                 const std::string& method, int intervals)
+    : integrand(integrand), lowerBound(lowerBound), upperBound(upperBound), method(method), intervals(intervals),
+      gaussPoints(4), summation(Summation::Naive), observer(nullptr), evaluations(0) {
+    if (integrand.getVariables() != std::vector<std::string>{"x", "p"}) {
+        throw std::invalid_argument("The integrand must be an expression of x and p");
+    }
+    Cubature::createRule(method, intervals, 1);   // Validates the method and intervals
+}
+
+void ParametricSweep::setGaussPoints(int points) {
+    if (points < 1 || points > GaussLegendre::MAX_POINTS) {
+        throw std::invalid_argument("Gauss-Legendre points must be between 1 and "
+                                    + std::to_string(GaussLegendre::MAX_POINTS));
+    }
+    gaussPoints = points;
+}
+
+void ParametricSweep::setThreadCount(unsigned threads) {
+    blocks.setThreadCount(threads);
+}
+
+void ParametricSweep::setSummation(Summation method) {
+    summation = method;
+}
+
+std::vector<double> ParametricSweep::integrate(const std::vector<double>& parameters,
+                                               IntegrationObserver* observer) {
+    std::vector<double> results(parameters.size());
+    integrate(parameters.data(), parameters.size(), results.data(), observer);
+    return results;
+}
+
+void ParametricSweep::integrate(const double* parameters, std::size_t count, double* results,
+                                IntegrationObserver* observer) {
+    this->observer = observer;
+    const bool showSteps = observer != nullptr && observer->wantsSteps();
+
+    // The rule on [a, b]: nodes and weights shared by every parameter value
+    const Cubature::Rule rule = Cubature::createRule(method, intervals, gaussPoints);
+    const long long nodeCount = static_cast<long long>(rule.nodes.size());
+    const double width = upperBound - lowerBound;
+    std::vector<double> nodes(nodeCount);
+    std::vector<double> weights(nodeCount);
+    for (long long j = 0; j < nodeCount; ++j) {
+        nodes[j] = lowerBound + rule.nodes[j] * width;
+        weights[j] = rule.weights[j] * width;
+    }
+    const long long tileCount = (static_cast<long long>(count) + PARAMETER_TILE - 1) / PARAMETER_TILE;
+
+    if (showSteps) {
+        step() << "\nPerforming a parametric sweep using " << getMethodName();
+        step() << "Integrand: " << integrand.getText() << " on [" << lowerBound << ", " << upperBound << "]";
+        step() << "Parameter values: " << count << " in " << tileCount << " tiles of up to " << PARAMETER_TILE;
+        step() << "Nodes: " << nodeCount << ", evaluated " << NODE_TILE << " at a time per tile";
+    }
+
+    try {
+        blocks.run(tileCount, [&](std::size_t tile) {
+            const std::size_t first = tile * PARAMETER_TILE;
+            const int n = static_cast<int>(std::min<std::size_t>(PARAMETER_TILE, count - first));
+
+            // Point t * n + i of a call is node t of the call with parameter i of the tile
+            std::vector<double> x(NODE_TILE * n);
+            std::vector<double> p(NODE_TILE * n);
+            std::vector<double> y(NODE_TILE * n);
+            for (int t = 0; t < NODE_TILE; ++t) {
+                std::copy(parameters + first, parameters + first + n, p.begin() + t * n);
+            }
+            const double* variables[2] = {x.data(), p.data()};
+
+            std::vector<Accumulator> sums(n, Accumulator(summation));
+            for (long long node = 0; node < nodeCount; node += NODE_TILE) {
+                const int tileNodes = static_cast<int>(std::min<long long>(NODE_TILE, nodeCount - node));
+                for (int t = 0; t < tileNodes; ++t) {
+                    std::fill(x.begin() + t * n, x.begin() + (t + 1) * n, nodes[node + t]);
+                }
+                evaluateOrZero(integrand, variables, y.data(), tileNodes * n, observer);
+                for (int t = 0; t < tileNodes; ++t) {
+                    const double w = weights[node + t];
+                    double* row = y.data() + t * n;
+                    for (int i = 0; i < n; ++i) {
+                        row[i] *= w;
+                    }
+                }
+
+                // Column i holds the weighted values of parameter i
+                for (int i = 0; i < n; ++i) {
+                    sums[i].add(y.data() + i, tileNodes, n);
+                }
+            }
+            for (int i = 0; i < n; ++i) {
+                results[first + i] = sums[i].total();
+            }
+        });
+    } catch (...) {
+        this->observer = nullptr;
+        throw;
+    }
+    evaluations = nodeCount * static_cast<long long>(count);
+
+    if (showSteps) {
+        step() << "\nFunction evaluations: " << evaluations;
+        const std::size_t shown = std::min<std::size_t>(count, 5);
+        for (std::size_t i = 0; i < shown; ++i) {
+            step() << "p = " << parameters[i] << ": result = " << results[i];
+        }
+        if (count > shown) {
+            step() << "... (" << count - shown << " more)";
+        }
+    }
+    this->observer = nullptr;
+}
+
+long long ParametricSweep::getEvaluationCount() const {
+    return evaluations;
+}
+
+StepWriter ParametricSweep::step() const {
+    return StepWriter(observer);
+}
+
+std::string ParametricSweep::getMethodName() const {
+    const std::string rule = Cubature::getRuleName(method);
+    if (method == "gauss") {
+        return rule + " (" + std::to_string(intervals) + " panels, " + std::to_string(gaussPoints) + " points each)";
+    }
+    return rule + " (" + std::to_string(intervals) + " intervals)";
+}
+
+} // namespace numerical
@@ -0,0 +1,115 @@
+#include "../include/region.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+const char* const VARIABLE_NAMES[Region::MAX_DIMENSION] = {"x", "y", "z"};
+
+void checkDimension(std::size_t lowerCount, std::size_t upperCount) {
+    if (lowerCount != upperCount) {
+        throw std::invalid_argument("A region needs as many lower as upper bounds");
+    }
+    if (lowerCount < 1 || lowerCount > static_cast<std::size_t>(Region::MAX_DIMENSION)) {
+        throw std::invalid_argument("A region has 1 to " + std::to_string(Region::MAX_DIMENSION)
+                                    + " dimensions");
+    }
+}
+
+} // namespace
+
+Region Region::box(const std::vector<double>& lower, const std::vector<double>& upper) {
+    checkDimension(lower.size(), upper.size());
+    for (std::size_t k = 0; k < lower.size(); ++k) {
+        if (!std::isfinite(lower[k]) || !std::isfinite(upper[k])) {
+            throw std::invalid_argument("The bounds of a region must be finite");
+        }
+    }
+
+    Region region({}, {});
+    for (std::size_t k = 0; k < lower.size(); ++k) {
+        region.bounds.push_back({nullptr, nullptr, true, lower[k], upper[k]});
+    }
+    return region;
+}
+
+Region::Region(const std::vector<std::string>& lower, const std::vector<std::string>& upper) {
+    // The empty region is only built by box(), which fills in the bounds
+    if (lower.empty() && upper.empty()) {
+        return;
+    }
+    checkDimension(lower.size(), upper.size());
+
+    for (std::size_t k = 0; k < lower.size(); ++k) {
+        std::vector<std::string> outer(VARIABLE_NAMES, VARIABLE_NAMES + k);
+        Bounds dimension;
+        dimension.lower = std::make_shared<const Expression>(lower[k], outer);
+        dimension.upper = std::make_shared<const Expression>(upper[k], outer);
+        dimension.constant = dimension.lower->isConstant() && dimension.upper->isConstant();
+        dimension.lowerValue = 0.0;
+        dimension.upperValue = 0.0;
+        if (dimension.constant) {
+            // The value does not depend on the point, so any point will do
+            const double origin = 0.0;
+            const double* point[MAX_DIMENSION] = {&origin, &origin, &origin};
+            try {
+                dimension.lower->evaluate(point, &dimension.lowerValue, 1);
+                dimension.upper->evaluate(point, &dimension.upperValue, 1);
+            } catch (const std::domain_error&) {
+                throw std::invalid_argument("The bounds of " + std::string(VARIABLE_NAMES[k])
+                                            + " are undefined");
+            }
+        }
+        bounds.push_back(dimension);
+    }
+}
+
+int Region::getDimension() const {
+    return static_cast<int>(bounds.size());
+}
+
+std::vector<std::string> Region::getVariables() const {
+    return std::vector<std::string>(VARIABLE_NAMES, VARIABLE_NAMES + bounds.size());
+}
+
+bool Region::hasConstantBounds(int dimension) const {
+    return bounds[dimension].constant;
+}
+
+bool Region::isBox() const {
+    return std::all_of(bounds.begin(), bounds.end(), [](const Bounds& b) { return b.constant; });
+}
+
+void Region::getBounds(int dimension, const double* const* outer, double* lower, double* upper,
+                       std::size_t count) const {
+    const Bounds& b = bounds[dimension];
+    if (b.constant) {
+        std::fill(lower, lower + count, b.lowerValue);
+        std::fill(upper, upper + count, b.upperValue);
+        return;
+    }
+    b.lower->evaluate(outer, lower, count);
+    b.upper->evaluate(outer, upper, count);
+}
+
+std::string Region::getDescription() const {
+    std::ostringstream text;
+    for (std::size_t k = 0; k < bounds.size(); ++k) {
+        const Bounds& b = bounds[k];
+        if (k > 0) {
+            text << ", ";
+        }
+        if (b.lower) {
+            text << b.lower->getText() << " <= " << VARIABLE_NAMES[k] << " <= " << b.upper->getText();
+        } else {
+            text << b.lowerValue << " <= " << VARIABLE_NAMES[k] << " <= " << b.upperValue;
+        }
+    }
+    return text.str();
+}
+
+} // namespace numerical
@@ -0,0 +1,55 @@
+#include "../include/sample_cache.h"
+
+namespace numerical {
+
+SampleCache::SampleCache(std::size_t maxSamples)
+    : maxSamples(maxSamples), storedSamples(0), evaluationCount(0) {
+}
+
+const double* SampleCache::find(const Function& function, double a, double b, long long n,
+                                long long& stride) const {
+    if (n < 1) {
+        return nullptr;
+    }
+    for (const Grid& grid : grids) {
+        if (grid.function != &function || grid.a != a || grid.b != b || grid.n % n != 0) {
+            continue;
+        }
+        // Only power-of-two refinements reproduce the coarse points exactly
+        long long ratio = grid.n / n;
+        if ((ratio & (ratio - 1)) == 0) {
+            stride = ratio;
+            return grid.data;
+        }
+    }
+    return nullptr;
+}
+
+bool SampleCache::canStore(long long n) const {
+    return n >= 1 && static_cast<std::size_t>(n) + 1 <= maxSamples - storedSamples;
+}
+
+const double* SampleCache::store(const Function& function, double a, double b, long long n,
+                                 std::vector<double> values) {
+    storedSamples += values.size();
+    evaluationCount += static_cast<long long>(values.size());
+    grids.push_back({&function, a, b, n, nullptr, std::move(values)});
+    grids.back().data = grids.back().values.data();
+    return grids.back().data;
+}
+
+void SampleCache::attach(const Function& function, double a, double b, long long n, const double* values) {
+    grids.push_back({&function, a, b, n, values, {}});
+}
+
+long long SampleCache::getEvaluationCount() const {
+    return evaluationCount;
+}
+
+void SampleCache::clear() {
+    grids.clear();
+    storedSamples = 0;
+    evaluationCount = 0;
+}
+
+} // namespace numerical
@@ -0,0 +1,226 @@
+#include "../include/sample_file.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NUMERICAL_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace numerical {
+
+namespace {
+
+/*
+ * Layout (native byte order, checked through BYTE_ORDER_MARK):
+ *
+ *   0  char[8]   SIGNATURE
+ *   8  uint32    BYTE_ORDER_MARK
+ *  12  uint32    offset of the values (multiple of 8)
+ *  16  double    lower bound
+ *  24  double    upper bound
+ *  32  int64     intervals
+ *  40  int32     predefined function index (0 for an expression)
+ *  44  uint32    method length
+ *  48  uint32    description length
+ *  52  uint32    expression length
+ *  56  char[]    method, description, expression, zero padding
+ *      double[]  intervals + 1 values
+ */
+const char SIGNATURE[8] = {'N', 'U', 'M', 'S', 'A', 'M', 'P', '1'};
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const std::size_t FIXED_HEADER_BYTES = 56;
+
+template <typename T>
+void put(std::vector<char>& bytes, std::size_t offset, T value) {
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const char* bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes + offset, sizeof(T));
+    return value;
+}
+
+// Parses the header of a file of size bytes, returning the offset of the values or 0 on error
+std::size_t parseHeader(const char* bytes, std::size_t size, SampleFile::Header& header, std::string& error) {
+    if (size < FIXED_HEADER_BYTES || std::memcmp(bytes, SIGNATURE, sizeof(SIGNATURE)) != 0) {
+        error = "not a sample file";
+        return 0;
+    }
+    if (get<std::uint32_t>(bytes, 8) != BYTE_ORDER_MARK) {
+        error = "the sample file was written with a different byte order";
+        return 0;
+    }
+    std::size_t valuesOffset = get<std::uint32_t>(bytes, 12);
+    header.lowerBound = get<double>(bytes, 16);
+    header.upperBound = get<double>(bytes, 24);
+    header.intervals = get<std::int64_t>(bytes, 32);
+    header.functionChoice = get<std::int32_t>(bytes, 40);
+    std::size_t methodLength = get<std::uint32_t>(bytes, 44);
+    std::size_t descriptionLength = get<std::uint32_t>(bytes, 48);
+    std::size_t expressionLength = get<std::uint32_t>(bytes, 52);
+
+    std::size_t textEnd = FIXED_HEADER_BYTES + methodLength + descriptionLength + expressionLength;
+    if (valuesOffset % sizeof(double) != 0 || textEnd > valuesOffset || valuesOffset > size
+        || header.intervals < 1 || (size - valuesOffset) % sizeof(double) != 0
+        || (size - valuesOffset) / sizeof(double) != static_cast<std::uint64_t>(header.intervals) + 1) {
+        error = "the sample file is truncated or corrupt";
+        return 0;
+    }
+    const char* text = bytes + FIXED_HEADER_BYTES;
+    header.method.assign(text, methodLength);
+    header.description.assign(text + methodLength, descriptionLength);
+    header.expression.assign(text + methodLength + descriptionLength, expressionLength);
+    return valuesOffset;
+}
+
+} // namespace
+
+bool SampleFile::write(const std::string& filename, const Header& header, const Producer& produce,
+                       std::string& error) {
+    if (header.intervals < 1) {
+        error = "a sample file needs at least one interval";
+        return false;
+    }
+
+    std::size_t textBytes = header.method.size() + header.description.size() + header.expression.size();
+    std::size_t valuesOffset = (FIXED_HEADER_BYTES + textBytes + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    std::vector<char> bytes(valuesOffset, 0);
+    std::memcpy(bytes.data(), SIGNATURE, sizeof(SIGNATURE));
+    put<std::uint32_t>(bytes, 8, BYTE_ORDER_MARK);
+    put<std::uint32_t>(bytes, 12, static_cast<std::uint32_t>(valuesOffset));
+    put<double>(bytes, 16, header.lowerBound);
+    put<double>(bytes, 24, header.upperBound);
+    put<std::int64_t>(bytes, 32, header.intervals);
+    put<std::int32_t>(bytes, 40, header.functionChoice);
+    put<std::uint32_t>(bytes, 44, static_cast<std::uint32_t>(header.method.size()));
+    put<std::uint32_t>(bytes, 48, static_cast<std::uint32_t>(header.description.size()));
+    put<std::uint32_t>(bytes, 52, static_cast<std::uint32_t>(header.expression.size()));
+    std::string text = header.method + header.description + header.expression;
+    std::copy(text.begin(), text.end(), bytes.begin() + FIXED_HEADER_BYTES);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "could not create '" + filename + "'";
+        return false;
+    }
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    // One large write per chunk keeps the stream's own buffering out of the way
+    const long long count = header.intervals + 1;
+    std::vector<double> chunk(static_cast<std::size_t>(std::min<long long>(count, CHUNK_VALUES)));
+    for (long long begin = 0; begin < count && file; begin += static_cast<long long>(chunk.size())) {
+        std::size_t size = static_cast<std::size_t>(std::min<long long>(count - begin, chunk.size()));
+        produce(begin, size, chunk.data());
+        file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(size * sizeof(double)));
+    }
+
+    file.close();
+    if (!file) {
+        error = "could not write '" + filename + "'";
+        return false;
+    }
+    return true;
+}
+
+bool SampleFile::isSampleFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char signature[sizeof(SIGNATURE)];
+    return file.read(signature, sizeof(signature)) && std::memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) == 0;
+}
+
+SampleFile::SampleFile() : values(nullptr), mapping(nullptr), mappedBytes(0) {
+}
+
+SampleFile::~SampleFile() {
+    close();
+}
+
+bool SampleFile::open(const std::string& filename, std::string& error) {
+    close();
+
+#ifdef NUMERICAL_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "could not open '" + filename + "'";
+        return false;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size <= 0) {
+        ::close(fd);
+        error = "could not read '" + filename + "'";
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(status.st_size);
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        error = "could not map '" + filename + "'";
+        return false;
+    }
+    // The rules walk the values front to back
+    ::madvise(address, size, MADV_SEQUENTIAL);
+    mapping = address;
+    mappedBytes = size;
+    const char* bytes = static_cast<const char*>(address);
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "could not open '" + filename + "'";
+        return false;
+    }
+    std::size_t size = static_cast<std::size_t>(file.tellg());
+    // A double buffer keeps the values aligned
+    buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size))) {
+        buffer.clear();
+        error = "could not read '" + filename + "'";
+        return false;
+    }
+    const char* bytes = reinterpret_cast<const char*>(buffer.data());
+#endif
+
+    std::size_t valuesOffset = parseHeader(bytes, size, header, error);
+    if (valuesOffset == 0) {
+        error = "'" + filename + "': " + error;
+        close();
+        return false;
+    }
+    values = reinterpret_cast<const double*>(bytes + valuesOffset);
+    return true;
+}
+
+void SampleFile::close() {
+#ifdef NUMERICAL_MMAP
+    if (mapping) {
+        ::munmap(mapping, mappedBytes);
+    }
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+    std::vector<double>().swap(buffer);
+    values = nullptr;
+    header = Header();
+}
+
+bool SampleFile::isOpen() const {
+    return values != nullptr;
+}
+
+const SampleFile::Header& SampleFile::getHeader() const {
+    return header;
+}
+
+const double* SampleFile::getValues() const {
+    return values;
+}
+
+} // namespace numerical
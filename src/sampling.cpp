@@ -0,0 +1,311 @@
+#include "../include/sampling.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace numerical {
+
+namespace {
+
+// Round constants of Philox4x32 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+// 2^-32 and 2^-53
+constexpr double TWO_TO_MINUS_32 = 1.0 / 4294967296.0;
+constexpr double TWO_TO_MINUS_53 = 1.0 / 9007199254740992.0;
+
+// Primitive polynomials and initial direction numbers of the Sobol sequence
+// for dimensions 2 to 8 (Joe and Kuo, new-joe-kuo-6.21201); dimension 1 uses
+// the van der Corput sequence
+struct SobolPolynomial {
+    int degree;
+    std::uint32_t coefficients;
+    std::uint32_t initial[5];
+};
+
+constexpr SobolPolynomial SOBOL_POLYNOMIALS[SamplingSequence::MAX_DIMENSION - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}}
+};
+
+// The first primes, the bases of the Halton sequence
+constexpr std::uint32_t HALTON_BASES[SamplingSequence::MAX_DIMENSION] = {2, 3, 5, 7, 11, 13, 17, 19};
+
+// Index of the lowest zero bit
+inline int lowestZeroBit(std::uint64_t value) {
+    int bit = 0;
+    while (value & 1) {
+        value >>= 1;
+        ++bit;
+    }
+    return bit;
+}
+
+// Radical inverse of index in the given base: the digits mirrored at the point
+double radicalInverse(std::uint64_t index, std::uint32_t base) {
+    const double inverseBase = 1.0 / base;
+    double scale = inverseBase;
+    double value = 0.0;
+    while (index > 0) {
+        value += static_cast<double>(index % base) * scale;
+        index /= base;
+        scale *= inverseBase;
+    }
+    return value;
+}
+
+} // namespace
+
+std::string samplingName(Sampling method) {
+    switch (method) {
+        case Sampling::Pseudo:
+            return "pseudo";
+        case Sampling::Halton:
+            return "halton";
+        default:
+            return "sobol";
+    }
+}
+
+bool parseSampling(const std::string& name, Sampling& method) {
+    for (Sampling candidate : {Sampling::Pseudo, Sampling::Sobol, Sampling::Halton}) {
+        if (samplingName(candidate) == name) {
+            method = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+long long replicateSize(long long points, int replicates, int replicate) {
+    return points / replicates + (replicate < points % replicates ? 1 : 0);
+}
+
+std::string describeReplicates(long long points, int replicates) {
+    const long long size = points / replicates;
+    const long long longer = points % replicates;
+    if (longer == 0) {
+        return std::to_string(replicates) + " x " + std::to_string(size) + " points";
+    }
+    return std::to_string(longer) + " x " + std::to_string(size + 1) + " + "
+           + std::to_string(replicates - longer) + " x " + std::to_string(size) + " points";
+}
+
+void SampleMoments::add(const double* values, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+    // Two passes over the batch, then merge it as a set of its own
+    SampleMoments batch;
+    batch.count = static_cast<long long>(n);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        sum += values[i];
+    }
+    batch.mean = sum / static_cast<double>(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double deviation = values[i] - batch.mean;
+        batch.squares += deviation * deviation;
+    }
+    merge(batch);
+}
+
+void SampleMoments::merge(const SampleMoments& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    const double total = static_cast<double>(count + other.count);
+    const double delta = other.mean - mean;
+    mean += delta * (static_cast<double>(other.count) / total);
+    squares += other.squares + delta * delta * (static_cast<double>(count) * static_cast<double>(other.count) / total);
+    count += other.count;
+}
+
+double SampleMoments::variance() const {
+    return count > 1 ? squares / static_cast<double>(count - 1) : 0.0;
+}
+
+Philox::Philox(std::uint64_t seed) {
+    key[0] = static_cast<std::uint32_t>(seed);
+    key[1] = static_cast<std::uint32_t>(seed >> 32);
+}
+
+std::array<std::uint32_t, 4> Philox::generate(const std::array<std::uint32_t, 4>& counter) const {
+    std::uint32_t c0 = counter[0];
+    std::uint32_t c1 = counter[1];
+    std::uint32_t c2 = counter[2];
+    std::uint32_t c3 = counter[3];
+    std::uint32_t k0 = key[0];
+    std::uint32_t k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+        const std::uint64_t product0 = static_cast<std::uint64_t>(PHILOX_M0) * c0;
+        const std::uint64_t product1 = static_cast<std::uint64_t>(PHILOX_M1) * c2;
+        const std::uint32_t next0 = static_cast<std::uint32_t>(product1 >> 32) ^ c1 ^ k0;
+        const std::uint32_t next1 = static_cast<std::uint32_t>(product1);
+        const std::uint32_t next2 = static_cast<std::uint32_t>(product0 >> 32) ^ c3 ^ k1;
+        const std::uint32_t next3 = static_cast<std::uint32_t>(product0);
+        c0 = next0;
+        c1 = next1;
+        c2 = next2;
+        c3 = next3;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    return {c0, c1, c2, c3};
+}
+
+void Philox::uniforms(std::uint64_t stream, std::uint64_t first, double* u, std::size_t count) const {
+    // Each counter gives two values, from words 0, 1 and from words 2, 3. The
+    // counters of a batch go through the rounds together, one array per word,
+    // so the compiler can run the rounds on SIMD lanes.
+    constexpr std::size_t BATCH = 64;
+    const std::uint32_t streamLow = static_cast<std::uint32_t>(stream);
+    const std::uint32_t streamHigh = static_cast<std::uint32_t>(stream >> 32);
+    const std::uint64_t firstPair = first >> 1;
+    const std::uint64_t endPair = (first + count + 1) >> 1;
+
+    for (std::uint64_t batch = firstPair; batch < endPair; batch += BATCH) {
+        const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(BATCH, endPair - batch));
+        std::uint32_t c0[BATCH];
+        std::uint32_t c1[BATCH];
+        std::uint32_t c2[BATCH];
+        std::uint32_t c3[BATCH];
+        for (std::size_t j = 0; j < n; ++j) {
+            c0[j] = static_cast<std::uint32_t>(batch + j);
+            c1[j] = static_cast<std::uint32_t>((batch + j) >> 32);
+            c2[j] = streamLow;
+            c3[j] = streamHigh;
+        }
+        std::uint32_t k0 = key[0];
+        std::uint32_t k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            for (std::size_t j = 0; j < n; ++j) {
+                const std::uint64_t product0 = static_cast<std::uint64_t>(PHILOX_M0) * c0[j];
+                const std::uint64_t product1 = static_cast<std::uint64_t>(PHILOX_M1) * c2[j];
+                const std::uint32_t next0 = static_cast<std::uint32_t>(product1 >> 32) ^ c1[j] ^ k0;
+                const std::uint32_t next2 = static_cast<std::uint32_t>(product0 >> 32) ^ c3[j] ^ k1;
+                c1[j] = static_cast<std::uint32_t>(product1);
+                c3[j] = static_cast<std::uint32_t>(product0);
+                c0[j] = next0;
+                c2[j] = next2;
+            }
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        // 20 + 32 random bits per value, as an odd multiple of 2^-53: every such
+        // value is exact in a double, so none rounds to 0 or 1
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::uint64_t index = (batch + j) << 1;
+            const std::uint64_t low = (static_cast<std::uint64_t>(c0[j] >> 12) << 32) | c1[j];
+            const std::uint64_t high = (static_cast<std::uint64_t>(c2[j] >> 12) << 32) | c3[j];
+            if (index >= first) {
+                u[index - first] = static_cast<double>((low << 1) | 1) * TWO_TO_MINUS_53;
+            }
+            if (index + 1 < first + count) {
+                u[index + 1 - first] = static_cast<double>((high << 1) | 1) * TWO_TO_MINUS_53;
+            }
+        }
+    }
+}
+
+SamplingSequence::SamplingSequence(Sampling method, int dimension, std::uint64_t seed)
+    : method(method), dimension(dimension), philox(seed) {
+    if (dimension < 1 || dimension > MAX_DIMENSION) {
+        throw std::invalid_argument("Sampling sequences have 1 to " + std::to_string(MAX_DIMENSION)
+                                    + " dimensions");
+    }
+    if (method != Sampling::Sobol) {
+        return;
+    }
+
+    // Direction numbers v_j = m_j / 2^j as 32-bit fractions
+    directions.resize(dimension);
+    for (int bit = 0; bit < SOBOL_BITS; ++bit) {
+        directions[0][bit] = std::uint32_t(1) << (SOBOL_BITS - 1 - bit);
+    }
+    for (int k = 1; k < dimension; ++k) {
+        const SobolPolynomial& polynomial = SOBOL_POLYNOMIALS[k - 1];
+        const int s = polynomial.degree;
+        std::array<std::uint32_t, SOBOL_BITS>& v = directions[k];
+        for (int bit = 0; bit < s; ++bit) {
+            v[bit] = polynomial.initial[bit] << (SOBOL_BITS - 1 - bit);
+        }
+        for (int bit = s; bit < SOBOL_BITS; ++bit) {
+            v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+            for (int j = 1; j < s; ++j) {
+                if ((polynomial.coefficients >> (s - 1 - j)) & 1) {
+                    v[bit] ^= v[bit - j];
+                }
+            }
+        }
+    }
+}
+
+void SamplingSequence::generate(std::uint32_t replicate, std::uint64_t first, std::size_t count,
+                                double* const* coordinates) const {
+    if (count == 0) {
+        return;
+    }
+    for (int k = 0; k < dimension; ++k) {
+        double* u = coordinates[k];
+        switch (method) {
+            case Sampling::Pseudo:
+                philox.uniforms((static_cast<std::uint64_t>(replicate) << 32) | static_cast<std::uint32_t>(k),
+                                first, u, count);
+                break;
+            case Sampling::Sobol: {
+                // Gray-code order: point i is the XOR of the direction numbers of
+                // the bits of i ^ (i >> 1), and consecutive points differ in one
+                const std::array<std::uint32_t, SOBOL_BITS>& v = directions[k];
+                std::uint32_t x = 0;
+                const std::uint64_t gray = first ^ (first >> 1);
+                for (int bit = 0; bit < SOBOL_BITS; ++bit) {
+                    if ((gray >> bit) & 1) {
+                        x ^= v[bit];
+                    }
+                }
+                const std::uint32_t digitalShift = shift(replicate, k);
+                for (std::size_t i = 0; i < count; ++i) {
+                    // The centre of the cell, so no point lies on the boundary
+                    u[i] = (static_cast<double>(x ^ digitalShift) + 0.5) * TWO_TO_MINUS_32;
+                    if (i + 1 < count) {
+                        x ^= v[lowestZeroBit(first + i)];
+                    }
+                }
+                break;
+            }
+            case Sampling::Halton: {
+                const double rotation = (static_cast<double>(shift(replicate, k)) + 0.5) * TWO_TO_MINUS_32;
+                for (std::size_t i = 0; i < count; ++i) {
+                    double value = radicalInverse(first + i + 1, HALTON_BASES[k]) + rotation;
+                    u[i] = value >= 1.0 ? value - 1.0 : value;
+                }
+                break;
+            }
+        }
+    }
+}
+
+Sampling SamplingSequence::getMethod() const {
+    return method;
+}
+
+std::uint32_t SamplingSequence::shift(std::uint32_t replicate, int k) const {
+    // Counters with an all-ones index word, which the point streams never reach
+    return philox.generate({0u, 0xFFFFFFFFu, static_cast<std::uint32_t>(k), replicate})[0];
+}
+
+} // namespace numerical
@@ -0,0 +1,208 @@
+#include "../include/stream_integrator.h"
+#include "../include/methods/inline_rules.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace numerical {
+
+StreamIntegrator::StreamIntegrator(int panel, Summation summation)
+    : panel(panel), summation(summation), layout(Layout::None), lowerBound(0.0), upperBound(1.0), step(0.0),
+      count(0), result(0.0), first(0.0), last(0.0), batch(), batchCount(0), batchStart(1), lanes(),
+      previousX(), previousY(), pointSum(summation) {
+    if (panel < 1 || panel > 4) {
+        throw std::invalid_argument("The panel width must be 1, 2, 3 or 4");
+    }
+    blockSums.fill(Accumulator(summation));
+    totals.fill(Accumulator(summation));
+}
+
+void StreamIntegrator::setBounds(double lowerBound, double upperBound) {
+    this->lowerBound = lowerBound;
+    this->upperBound = upperBound;
+    step = 0.0;
+}
+
+void StreamIntegrator::setStep(double lowerBound, double step) {
+    this->lowerBound = lowerBound;
+    this->step = step;
+}
+
+void StreamIntegrator::addValues(const double* y, std::size_t count) {
+    if (layout == Layout::Points) {
+        throw std::logic_error("Equally spaced values cannot follow (x, y) points");
+    }
+    layout = Layout::Values;
+    for (std::size_t k = 0; k < count; ++k) {
+        if (this->count == 0) {
+            first = y[k];
+        } else if (this->count >= 2) {
+            // The held-back sample is interior now that another one follows
+            commit(this->count - 1, last);
+        }
+        last = y[k];
+        ++this->count;
+    }
+}
+
+void StreamIntegrator::commit(long long i, double value) {
+    if (batchCount == 0) {
+        batchStart = i;
+    }
+    batch[batchCount++] = value;
+    bool blockEnd = (i + 1) % BLOCK_INTERVALS == 0;
+    if (batchCount == BATCH_SIZE || blockEnd) {
+        flushBatch();
+    }
+    if (blockEnd) {
+        flushBlock();
+    }
+}
+
+void StreamIntegrator::flushBatch() {
+    static_assert(rules::BLOCK_INTERVALS == BLOCK_INTERVALS, "StreamIntegrator must block samples like Integrator");
+    if (batchCount == 0) {
+        return;
+    }
+    if (summation == Summation::Naive) {
+        const int laneCount = rules::laneCount(panel);
+        long long blockFirst = batchStart / BLOCK_INTERVALS * BLOCK_INTERVALS;
+        addInterleaved(batch, batchCount, static_cast<int>((batchStart - blockFirst) % laneCount), lanes, laneCount);
+    } else {
+        for (int k = 0; k < panel && k < batchCount; ++k) {
+            blockSums[(batchStart + k) % panel].add(batch + k, (batchCount - k + panel - 1) / panel, panel);
+        }
+    }
+    batchCount = 0;
+}
+
+void StreamIntegrator::flushBlock() {
+    if (summation == Summation::Naive) {
+        const int laneCount = rules::laneCount(panel);
+        for (int r = 0; r < panel; ++r) {
+            for (int lane = r; lane < laneCount; lane += panel) {
+                blockSums[r].add(lanes[lane]);
+            }
+        }
+        std::fill(lanes, lanes + MAX_INTERLEAVED_LANES, 0.0);
+    }
+    for (int r = 0; r < panel; ++r) {
+        totals[r].add(blockSums[r]);
+    }
+    blockSums.fill(Accumulator(summation));
+}
+
+void StreamIntegrator::addPoints(const double* x, const double* y, std::size_t count) {
+    if (layout == Layout::Values) {
+        throw std::logic_error("(x, y) points cannot follow equally spaced values");
+    }
+    if (panel > 2) {
+        throw std::invalid_argument(getMethodName() + " needs equally spaced samples");
+    }
+    layout = Layout::Points;
+    for (std::size_t k = 0; k < count; ++k) {
+        addPoint(x[k], y[k]);
+    }
+}
+
+void StreamIntegrator::addPoint(double x, double y) {
+    if (count == 0) {
+        lowerBound = x;
+    } else if (!(x > previousX[1])) {
+        throw std::invalid_argument("x must increase from one sample to the next");
+    }
+
+    if (panel == 1 && count >= 1) {
+        pointSum.add((x - previousX[1]) * (previousY[1] + y) / 2);
+    } else if (panel == 2 && count >= 2 && count % 2 == 0) {
+        // Simpson's rule for the unequal intervals h0 and h1 of this panel
+        double h0 = previousX[1] - previousX[0];
+        double h1 = x - previousX[1];
+        double sum = h0 + h1;
+        pointSum.add(sum / 6 * ((2 - h1 / h0) * previousY[0] + sum * sum / (h0 * h1) * previousY[1]
+                                + (2 - h0 / h1) * y));
+    }
+
+    previousX[0] = previousX[1];
+    previousY[0] = previousY[1];
+    previousX[1] = x;
+    previousY[1] = y;
+    upperBound = x;
+    ++count;
+}
+
+bool StreamIntegrator::finish(std::string& error) {
+    const long long intervals = count - 1;
+    if (count < 2) {
+        error = "At least two samples are needed";
+        return false;
+    }
+    if (intervals % panel != 0) {
+        error = getMethodName() + " requires a number of intervals divisible by " + std::to_string(panel)
+                + ", but the data has " + std::to_string(intervals);
+        return false;
+    }
+
+    if (layout == Layout::Points) {
+        result = pointSum.total();
+        return true;
+    }
+
+    // Close the open batch and block on a copy, so more samples may still follow
+    StreamIntegrator closed = *this;
+    closed.flushBatch();
+    closed.flushBlock();
+    std::array<double, 4> sums = {0.0, 0.0, 0.0, 0.0};
+    for (int r = 0; r < panel; ++r) {
+        sums[r] = closed.totals[r].total();
+    }
+
+    double h = step > 0.0 ? step : (upperBound - lowerBound) / intervals;
+    if (step > 0.0) {
+        upperBound = lowerBound + intervals * step;
+    }
+    switch (panel) {
+        case 1:
+            result = rules::Trapezoidal::combine(first, last, sums.data(), h);
+            break;
+        case 2:
+            result = rules::SimpsonOneThird::combine(first, last, sums.data(), h);
+            break;
+        case 3:
+            result = rules::SimpsonThreeEighth::combine(first, last, sums.data(), h);
+            break;
+        default:
+            result = rules::Boole::combine(first, last, sums.data(), h);
+    }
+    return true;
+}
+
+std::string StreamIntegrator::getMethodName() const {
+    switch (panel) {
+        case 1:
+            return "Trapezoidal Rule";
+        case 2:
+            return "Simpson's 1/3 Rule";
+        case 3:
+            return "Simpson's 3/8 Rule";
+        default:
+            return "Boole's Rule";
+    }
+}
+
+double StreamIntegrator::getResult() const {
+    return result;
+}
+
+long long StreamIntegrator::getSampleCount() const {
+    return count;
+}
+
+double StreamIntegrator::getLowerBound() const {
+    return lowerBound;
+}
+
+double StreamIntegrator::getUpperBound() const {
+    return upperBound;
+}
+
+} // namespace numerical
@@ -0,0 +1,97 @@
+#include "../include/stream_reader.h"
+#include <cstdlib>
+
+namespace numerical {
+
+StreamReader::StreamReader(std::istream& in, bool binary, bool pairs)
+    : in(in), binary(binary), pairs(pairs), bytesRead(0), lineNumber(0) {
+}
+
+std::size_t StreamReader::read(double* x, double* y, std::size_t capacity, std::string& error) {
+    if (binary) {
+        // Read whole samples; a trailing partial value means the input is cut off
+        std::size_t width = pairs ? 2 : 1;
+        double* target = y;
+        if (pairs) {
+            buffer.resize(capacity * 2);
+            target = buffer.data();
+        }
+        in.read(reinterpret_cast<char*>(target), static_cast<std::streamsize>(capacity * width * sizeof(double)));
+        std::size_t bytes = static_cast<std::size_t>(in.gcount());
+        bytesRead += static_cast<long long>(bytes);
+        if (bytes % (width * sizeof(double)) != 0) {
+            error = "the binary input ends in the middle of a sample";
+            return 0;
+        }
+        std::size_t count = bytes / (width * sizeof(double));
+        if (pairs) {
+            for (std::size_t k = 0; k < count; ++k) {
+                x[k] = buffer[2 * k];
+                y[k] = buffer[2 * k + 1];
+            }
+        }
+        return count;
+    }
+
+    std::size_t count = 0;
+    while (count < capacity && std::getline(in, line)) {
+        bytesRead += static_cast<long long>(line.size()) + 1;
+        ++lineNumber;
+        double xValue = 0.0;
+        int parsed = parseLine(xValue, y[count], error);
+        if (parsed < 0) {
+            return 0;
+        }
+        if (parsed > 0) {
+            if (pairs) {
+                x[count] = xValue;
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+int StreamReader::parseLine(double& x, double& y, std::string& error) {
+    const char* text = line.c_str();
+    while (*text == ' ' || *text == '\t') {
+        ++text;
+    }
+    if (*text == '\0' || *text == '\r' || *text == '#') {
+        return 0;
+    }
+
+    double values[2];
+    int wanted = pairs ? 2 : 1;
+    for (int k = 0; k < wanted; ++k) {
+        char* end = nullptr;
+        values[k] = std::strtod(text, &end);
+        if (end == text) {
+            // A header line naming the columns may come first
+            if (lineNumber == 1 && k == 0) {
+                return 0;
+            }
+            error = "line " + std::to_string(lineNumber) + ": expected " + (pairs ? "x, y" : "a number");
+            return -1;
+        }
+        text = end;
+        while (*text == ' ' || *text == '\t' || (k + 1 < wanted && (*text == ',' || *text == ';'))) {
+            ++text;
+        }
+    }
+    if (*text != '\0' && *text != '\r' && *text != '#') {
+        error = "line " + std::to_string(lineNumber) + ": unexpected text after the " + (pairs ? "pair" : "value");
+        return -1;
+    }
+    if (pairs) {
+        x = values[0];
+    }
+    y = values[pairs ? 1 : 0];
+    return 1;
+}
+
+long long StreamReader::getBytesRead() const {
+    return bytesRead;
+}
+
+} // namespace numerical
@@ -0,0 +1,366 @@
+#include "../include/summation.h"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NUMERICAL_X86_SUMMATION 1
+#include <immintrin.h>
+#endif
+
+namespace numerical {
+
+namespace {
+
+/**
+ * Adds count values (a multiple of 8) to eight interleaved Kahan sums:
+ * values[i] goes to lane i % 8.
+ */
+using LaneKernel = void (*)(const double* values, int count, double* sums, double* compensations);
+
+void kahanLanesScalar(const double* values, int count, double* sums, double* compensations) {
+    for (int i = 0; i < count; i += 8) {
+        for (int lane = 0; lane < 8; ++lane) {
+            double y = values[i + lane] - compensations[lane];
+            double t = sums[lane] + y;
+            compensations[lane] = (t - sums[lane]) - y;
+            sums[lane] = t;
+        }
+    }
+}
+
+#ifdef NUMERICAL_X86_SUMMATION
+
+// The SIMD versions perform exactly the same operations per lane as the
+// scalar one, so every instruction set gives the same result
+
+__attribute__((target("avx2")))
+void kahanLanesAvx2(const double* values, int count, double* sums, double* compensations) {
+    __m256d sumLow = _mm256_loadu_pd(sums);
+    __m256d sumHigh = _mm256_loadu_pd(sums + 4);
+    __m256d compensationLow = _mm256_loadu_pd(compensations);
+    __m256d compensationHigh = _mm256_loadu_pd(compensations + 4);
+    for (int i = 0; i < count; i += 8) {
+        __m256d yLow = _mm256_sub_pd(_mm256_loadu_pd(values + i), compensationLow);
+        __m256d yHigh = _mm256_sub_pd(_mm256_loadu_pd(values + i + 4), compensationHigh);
+        __m256d tLow = _mm256_add_pd(sumLow, yLow);
+        __m256d tHigh = _mm256_add_pd(sumHigh, yHigh);
+        compensationLow = _mm256_sub_pd(_mm256_sub_pd(tLow, sumLow), yLow);
+        compensationHigh = _mm256_sub_pd(_mm256_sub_pd(tHigh, sumHigh), yHigh);
+        sumLow = tLow;
+        sumHigh = tHigh;
+    }
+    _mm256_storeu_pd(sums, sumLow);
+    _mm256_storeu_pd(sums + 4, sumHigh);
+    _mm256_storeu_pd(compensations, compensationLow);
+    _mm256_storeu_pd(compensations + 4, compensationHigh);
+}
+
+__attribute__((target("avx512f")))
+void kahanLanesAvx512(const double* values, int count, double* sums, double* compensations) {
+    __m512d sum = _mm512_loadu_pd(sums);
+    __m512d compensation = _mm512_loadu_pd(compensations);
+    for (int i = 0; i < count; i += 8) {
+        __m512d y = _mm512_sub_pd(_mm512_loadu_pd(values + i), compensation);
+        __m512d t = _mm512_add_pd(sum, y);
+        compensation = _mm512_sub_pd(_mm512_sub_pd(t, sum), y);
+        sum = t;
+    }
+    _mm512_storeu_pd(sums, sum);
+    _mm512_storeu_pd(compensations, compensation);
+}
+
+#endif // NUMERICAL_X86_SUMMATION
+
+/**
+ * Adds count values (a multiple of laneCount, which is 8 or 24) to laneCount
+ * interleaved naive sums: values[i] goes to lane i % laneCount.
+ */
+using InterleavedKernel = void (*)(const double* values, int count, double* lanes, int laneCount);
+
+void interleavedScalar(const double* values, int count, double* lanes, int laneCount) {
+    for (int i = 0; i < count; i += laneCount) {
+        for (int lane = 0; lane < laneCount; ++lane) {
+            lanes[lane] += values[i + lane];
+        }
+    }
+}
+
+#ifdef NUMERICAL_X86_SUMMATION
+
+__attribute__((target("avx2")))
+void interleavedAvx2(const double* values, int count, double* lanes, int laneCount) {
+    const int vectors = laneCount / 4;
+    __m256d sums[MAX_INTERLEAVED_LANES / 4];
+    for (int v = 0; v < vectors; ++v) {
+        sums[v] = _mm256_loadu_pd(lanes + 4 * v);
+    }
+    for (int i = 0; i < count; i += laneCount) {
+        for (int v = 0; v < vectors; ++v) {
+            sums[v] = _mm256_add_pd(sums[v], _mm256_loadu_pd(values + i + 4 * v));
+        }
+    }
+    for (int v = 0; v < vectors; ++v) {
+        _mm256_storeu_pd(lanes + 4 * v, sums[v]);
+    }
+}
+
+__attribute__((target("avx512f")))
+void interleavedAvx512(const double* values, int count, double* lanes, int laneCount) {
+    const int vectors = laneCount / 8;
+    __m512d sums[MAX_INTERLEAVED_LANES / 8];
+    for (int v = 0; v < vectors; ++v) {
+        sums[v] = _mm512_loadu_pd(lanes + 8 * v);
+    }
+    for (int i = 0; i < count; i += laneCount) {
+        for (int v = 0; v < vectors; ++v) {
+            sums[v] = _mm512_add_pd(sums[v], _mm512_loadu_pd(values + i + 8 * v));
+        }
+    }
+    for (int v = 0; v < vectors; ++v) {
+        _mm512_storeu_pd(lanes + 8 * v, sums[v]);
+    }
+}
+
+#endif // NUMERICAL_X86_SUMMATION
+
+InterleavedKernel selectInterleavedKernel() {
+#ifdef NUMERICAL_X86_SUMMATION
+    static const InterleavedKernel kernel = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return interleavedAvx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return interleavedAvx2;
+        }
+        return interleavedScalar;
+    }();
+    return kernel;
+#else
+    return interleavedScalar;
+#endif
+}
+
+LaneKernel selectLaneKernel() {
+#ifdef NUMERICAL_X86_SUMMATION
+    static const LaneKernel kernel = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return kahanLanesAvx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return kahanLanesAvx2;
+        }
+        return kahanLanesScalar;
+    }();
+    return kernel;
+#else
+    return kahanLanesScalar;
+#endif
+}
+
+// One step of Kahan summation
+inline void kahanAdd(double value, double& sum, double& compensation) {
+    double y = value - compensation;
+    double t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+}
+
+// One step of Neumaier summation
+inline void neumaierAdd(double value, double& sum, double& compensation) {
+    double t = sum + value;
+    if (std::abs(sum) >= std::abs(value)) {
+        compensation += (sum - t) + value;
+    } else {
+        compensation += (value - t) + sum;
+    }
+    sum = t;
+}
+
+// Pairwise sum of values[0], values[stride], ...; short runs are added directly
+double pairwiseSum(const double* values, int count, int stride) {
+    if (count <= 8) {
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) {
+            sum += values[i * stride];
+        }
+        return sum;
+    }
+    int half = count / 2;
+    return pairwiseSum(values, half, stride) + pairwiseSum(values + half * stride, count - half, stride);
+}
+
+} // namespace
+
+void addInterleaved(const double* values, int count, int offset, double* lanes, int laneCount) {
+    int k = 0;
+    // Lead-in up to the first value that belongs to lane 0
+    if (offset != 0) {
+        for (int lane = offset; lane < laneCount && k < count; ++lane, ++k) {
+            lanes[lane] += values[k];
+        }
+    }
+    int whole = (count - k) / laneCount * laneCount;
+    selectInterleavedKernel()(values + k, whole, lanes, laneCount);
+    k += whole;
+    for (int lane = 0; k < count; ++lane, ++k) {
+        lanes[lane] += values[k];
+    }
+}
+
+std::string summationName(Summation method) {
+    switch (method) {
+        case Summation::Kahan:
+            return "kahan";
+        case Summation::Neumaier:
+            return "neumaier";
+        case Summation::Pairwise:
+            return "pairwise";
+        case Summation::Vectorized:
+            return "vectorized";
+        default:
+            return "naive";
+    }
+}
+
+bool parseSummation(const std::string& name, Summation& method) {
+    for (Summation candidate : allSummations()) {
+        if (summationName(candidate) == name) {
+            method = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Summation> allSummations() {
+    return {Summation::Naive, Summation::Pairwise, Summation::Vectorized, Summation::Kahan, Summation::Neumaier};
+}
+
+Accumulator::Accumulator(Summation method)
+    : method(method), sum(0.0), compensation(0.0), lanes(), laneCompensations(), levels(), leaves(0) {
+}
+
+void Accumulator::add(double value) {
+    switch (method) {
+        case Summation::Kahan:
+            kahanAdd(value, sum, compensation);
+            break;
+        case Summation::Neumaier:
+            neumaierAdd(value, sum, compensation);
+            break;
+        case Summation::Pairwise:
+            pushLeaf(value);
+            break;
+        case Summation::Vectorized:
+            kahanAdd(value, lanes[0], laneCompensations[0]);
+            break;
+        default:
+            sum += value;
+    }
+}
+
+void Accumulator::add(const double* values, int count, int stride) {
+    switch (method) {
+        case Summation::Kahan:
+            for (int i = 0; i < count; ++i) {
+                kahanAdd(values[i * stride], sum, compensation);
+            }
+            break;
+        case Summation::Neumaier:
+            for (int i = 0; i < count; ++i) {
+                neumaierAdd(values[i * stride], sum, compensation);
+            }
+            break;
+        case Summation::Pairwise:
+            if (count > 0) {
+                pushLeaf(pairwiseSum(values, count, stride));
+            }
+            break;
+        case Summation::Vectorized: {
+            // The SIMD kernel needs contiguous values; gather strided ones first
+            constexpr int CHUNK = 256;
+            double gathered[CHUNK];
+            for (int start = 0; start < count; start += CHUNK) {
+                int chunk = std::min(CHUNK, count - start);
+                const double* chunkValues = values + static_cast<long long>(start) * stride;
+                if (stride != 1) {
+                    for (int i = 0; i < chunk; ++i) {
+                        gathered[i] = chunkValues[i * stride];
+                    }
+                    chunkValues = gathered;
+                }
+                int whole = chunk / LANES * LANES;
+                selectLaneKernel()(chunkValues, whole, lanes, laneCompensations);
+                for (int i = whole; i < chunk; ++i) {
+                    kahanAdd(chunkValues[i], lanes[i - whole], laneCompensations[i - whole]);
+                }
+            }
+            break;
+        }
+        default:
+            for (int i = 0; i < count; ++i) {
+                sum += values[i * stride];
+            }
+    }
+}
+
+void Accumulator::add(const Accumulator& other) {
+    switch (method) {
+        case Summation::Kahan:
+            // Carry the other's rounding error over instead of dropping it
+            kahanAdd(other.sum, sum, compensation);
+            compensation += other.method == Summation::Kahan ? other.compensation : 0.0;
+            break;
+        case Summation::Neumaier:
+            neumaierAdd(other.sum, sum, compensation);
+            compensation += other.method == Summation::Neumaier ? other.compensation : 0.0;
+            break;
+        default:
+            add(other.total());
+    }
+}
+
+double Accumulator::total() const {
+    switch (method) {
+        case Summation::Kahan:
+            return sum - compensation;
+        case Summation::Neumaier:
+            return sum + compensation;
+        case Summation::Pairwise: {
+            // Smallest partial sums first
+            double total = 0.0;
+            for (int k = 0; k < LEVELS; ++k) {
+                if (leaves & (std::uint64_t(1) << k)) {
+                    total += levels[k];
+                }
+            }
+            return total;
+        }
+        case Summation::Vectorized: {
+            double total = 0.0;
+            double totalCompensation = 0.0;
+            for (int lane = 0; lane < LANES; ++lane) {
+                neumaierAdd(lanes[lane], total, totalCompensation);
+                neumaierAdd(-laneCompensations[lane], total, totalCompensation);
+            }
+            return total + totalCompensation;
+        }
+        default:
+            return sum;
+    }
+}
+
+void Accumulator::pushLeaf(double value) {
+    // Like incrementing a binary counter: merge equal-sized partial sums
+    int k = 0;
+    while (leaves & (std::uint64_t(1) << k)) {
+        value = levels[k] + value;
+        ++k;
+    }
+    levels[k] = value;
+    ++leaves;
+}
+
+} // namespace numerical
@@ -0,0 +1,208 @@
+#include "../include/thread_pool.h"
+
+namespace numerical {
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : task(nullptr), busyWorkers(0), generation(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = hardwareThreads();
+    }
+
+    // The calling thread is the first member of the pool
+    for (unsigned t = 1; t < threadCount; ++t) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, t);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Every thread pulls the next index from a shared counter
+    std::atomic<std::size_t> nextIndex(0);
+    runOnAllThreads([&](unsigned) {
+        std::size_t i;
+        while ((i = nextIndex.fetch_add(1)) < count) {
+            if (!runGuarded([&] { body(i); })) {
+                nextIndex.store(count); // Skip the remaining iterations
+            }
+        }
+    });
+}
+
+void ThreadPool::parallelForStealing(std::size_t count,
+                                     const std::function<void(std::size_t, unsigned)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Each thread starts with an equal contiguous share of the indices
+    const unsigned threads = size();
+    std::vector<IndexRange> ranges(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        ranges[t].begin = count * t / threads;
+        ranges[t].end = count * (t + 1) / threads;
+    }
+    std::atomic<bool> failed(false);
+
+    runOnAllThreads([&](unsigned self) {
+        while (!failed.load()) {
+            std::size_t i = 0;
+            bool found = false;
+            {
+                // Take work from the front of the own range
+                std::lock_guard<std::mutex> lock(ranges[self].mutex);
+                if (ranges[self].begin < ranges[self].end) {
+                    i = ranges[self].begin++;
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                // Steal the back half of the largest remaining range
+                unsigned victim = self;
+                std::size_t largest = 0;
+                for (unsigned t = 0; t < threads; ++t) {
+                    std::lock_guard<std::mutex> lock(ranges[t].mutex);
+                    if (ranges[t].end - ranges[t].begin > largest) {
+                        largest = ranges[t].end - ranges[t].begin;
+                        victim = t;
+                    }
+                }
+                if (largest == 0) {
+                    return; // All work has been handed out
+                }
+
+                std::size_t stolenBegin;
+                std::size_t stolenEnd;
+                {
+                    std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                    std::size_t remaining = ranges[victim].end - ranges[victim].begin;
+                    if (remaining == 0) {
+                        continue; // The victim finished meanwhile; look again
+                    }
+                    stolenEnd = ranges[victim].end;
+                    stolenBegin = stolenEnd - (remaining + 1) / 2;
+                    ranges[victim].end = stolenBegin;
+                }
+
+                std::lock_guard<std::mutex> lock(ranges[self].mutex);
+                ranges[self].begin = stolenBegin + 1;
+                ranges[self].end = stolenEnd;
+                i = stolenBegin;
+            }
+
+            if (!runGuarded([&] { body(i, self); })) {
+                failed.store(true);
+            }
+        }
+    });
+}
+
+unsigned ThreadPool::hardwareThreads() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::runOnAllThreads(const std::function<void(unsigned)>& threadTask) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &threadTask;
+        busyWorkers = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    wakeUp.notify_all();
+
+    threadTask(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+
+    if (error) {
+        std::exception_ptr pending = error;
+        error = nullptr;
+        std::rethrow_exception(pending);
+    }
+}
+
+bool ThreadPool::runGuarded(const std::function<void()>& work) {
+    try {
+        work();
+        return true;
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+        return false;
+    }
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    unsigned long long seenGeneration = 0;
+
+    while (true) {
+        const std::function<void(unsigned)>* current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            current = task;
+        }
+
+        (*current)(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        finished.notify_one();
+    }
+}
+
+BlockRunner::BlockRunner(unsigned threadCount) : threadCount(threadCount) {}
+
+void BlockRunner::setThreadCount(unsigned threads) {
+    threadCount = threads;
+}
+
+unsigned BlockRunner::getThreadCount() const {
+    return threadCount;
+}
+
+void BlockRunner::run(long long blockCount, const std::function<void(std::size_t)>& body) {
+    const unsigned configured = threadCount == 0 ? ThreadPool::hardwareThreads() : threadCount;
+    if (configured > 1 && blockCount > 1) {
+        if (!pool || pool->size() != configured) {
+            pool = std::make_unique<ThreadPool>(configured);
+        }
+        pool->parallelFor(static_cast<std::size_t>(blockCount), body);
+    } else {
+        for (long long block = 0; block < blockCount; ++block) {
+            body(static_cast<std::size_t>(block));
+        }
+    }
+}
+
+} // namespace numerical